@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+##  Copyright 2022-present Contributors to the specviz project.
+##  SPDX-License-Identifier: BSD-3-Clause
+##  https://github.com/mikaelsundell/specviz
+
+"""specstream.py -- Stand-in for a spectrometer that prints spectra continuously
+
+usage: specstream.py [options]
+
+Writes a drifting, slightly noisy black body spectrum to stdout, a named pipe
+or a socket, as argyll .sp records or one spectrum per line.
+
+  specstream.py | Specviz --stream -
+  specstream.py --fifo /tmp/specviz.fifo        (Specviz --stream /tmp/specviz.fifo)
+  specstream.py --tcp 5555                      (Specviz --stream tcp://localhost:5555)
+  specstream.py --unix /tmp/specviz.sock        (Specviz --stream local:/tmp/specviz.sock)
+"""
+
+import argparse
+import math
+import os
+import random
+import socket
+import sys
+import time
+
+
+def spectrum(kelvin, start, end, step, noise):
+    values = []
+    for nm in range(start, end + 1, step):
+        wl = nm * 1e-9
+        power = 1.0 / (wl ** 5 * (math.exp(1.4388e-2 / (wl * kelvin)) - 1.0))
+        values.append(power)
+    peak = max(values)
+    return [v / peak + random.gauss(0.0, noise) for v in values]
+
+
+def record(values, start, end, fmt, header):
+    data = " ".join("%.6f" % v for v in values)
+    if fmt == "line":
+        return (header if header else "") + data + "\n"
+    return (
+        "SPECT\n\n"
+        'DESCRIPTOR "Argyll Spectral power/reflectance information"\n'
+        'ORIGINATOR "specstream.py"\n'
+        'MEAS_TYPE "AMBIENT"\n'
+        'SPECTRAL_BANDS "%d"\n'
+        'SPECTRAL_START_NM "%f"\n'
+        'SPECTRAL_END_NM "%f"\n'
+        "NUMBER_OF_SETS 1\n"
+        "BEGIN_DATA\n%s\nEND_DATA\n" % (len(values), start, end, data)
+    )
+
+
+def run(out, args):
+    header = "grid %d %d %d\n" % (args.start, args.end, args.step)
+    frame = 0
+    while args.count == 0 or frame < args.count:
+        kelvin = 4500.0 + 2000.0 * math.sin(frame / 200.0)
+        values = spectrum(kelvin, args.start, args.end, args.step, args.noise)
+        out(record(values, args.start, args.end, args.format, header if frame == 0 else None))
+        frame += 1
+        time.sleep(1.0 / args.rate)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in for a spectrometer that prints spectra continuously.")
+    parser.add_argument("--format", choices=["line", "sp"], default="line", help="output format")
+    parser.add_argument("--rate", type=float, default=60.0, help="spectra per second")
+    parser.add_argument("--count", type=int, default=0, help="number of spectra, 0 to run until stopped")
+    parser.add_argument("--start", type=int, default=380, help="first wavelength in nm")
+    parser.add_argument("--end", type=int, default=780, help="last wavelength in nm")
+    parser.add_argument("--step", type=int, default=5, help="wavelength step in nm")
+    parser.add_argument("--noise", type=float, default=0.005, help="standard deviation of the noise")
+    target = parser.add_mutually_exclusive_group()
+    target.add_argument("--fifo", help="create and write to a named pipe")
+    target.add_argument("--tcp", type=int, help="serve on a local tcp port")
+    target.add_argument("--unix", help="serve on a unix domain socket")
+    args = parser.parse_args()
+
+    try:
+        if args.fifo:
+            if not os.path.exists(args.fifo):
+                os.mkfifo(args.fifo)
+            with open(args.fifo, "w") as pipe:
+                run(lambda text: (pipe.write(text), pipe.flush()), args)
+        elif args.tcp or args.unix:
+            family = socket.AF_INET if args.tcp else socket.AF_UNIX
+            server = socket.socket(family, socket.SOCK_STREAM)
+            if args.tcp:
+                server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+                server.bind(("127.0.0.1", args.tcp))
+            else:
+                if os.path.exists(args.unix):
+                    os.remove(args.unix)
+                server.bind(args.unix)
+            server.listen(1)
+            connection, _ = server.accept()
+            run(lambda text: connection.sendall(text.encode()), args)
+        else:
+            run(lambda text: (sys.stdout.write(text), sys.stdout.flush()), args)
+    except (BrokenPipeError, ConnectionResetError, KeyboardInterrupt):
+        pass
+
+
+if __name__ == "__main__":
+    main()
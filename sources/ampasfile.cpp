@@ -56,11 +56,17 @@ AmpasFile::read(const QString& fileName)
 
                 for (auto it = mainObj.begin(); it != mainObj.end(); ++it) {
                     bool ok = false;
-                    int wavelength = it.key().toInt(&ok);
+                    int wavelength = qRound(it.key().toDouble(&ok));  // fractional wavelengths round to whole nm
                     if (!ok) {
                         qWarning() << "AmpasFile: invalid wavelength key:" << it.key();
                         continue;
                     }
+                    if (dataset.data.contains(wavelength)) {
+                        // steps below 1 nm can not be stored, rows would overwrite each other
+                        qWarning() << "AmpasFile: wavelength" << it.key() << "rounds to an existing" << wavelength
+                                   << "nm, steps below 1 nm are not supported:" << fileName;
+                        return Dataset();
+                    }
 
                     QVector<double> values;
                     QJsonArray valueArray = it.value().toArray();
@@ -80,6 +86,7 @@ AmpasFile::read(const QString& fileName)
     else {
         dataset.name = "Ampas spectral sensitivity data";
     }
+    dataset.precision = Float32;  // measured
     dataset.loaded = true;
     return dataset;
 }
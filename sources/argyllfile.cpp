@@ -6,6 +6,7 @@
 
 #include <QDebug>
 #include <QFile>
+#include <QLocale>
 #include <QRegularExpression>
 #include <QStringList>
 #include <QTextStream>
@@ -94,6 +95,12 @@ ArgyllFile::read(const QString& fileName)
         double step = (bands > 1) ? (endNm - startNm) / (bands - 1) : 0.0;
         for (int i = 0; i < bands; ++i) {
             int wl = static_cast<int>(qRound(startNm + i * step));
+            if (dataset.data.contains(wl)) {
+                // steps below 1 nm can not be stored, rows would overwrite each other
+                qWarning() << "Argyll: band" << i << "rounds to an existing" << wl
+                           << "nm, steps below 1 nm are not supported:" << fileName;
+                return Dataset();
+            }
 
             QVector<double> row;
             row.reserve(numSets);
@@ -121,6 +128,7 @@ ArgyllFile::read(const QString& fileName)
             dataset.units = "reflectance sensitivity";
         }
     }
+    dataset.precision = Float32;  // measured
     dataset.loaded = true;
     return dataset;
 }
@@ -166,7 +174,7 @@ ArgyllFile::write(const Dataset& dataset, const QString& fileName)
     for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it) {
         const QVector<double>& row = it.value();
         for (int i = 0; i < row.size(); ++i) {
-            out << row[i];
+            out << QString::number(row[i], 'g', QLocale::FloatingPointShortest);  // reads back to the same value
             if (i < row.size() - 1)
                 out << " ";
         }
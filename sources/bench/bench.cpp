@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "../ampasfile.h"
+#include "../argyllfile.h"
+#include "../icctransform.h"
+#include "../qcustomplot/qcustomplot.h"
+#include "../specgenerator.h"
+#include "../specio.h"
+#include "../vectorexport.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <benchmark/benchmark.h>
+#include <lcms2.h>
+
+// benchmarks for parsing, plotting and color transforms. run with --benchmark_out=<file> --benchmark_out_format=json
+// to keep results for regression comparison, sizes are synthetic and scaled up beyond the bundled data
+namespace {
+QTemporaryDir* scratch = nullptr;
+
+SpecGenerator
+generator(int bands, int channels)
+{
+    SpecGenerator::Options options;
+    options.bands = bands;
+    options.sets = channels;
+    options.headerFields = 8;
+    return SpecGenerator(options);
+}
+
+QString
+syntheticFile(SpecGenerator::Format format, int bands, int channels)
+{
+    const QString fileName = scratch->filePath(
+        QString("synthetic_%1_%2.%3").arg(bands).arg(channels).arg(SpecGenerator::extension(format)));
+    if (!QFileInfo::exists(fileName)) {
+        generator(bands, channels).write(format, 0, fileName);
+    }
+    return fileName;
+}
+
+QString
+displayProfile()
+{
+    // a gamma 2.2 display differs enough from srgb that the transform is not an identity
+    const QString fileName = scratch->filePath("display.icc");
+    if (!QFileInfo::exists(fileName)) {
+        cmsCIExyY white;
+        cmsWhitePointFromTemp(&white, 6504);
+        cmsCIExyYTRIPLE primaries = { { 0.64, 0.33, 1.0 }, { 0.30, 0.60, 1.0 }, { 0.15, 0.06, 1.0 } };
+        cmsToneCurve* gamma = cmsBuildGamma(nullptr, 2.2);
+        cmsToneCurve* curves[3] = { gamma, gamma, gamma };
+        cmsHPROFILE profile = cmsCreateRGBProfile(&white, &primaries, curves);
+        cmsSaveProfileToFile(profile, fileName.toLocal8Bit().constData());
+        cmsCloseProfile(profile);
+        cmsFreeToneCurve(gamma);
+    }
+    return fileName;
+}
+
+QString
+inputProfile()
+{
+    return QDir(SPECVIZ_SOURCE_DIR).filePath("resources/sRGB2014.icc");
+}
+
+template<typename File, SpecGenerator::Format format>
+void
+BM_Read(benchmark::State& state)
+{
+    File file;
+    const QString fileName = syntheticFile(format, state.range(0), state.range(1));
+    for (auto _ : state) {
+        SpecFile::Dataset dataset = file.read(fileName);
+        benchmark::DoNotOptimize(dataset.data.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    state.SetBytesProcessed(state.iterations() * QFileInfo(fileName).size());
+}
+
+template<typename File>
+void
+BM_Write(benchmark::State& state)
+{
+    File file;
+    const SpecFile::Dataset dataset = generator(state.range(0), state.range(1)).dataset(0);
+    const QString fileName = scratch->filePath("write." + file.extensions().first());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(file.write(dataset, fileName));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+void
+BM_SpecIODispatch(benchmark::State& state)
+{
+    const QString fileName = QDir(SPECVIZ_SOURCE_DIR).filePath("tests/daylight/argyll_amb_daylight_read1.sp");
+    for (auto _ : state) {
+        SpecIO spec(fileName);
+        benchmark::DoNotOptimize(spec.isLoaded());
+    }
+}
+
+void
+BM_ICCMapColor(benchmark::State& state)
+{
+    ICCTransform* transform = ICCTransform::instance();
+    const QString input = inputProfile();
+    const QString output = displayProfile();
+    QRgb color = qRgb(12, 140, 220);
+    for (auto _ : state) {
+        color = transform->map(color, input, output);
+        benchmark::DoNotOptimize(color);
+    }
+}
+
+void
+BM_ICCMapImage(benchmark::State& state)
+{
+    ICCTransform* transform = ICCTransform::instance();
+    const QString input = inputProfile();
+    const QString output = displayProfile();
+    QImage image(state.range(0), state.range(0), QImage::Format_ARGB32);
+    image.fill(qRgb(12, 140, 220));
+    for (auto _ : state) {
+        QImage mapped = transform->map(image, input, output);
+        benchmark::DoNotOptimize(mapped.constBits());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+void
+setupPlot(QCustomPlot& plot, int curves, int samples, bool raster = true)
+{
+    plot.resize(1200, 800);
+    plot.setPlottingHint(QCP::phRasterPolylines, raster);
+    const SpecFile::Dataset dataset = generator(samples, curves).dataset(1);
+    QVector<double> keys;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it) {
+        keys.append(it.key());
+    }
+    for (int c = 0; c < curves; ++c) {
+        QVector<double> values;
+        for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it) {
+            values.append(it.value()[c]);
+        }
+        QCPGraph* graph = plot.addGraph();
+        graph->setPen(QPen(QColor::fromHsvF(c / double(curves), 0.8, 0.9), 2));
+        graph->setData(keys, values, true);
+    }
+    plot.rescaleAxes();
+}
+
+void
+BM_Replot(benchmark::State& state)
+{
+    // raster polylines on and off, off is the qpainter path
+    QCustomPlot plot;
+    setupPlot(plot, state.range(0), state.range(1), state.range(2));
+    for (auto _ : state) {
+        plot.replot(QCustomPlot::rpImmediateRefresh);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+void
+BM_ExportPlot(benchmark::State& state)
+{
+    // dense figures as pdf or svg, min and max reduced at 300 dpi
+    QCustomPlot plot;
+    setupPlot(plot, state.range(0), state.range(1));
+    VectorExport vectorExport;
+    vectorExport.setSize(QSize(1200, 800));
+    const QString fileName = scratch->filePath(state.range(2) ? "export.svg" : "export.pdf");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vectorExport.write(&plot, fileName));
+    }
+    state.counters["bytes"] = QFileInfo(fileName).size();
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+void
+BM_TraceLookup(benchmark::State& state)
+{
+    // one tracer per curve follows the cursor, as in the main window
+    QCustomPlot plot;
+    setupPlot(plot, state.range(0), state.range(1));
+    QList<QCPItemTracer*> tracers;
+    for (int i = 0; i < plot.graphCount(); ++i) {
+        QCPItemTracer* tracer = new QCPItemTracer(&plot);
+        tracer->setGraph(plot.graph(i));
+        tracer->setInterpolating(true);
+        tracers.append(tracer);
+    }
+    QRandomGenerator random(3);
+    const double lower = plot.xAxis->range().lower;
+    const double size = plot.xAxis->range().size();
+    for (auto _ : state) {
+        const double key = lower + size * random.generateDouble();
+        for (QCPItemTracer* tracer : tracers) {
+            tracer->setGraphKey(key);
+            tracer->updatePosition();
+            benchmark::DoNotOptimize(tracer->position->value());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Read, ArgyllFile, SpecGenerator::Argyll)->ArgsProduct({ { 36, 401, 4096, 100000 }, { 1, 16 } });
+BENCHMARK_TEMPLATE(BM_Write, ArgyllFile)->ArgsProduct({ { 36, 401, 4096, 100000 }, { 1, 16 } });
+BENCHMARK_TEMPLATE(BM_Read, AmpasFile, SpecGenerator::Ampas)->ArgsProduct({ { 36, 401, 4096, 100000 }, { 1, 16 } });
+BENCHMARK_TEMPLATE(BM_Write, AmpasFile)->ArgsProduct({ { 36, 401, 4096, 100000 }, { 1, 16 } });
+BENCHMARK(BM_SpecIODispatch);
+BENCHMARK(BM_ICCMapColor);
+BENCHMARK(BM_ICCMapImage)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK(BM_Replot)->ArgsProduct({ { 1, 16, 128 }, { 401, 4096, 65536 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExportPlot)->ArgsProduct({ { 16, 500 }, { 401, 4096 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TraceLookup)->ArgsProduct({ { 1, 16, 128 }, { 401, 65536 } });
+
+int
+main(int argc, char* argv[])
+{
+    // plots render to their buffers without a display, parses are measured without the dataset cache
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qputenv("SPECVIZ_CACHE", "0");
+    QApplication app(argc, argv);
+    QTemporaryDir dir;
+    scratch = &dir;
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,356 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "binaryfile.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const char magic[8] = { 'S', 'P', 'E', 'C', 'B', 'I', 'N', '\0' };
+const quint32 version = 1;
+const qint64 alignment = 64;
+const quint32 measured = 0x100;  // dataset precision is float32, independent of the column width
+const quint64 maximumExpansion = 64;  // a two byte repeat run decodes to 128 bytes
+
+// all offsets are from the start of the file, all values little endian
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 flags;
+    quint32 rows;     // wavelengths
+    quint32 columns;  // indices
+    quint64 stringsOffset;
+    quint64 stringsSize;
+    quint64 wavelengthsOffset;  // int32 per row
+    quint64 dataOffset;         // one column of rows values per index
+    quint64 dataSize;
+};
+static_assert(sizeof(Header) == 64, "binary header must be 64 bytes");
+
+qint64
+aligned(qint64 offset)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+bool
+fits(quint64 offset, quint64 size, qint64 fileSize)
+{
+    return offset <= quint64(fileSize) && size <= quint64(fileSize) - offset;
+}
+
+void
+appendString(QByteArray& table, const QString& string)
+{
+    QByteArray utf8 = string.toUtf8();
+    quint32 size = qToLittleEndian(quint32(utf8.size()));
+    table.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    table.append(utf8);
+}
+
+bool
+takeString(const char*& data, const char* end, QString& string)
+{
+    quint32 size;
+    if (end - data < qint64(sizeof(size)))
+        return false;
+    size = qFromLittleEndian<quint32>(data);
+    data += sizeof(size);
+    if (end - data < qint64(size))
+        return false;
+    string = QString::fromUtf8(data, size);
+    data += size;
+    return true;
+}
+
+// xor of each value with its predecessor leaves mostly zero high bytes on smooth curves, shuffling groups byte k of
+// all values together so those zeros form long runs that the packbits style run length coding collapses
+QByteArray
+pack(const QByteArray& column, int width)
+{
+    const qint64 count = column.size() / width;
+    const uchar* src = reinterpret_cast<const uchar*>(column.constData());
+    QByteArray shuffled(column.size(), Qt::Uninitialized);
+    uchar* dst = reinterpret_cast<uchar*>(shuffled.data());
+    for (qint64 i = 0; i < count; ++i) {
+        for (int b = 0; b < width; ++b) {
+            uchar value = src[i * width + b];
+            if (i > 0)
+                value ^= src[(i - 1) * width + b];
+            dst[b * count + i] = value;
+        }
+    }
+    QByteArray packed;
+    packed.reserve(shuffled.size() / 2);
+    qint64 i = 0;
+    while (i < shuffled.size()) {
+        qint64 run = 1;
+        while (i + run < shuffled.size() && run < 128 && dst[i + run] == dst[i])
+            run++;
+        if (run >= 3) {
+            packed.append(char(257 - run));  // repeat run: 2..128 copies
+            packed.append(char(dst[i]));
+            i += run;
+            continue;
+        }
+        qint64 literal = 0;
+        while (i + literal < shuffled.size() && literal < 128) {
+            if (i + literal + 2 < shuffled.size() && dst[i + literal] == dst[i + literal + 1]
+                && dst[i + literal] == dst[i + literal + 2])
+                break;
+            literal++;
+        }
+        packed.append(char(literal - 1));  // literal run: 1..128 bytes
+        packed.append(reinterpret_cast<const char*>(dst + i), literal);
+        i += literal;
+    }
+    return packed;
+}
+
+bool
+unpack(const char* data, qint64 size, int width, qint64 count, char* column)
+{
+    QByteArray shuffled(count * width, Qt::Uninitialized);
+    uchar* dst = reinterpret_cast<uchar*>(shuffled.data());
+    const uchar* src = reinterpret_cast<const uchar*>(data);
+    qint64 in = 0, out = 0;
+    while (in < size && out < shuffled.size()) {
+        int control = src[in++];
+        if (control < 128) {
+            qint64 literal = control + 1;
+            if (in + literal > size || out + literal > shuffled.size())
+                return false;
+            std::memcpy(dst + out, src + in, literal);
+            in += literal;
+            out += literal;
+        }
+        else {
+            qint64 run = 257 - control;
+            if (in >= size || out + run > shuffled.size())
+                return false;
+            std::memset(dst + out, src[in++], run);
+            out += run;
+        }
+    }
+    if (out != shuffled.size())
+        return false;
+    uchar* values = reinterpret_cast<uchar*>(column);
+    for (qint64 i = 0; i < count; ++i) {
+        for (int b = 0; b < width; ++b) {
+            uchar value = dst[b * count + i];
+            if (i > 0)
+                value ^= values[(i - 1) * width + b];
+            values[i * width + b] = value;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+BinaryFile::BinaryFile(Flags flags)
+    : flags(flags)
+{}
+
+SpecFile::Dataset
+BinaryFile::read(const QString& fileName)
+{
+    Dataset dataset;
+    dataset.loaded = false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "BinaryFile: cannot open file:" << fileName;
+        return dataset;
+    }
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(Header))) {
+        qWarning() << "BinaryFile: file is truncated:" << fileName;
+        return dataset;
+    }
+    // mapped pages are read in place, falling back to a plain read where mapping is not supported
+    QByteArray buffer;
+    const char* base = reinterpret_cast<const char*>(file.map(0, fileSize));
+    if (!base) {
+        buffer = file.readAll();
+        base = buffer.constData();
+    }
+
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    const quint32 fileFlags = qFromLittleEndian(header.flags);
+    const quint32 rows = qFromLittleEndian(header.rows);
+    const quint32 columns = qFromLittleEndian(header.columns);
+    const quint64 stringsOffset = qFromLittleEndian(header.stringsOffset);
+    const quint64 stringsSize = qFromLittleEndian(header.stringsSize);
+    const quint64 wavelengthsOffset = qFromLittleEndian(header.wavelengthsOffset);
+    const quint64 dataOffset = qFromLittleEndian(header.dataOffset);
+    const quint64 dataSize = qFromLittleEndian(header.dataSize);
+    const int width = (fileFlags & Float32) ? sizeof(float) : sizeof(double);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || qFromLittleEndian(header.version) != version) {
+        qWarning() << "BinaryFile: not a spectral binary file:" << fileName;
+        return dataset;
+    }
+    // offsets and sizes are checked one by one against the file so that corrupt headers can not overflow the sums,
+    // decoded columns are bounded by the data in the file before anything is allocated
+    const quint64 columnSize = quint64(rows) * width;
+    bool valid = fits(stringsOffset, stringsSize, fileSize)
+                 && fits(wavelengthsOffset, quint64(rows) * sizeof(qint32), fileSize)
+                 && fits(dataOffset, dataSize, fileSize);
+    if (valid && columns > 0 && columnSize > 0) {
+        if (fileFlags & Packed) {
+            valid = quint64(columns) <= dataSize * maximumExpansion / columnSize;
+        }
+        else {
+            const quint64 columnStride = quint64(aligned(qint64(columnSize)));
+            valid = columns - 1 <= dataSize / columnStride && (columns - 1) * columnStride + columnSize <= dataSize;
+        }
+    }
+    if (!valid) {
+        qWarning() << "BinaryFile: file is truncated:" << fileName;
+        return dataset;
+    }
+
+    const char* strings = base + stringsOffset;
+    const char* stringsEnd = strings + stringsSize;
+    QString headerJson;
+    bool ok = takeString(strings, stringsEnd, dataset.name) && takeString(strings, stringsEnd, dataset.units)
+              && takeString(strings, stringsEnd, headerJson);
+    for (quint32 c = 0; ok && c < columns; ++c) {
+        QString index;
+        ok = takeString(strings, stringsEnd, index);
+        dataset.indices.append(index);
+    }
+    if (!ok) {
+        qWarning() << "BinaryFile: invalid string table:" << fileName;
+        return dataset;
+    }
+    dataset.header = QJsonDocument::fromJson(headerJson.toUtf8()).object().toVariantMap();
+    dataset.precision = (fileFlags & (Float32 | measured)) ? SpecFile::Float32 : SpecFile::Float64;
+
+    QVector<qint32> wavelengths(rows);
+    qFromLittleEndian<qint32>(base + wavelengthsOffset, rows, wavelengths.data());
+
+    // plain columns are read straight from the mapping, packed columns are decoded into one block first
+    const char* columnData = base + dataOffset;
+    qint64 stride = aligned(qint64(rows) * width);
+    QByteArray decoded;
+    if (fileFlags & Packed) {
+        stride = qint64(rows) * width;
+        decoded = QByteArray(stride * columns, Qt::Uninitialized);
+        const char* data = base + dataOffset;
+        const char* dataEnd = data + dataSize;
+        for (quint32 c = 0; c < columns; ++c) {
+            quint64 size;
+            if (dataEnd - data < qint64(sizeof(size))) {
+                ok = false;
+                break;
+            }
+            size = qFromLittleEndian<quint64>(data);
+            data += sizeof(size);
+            if (quint64(dataEnd - data) < size || !unpack(data, size, width, rows, decoded.data() + c * stride)) {
+                ok = false;
+                break;
+            }
+            data += size;
+        }
+        if (!ok) {
+            qWarning() << "BinaryFile: invalid packed data:" << fileName;
+            return dataset;
+        }
+        columnData = decoded.constData();
+    }
+
+    for (quint32 r = 0; r < rows; ++r) {
+        QVector<double> row(columns);
+        for (quint32 c = 0; c < columns; ++c) {
+            const char* value = columnData + c * stride + qint64(r) * width;
+            row[c] = (fileFlags & Float32) ? double(qFromLittleEndian<float>(value)) : qFromLittleEndian<double>(value);
+        }
+        dataset.data.insert(wavelengths[r], row);
+    }
+    dataset.loaded = true;
+    return dataset;
+}
+
+bool
+BinaryFile::write(const Dataset& dataset, const QString& fileName)
+{
+    const quint32 rows = dataset.data.size();
+    const quint32 columns = dataset.indices.size();
+    const int width = flags.testFlag(Float32) ? sizeof(float) : sizeof(double);
+
+    QByteArray strings;
+    appendString(strings, dataset.name);
+    appendString(strings, dataset.units);
+    appendString(strings,
+                 QString::fromUtf8(QJsonDocument(QJsonObject::fromVariantMap(dataset.header)).toJson(QJsonDocument::Compact)));
+    for (const QString& index : dataset.indices) {
+        appendString(strings, index);
+    }
+
+    QByteArray wavelengths;
+    wavelengths.reserve(rows * sizeof(qint32));
+    QVector<QByteArray> columnData(columns, QByteArray(qint64(rows) * width, '\0'));
+    quint32 r = 0;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it, ++r) {
+        qint32 wavelength = qToLittleEndian(qint32(it.key()));
+        wavelengths.append(reinterpret_cast<const char*>(&wavelength), sizeof(wavelength));
+        for (quint32 c = 0; c < columns; ++c) {
+            double value = it.value().value(c, 0.0);
+            char* dst = columnData[c].data() + qint64(r) * width;
+            if (width == sizeof(float))
+                qToLittleEndian<float>(float(value), dst);
+            else
+                qToLittleEndian<double>(value, dst);
+        }
+    }
+
+    QByteArray data;
+    for (quint32 c = 0; c < columns; ++c) {
+        if (flags.testFlag(Packed)) {
+            QByteArray packed = pack(columnData[c], width);
+            quint64 size = qToLittleEndian(quint64(packed.size()));
+            data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            data.append(packed);
+        }
+        else {
+            data.append(columnData[c]);
+            data.append(QByteArray(aligned(data.size()) - data.size(), '\0'));
+        }
+    }
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    const qint64 stringsOffset = sizeof(Header);
+    const qint64 wavelengthsOffset = aligned(stringsOffset + strings.size());
+    const qint64 dataOffset = aligned(wavelengthsOffset + wavelengths.size());
+    header.version = qToLittleEndian(version);
+    header.flags = qToLittleEndian(quint32(flags.toInt()) | (dataset.precision == SpecFile::Float32 ? measured : 0));
+    header.rows = qToLittleEndian(rows);
+    header.columns = qToLittleEndian(columns);
+    header.stringsOffset = qToLittleEndian(quint64(stringsOffset));
+    header.stringsSize = qToLittleEndian(quint64(strings.size()));
+    header.wavelengthsOffset = qToLittleEndian(quint64(wavelengthsOffset));
+    header.dataOffset = qToLittleEndian(quint64(dataOffset));
+    header.dataSize = qToLittleEndian(quint64(data.size()));
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "BinaryFile: cannot write file:" << fileName;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(strings);
+    file.write(QByteArray(wavelengthsOffset - stringsOffset - strings.size(), '\0'));
+    file.write(wavelengths);
+    file.write(QByteArray(dataOffset - wavelengthsOffset - wavelengths.size(), '\0'));
+    file.write(data);
+    return file.commit();
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+// compact binary format, a fixed header followed by a string table and one aligned column per index that can be
+// memory mapped and copied out without parsing. columns are float64 or float32 and optionally delta + byte-shuffle
+// packed, packed files are smaller but have to be decoded
+class BinaryFile : public SpecFile {
+public:
+    enum Flag { Float32 = 0x1, Packed = 0x2 };
+    Q_DECLARE_FLAGS(Flags, Flag)
+
+    BinaryFile(Flags flags = Flags());
+    Dataset read(const QString& fileName) override;
+    bool write(const Dataset& dataset, const QString& fileName) override;
+    QStringList extensions() override { return { "specbin" }; }
+
+private:
+    Flags flags;
+};
+Q_DECLARE_OPERATORS_FOR_FLAGS(BinaryFile::Flags)
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "../resampler.h"
+#include "../specio.h"
+#include "filejobs.h"
+
+#include <QAtomicInteger>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+struct ConvertOptions {
+    int start = 0;
+    int end = 0;
+    int step = 0;  // no resampling when zero
+    Resampler::Method method = Resampler::Linear;
+    bool force = false;
+};
+
+struct ConvertStats {
+    QAtomicInteger<qint64> bytesRead;
+    QAtomicInteger<qint64> bytesWritten;
+    QAtomicInt converted;
+    QAtomicInt skipped;
+    QAtomicInt failed;
+};
+
+void
+convertFile(const FileJob& job, const ConvertOptions& options, ConvertStats& stats)
+{
+    QFileInfo input(job.input);
+    if (input.absoluteFilePath() == QFileInfo(job.output).absoluteFilePath()) {
+        qWarning() << "specviz-convert: output would overwrite input:" << job.input;
+        stats.skipped.fetchAndAddRelaxed(1);
+        return;
+    }
+    if (!options.force && QFileInfo::exists(job.output)) {
+        stats.skipped.fetchAndAddRelaxed(1);
+        return;
+    }
+    SpecIO spec(job.input);
+    if (!spec.isLoaded()) {
+        qWarning() << "specviz-convert: could not load dataset from:" << job.input;
+        stats.failed.fetchAndAddRelaxed(1);
+        return;
+    }
+    stats.bytesRead.fetchAndAddRelaxed(input.size());
+    QDir().mkpath(QFileInfo(job.output).absolutePath());
+    bool success = false;
+    if (options.step > 0) {
+        const SpecFile::Dataset& dataset = spec.data();
+        int start = options.start;
+        int end = options.end;
+        if (start == 0 && end == 0 && !dataset.data.isEmpty()) {
+            start = dataset.data.firstKey();
+            end = dataset.data.lastKey();
+        }
+        // weights are cached per grid pair, an archive on a few grids computes them only a few times
+        QVector<double> grid = Resampler::uniformGrid(start, end, options.step);
+        success = SpecIO::write(Resampler::resample(dataset, grid, options.method), job.output);
+    }
+    else {
+        success = SpecIO::write(spec.data(), job.output);
+    }
+    if (!success) {
+        qWarning() << "specviz-convert: could not write dataset to:" << job.output;
+        stats.failed.fetchAndAddRelaxed(1);
+        return;
+    }
+    stats.bytesWritten.fetchAndAddRelaxed(QFileInfo(job.output).size());
+    stats.converted.fetchAndAddRelaxed(1);
+}
+
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("specviz-convert");
+    QCoreApplication::setApplicationVersion(PROJECT_VERSION);
+
+    QStringList extensions = SpecIO::availableExtensions();
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts spectral data files and directory trees between formats.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption toOption({ "t", "to" }, QString("Output format: %1.").arg(extensions.join(", ")), "ext");
+    QCommandLineOption outputOption({ "o", "output" }, "Output directory.", "dir", ".");
+    QCommandLineOption stepOption("step", "Resample to a wavelength step in nm.", "nm");
+    QCommandLineOption methodOption("method", "Resampling method: linear, sprague or akima.", "method", "linear");
+    QCommandLineOption rangeOption("range", "Resampled wavelength range in nm, defaults to the input range.",
+                                   "start:end");
+    QCommandLineOption jobsOption({ "j", "jobs" }, "Number of conversion threads.", "n",
+                                  QString::number(QThread::idealThreadCount()));
+    QCommandLineOption forceOption("force", "Overwrite existing output files.");
+    QCommandLineOption quietOption({ "q", "quiet" }, "Only report errors.");
+    parser.addOptions({ toOption, outputOption, stepOption, methodOption, rangeOption, jobsOption, forceOption, quietOption });
+    parser.addPositionalArgument("inputs", "Spectral data files or directories.", "inputs...");
+    addCacheOptions(parser);
+    parser.process(app);
+    applyCacheOptions(parser);
+
+    QString extension = parser.value(toOption).toLower();
+    if (!extensions.contains(extension)) {
+        qWarning() << "specviz-convert: unsupported output format:" << extension;
+        return 1;
+    }
+    ConvertOptions options;
+    options.force = parser.isSet(forceOption);
+    if (parser.isSet(stepOption)) {
+        options.step = parser.value(stepOption).toInt();
+        if (options.step <= 0) {
+            qWarning() << "specviz-convert: invalid step:" << parser.value(stepOption);
+            return 1;
+        }
+    }
+    bool ok = false;
+    options.method = Resampler::method(parser.value(methodOption), &ok);
+    if (!ok) {
+        qWarning() << "specviz-convert: unsupported resampling method:" << parser.value(methodOption);
+        return 1;
+    }
+    if (parser.isSet(rangeOption)) {
+        QStringList range = parser.value(rangeOption).split(':');
+        options.start = range.value(0).toInt();
+        options.end = range.value(1).toInt();
+        if (range.size() != 2 || options.end <= options.start || options.step <= 0) {
+            qWarning() << "specviz-convert: --range needs start:end and a --step";
+            return 1;
+        }
+    }
+    QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QList<FileJob> jobs = uniqueOutputs(collectFileJobs(inputs, parser.value(outputOption), extension));
+    ConvertStats stats;
+    QElapsedTimer timer;
+    timer.start();
+    {
+        // read, resample and write of each file is one task, files are independent and run in parallel
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMax(1, parser.value(jobsOption).toInt()));
+        for (const FileJob& job : jobs) {
+            pool.start([job, &options, &stats]() { convertFile(job, options, stats); });
+        }
+        pool.waitForDone();
+    }
+
+    if (!parser.isSet(quietOption)) {
+        double seconds = qMax(timer.nsecsElapsed() / 1e9, 1e-9);
+        double megabytes = stats.bytesRead.loadRelaxed() / (1024.0 * 1024.0);
+        QTextStream(stdout) << QString("specviz-convert: converted %1, skipped %2, failed %3 of %4 files in %5 s "
+                                       "(%6 files/s, %7 MB/s read, %8 MB written)\n")
+                                   .arg(stats.converted.loadRelaxed())
+                                   .arg(stats.skipped.loadRelaxed())
+                                   .arg(stats.failed.loadRelaxed())
+                                   .arg(jobs.size())
+                                   .arg(seconds, 0, 'f', 2)
+                                   .arg(stats.converted.loadRelaxed() / seconds, 0, 'f', 1)
+                                   .arg(megabytes / seconds, 0, 'f', 1)
+                                   .arg(stats.bytesWritten.loadRelaxed() / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    return stats.failed.loadRelaxed() > 0 ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "filejobs.h"
+#include "../speccache.h"
+#include "../specio.h"
+
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QHash>
+
+QList<FileJob>
+collectFileJobs(const QStringList& inputs, const QString& outputDir, const QString& extension)
+{
+    QStringList filters;
+    for (const QString& ext : SpecIO::availableExtensions()) {
+        filters.append("*." + ext);
+    }
+    QList<FileJob> jobs;
+    auto append = [&](const QString& fileName, const QString& relativeName) {
+        QFileInfo relative(relativeName);
+        QString output = QDir::cleanPath(QDir(outputDir).filePath(
+            QDir(relative.path()).filePath(QString("%1.%2").arg(relative.completeBaseName(), extension))));
+        jobs.append({ fileName, output });
+    };
+    for (const QString& input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDir dir(input);
+            QStringList fileNames;
+            QDirIterator it(input, filters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                fileNames.append(it.next());
+            }
+            fileNames.sort();
+            for (const QString& fileName : fileNames) {
+                append(fileName, dir.relativeFilePath(fileName));
+            }
+        }
+        else if (info.isFile()) {
+            append(input, info.fileName());
+        }
+        else {
+            qWarning() << "FileJobs: no such file or directory:" << input;
+        }
+    }
+    return jobs;
+}
+
+QList<FileJob>
+uniqueOutputs(const QList<FileJob>& jobs)
+{
+    QList<FileJob> unique;
+    QHash<QString, QString> outputs;  // output to the input that claimed it
+    for (const FileJob& job : jobs) {
+        // inputs that only differ by suffix map to the same output, jobs run in parallel so the first one is kept
+        auto claimed = outputs.constFind(job.output);
+        if (claimed != outputs.constEnd()) {
+            qWarning() << "FileJobs: skipping" << job.input << "with the same output as" << claimed.value() << ":"
+                       << job.output;
+            continue;
+        }
+        outputs.insert(job.output, job.input);
+        unique.append(job);
+    }
+    return unique;
+}
+
+void
+addCacheOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({ QCommandLineOption("no-cache", "Do not read or write the dataset cache."),
+                        QCommandLineOption("clear-cache", "Remove all dataset cache entries first."),
+                        QCommandLineOption("cache-budget", "Dataset cache size in MB, oldest entries are removed.",
+                                           "MB") });
+}
+
+void
+applyCacheOptions(const QCommandLineParser& parser)
+{
+    SpecCache* cache = SpecCache::instance();
+    if (parser.isSet("clear-cache")) {
+        cache->clear();
+    }
+    if (parser.isSet("cache-budget")) {
+        cache->setBudget(parser.value("cache-budget").toLongLong() * 1024 * 1024);
+    }
+    if (parser.isSet("no-cache")) {
+        cache->setEnabled(false);
+    }
+}
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QCommandLineParser;
+
+struct FileJob {
+    QString input;
+    QString output;
+};
+
+// expands files and directory trees of supported spectral files to jobs, directory trees are mirrored below
+// outputDir with the suffix replaced by extension
+QList<FileJob>
+collectFileJobs(const QStringList& inputs, const QString& outputDir, const QString& extension);
+
+// jobs that write an output already claimed by an earlier job are skipped with a warning
+QList<FileJob>
+uniqueOutputs(const QList<FileJob>& jobs);
+
+// --no-cache, --clear-cache and --cache-budget for the tools that read spectral files
+void
+addCacheOptions(QCommandLineParser& parser);
+void
+applyCacheOptions(const QCommandLineParser& parser);
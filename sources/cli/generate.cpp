@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "../specgenerator.h"
+#include "../parallel.h"
+
+#include <QAtomicInteger>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+
+namespace {
+// sizes with an optional k, m, g or t suffix in powers of 1024
+qint64
+parseSize(const QString& text, bool* ok)
+{
+    QString value = text.trimmed().toLower();
+    qint64 scale = 1;
+    const QString suffixes = "kmgt";
+    if (!value.isEmpty() && suffixes.contains(value.back())) {
+        scale = qint64(1) << (10 * (suffixes.indexOf(value.back()) + 1));
+        value.chop(1);
+    }
+    const double size = value.toDouble(ok);
+    return *ok && size > 0.0 ? qint64(size * scale) : 0;
+}
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("specviz-generate");
+    QCoreApplication::setApplicationVersion(PROJECT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates synthetic spectral data files for benchmarks and stress tests.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption formatOption({ "f", "format" }, "Output format: argyll or ampas.", "format", "argyll");
+    QCommandLineOption bandsOption({ "b", "bands" }, "Bands per spectrum, up to 100000.", "n", "401");
+    QCommandLineOption setsOption("sets", "Spectra per file.", "n", "1");
+    QCommandLineOption startOption("start", "First wavelength in nm.", "nm", "380");
+    QCommandLineOption stepOption("step", "Wavelength step in nm, may be fractional but at least 1.", "nm", "1");
+    QCommandLineOption noiseOption("noise", "Noise relative to the peak.", "sigma", "0.01");
+    QCommandLineOption headerOption("header-fields", "Extra header fields per file.", "n", "0");
+    QCommandLineOption seedOption("seed", "Random seed, the same seed gives the same files.", "n", "1");
+    QCommandLineOption countOption({ "n", "count" }, "Number of files.", "n", "1");
+    QCommandLineOption totalOption("total-size", "Fill a directory tree up to a size, e.g 4G.", "size");
+    QCommandLineOption perDirectoryOption("files-per-dir", "Files per directory in a tree.", "n", "1000");
+    QCommandLineOption quietOption({ "q", "quiet" }, "Only report errors.");
+    parser.addOptions({ formatOption, bandsOption, setsOption, startOption, stepOption, noiseOption, headerOption,
+                        seedOption, countOption, totalOption, perDirectoryOption, quietOption });
+    parser.addPositionalArgument("output", "Output file, or directory for several files and trees.", "output");
+    parser.process(app);
+
+    QString format = parser.value(formatOption).toLower();
+    if (format != "argyll" && format != "ampas") {
+        qWarning() << "specviz-generate: unsupported format:" << format;
+        return 1;
+    }
+    SpecGenerator::Format type = format == "ampas" ? SpecGenerator::Ampas : SpecGenerator::Argyll;
+    SpecGenerator::Options options;
+    options.bands = parser.value(bandsOption).toInt();
+    options.sets = parser.value(setsOption).toInt();
+    options.start = parser.value(startOption).toDouble();
+    options.step = parser.value(stepOption).toDouble();
+    options.noise = parser.value(noiseOption).toDouble();
+    options.headerFields = qMax(0, parser.value(headerOption).toInt());
+    options.seed = parser.value(seedOption).toUInt();
+    if (options.bands < 1 || options.bands > 100000 || options.sets < 1 || options.step < 1.0) {
+        qWarning() << "specviz-generate: invalid bands, sets or step, steps below 1 nm are not supported";
+        return 1;
+    }
+    QStringList outputs = parser.positionalArguments();
+    if (outputs.size() != 1) {
+        parser.showHelp(1);
+    }
+    const QString output = outputs.first();
+    const int count = qMax(1, parser.value(countOption).toInt());
+    bool quiet = parser.isSet(quietOption);
+    SpecGenerator generator(options);
+
+    QElapsedTimer timer;
+    timer.start();
+    SpecGenerator::Tree tree;
+    if (parser.isSet(totalOption)) {
+        bool ok = false;
+        qint64 total = parseSize(parser.value(totalOption), &ok);
+        if (!ok || total <= 0) {
+            qWarning() << "specviz-generate: invalid total size:" << parser.value(totalOption);
+            return 1;
+        }
+        tree = generator.writeTree(type, output, total, parser.value(perDirectoryOption).toInt());
+    }
+    else if (count == 1 && !QFileInfo(output).isDir()) {
+        if (generator.write(type, 0, output)) {
+            tree.files = 1;
+            tree.bytes = QFileInfo(output).size();
+        }
+        else {
+            tree.failed = 1;
+        }
+    }
+    else {
+        if (!QDir().mkpath(output)) {
+            qWarning() << "specviz-generate: cannot create directory:" << output;
+            return 1;
+        }
+        QAtomicInteger<int> files = 0;
+        QAtomicInteger<int> failed = 0;
+        QAtomicInteger<qint64> bytes = 0;
+        parallel::forEachBlock(count, parallel::grainSize(count, 4), [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                const QString fileName = QDir(output).filePath(
+                    QString("synthetic_%1.%2").arg(i, 6, 10, QChar('0')).arg(SpecGenerator::extension(type)));
+                if (generator.write(type, i, fileName)) {
+                    files.fetchAndAddRelaxed(1);
+                    bytes.fetchAndAddRelaxed(QFileInfo(fileName).size());
+                }
+                else {
+                    failed.fetchAndAddRelaxed(1);
+                }
+            }
+        });
+        tree.files = files.loadRelaxed();
+        tree.failed = failed.loadRelaxed();
+        tree.bytes = bytes.loadRelaxed();
+    }
+
+    if (!quiet) {
+        double seconds = timer.nsecsElapsed() / 1e9;
+        QTextStream(stdout) << QString("specviz-generate: wrote %1 files, %2 MB in %3 s (%4 MB/s)\n")
+                                   .arg(tree.files)
+                                   .arg(tree.bytes / 1e6, 0, 'f', 1)
+                                   .arg(seconds, 0, 'f', 2)
+                                   .arg(seconds > 0.0 ? tree.bytes / 1e6 / seconds : 0.0, 0, 'f', 1);
+    }
+    return tree.failed > 0 || tree.files == 0 ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "../plotrenderer.h"
+#include "../specio.h"
+#include "filejobs.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QProcess>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+// parses datasets on a thread pool ahead of the renderer, which has to stay on the gui thread
+class DatasetQueue {
+public:
+    DatasetQueue(const QList<FileJob>& jobs, int threads);
+    ~DatasetQueue();
+    SpecFile::Dataset take(int index);
+
+private:
+    void submit(int index);
+    QList<FileJob> jobs;
+    int lookahead;
+    int submitted;
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition ready;
+    QHash<int, SpecFile::Dataset> datasets;
+};
+
+DatasetQueue::DatasetQueue(const QList<FileJob>& jobs, int threads)
+    : jobs(jobs)
+    , lookahead(threads * 2)
+    , submitted(0)
+{
+    pool.setMaxThreadCount(threads);
+}
+
+DatasetQueue::~DatasetQueue()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+SpecFile::Dataset
+DatasetQueue::take(int index)
+{
+    while (submitted < jobs.size() && submitted <= index + lookahead) {
+        submit(submitted++);
+    }
+    QMutexLocker locker(&mutex);
+    while (!datasets.contains(index)) {
+        ready.wait(&mutex);
+    }
+    return datasets.take(index);
+}
+
+void
+DatasetQueue::submit(int index)
+{
+    pool.start([this, index]() {
+        SpecIO spec(jobs[index].input);
+        SpecFile::Dataset dataset = spec.data();
+        QMutexLocker locker(&mutex);
+        datasets.insert(index, dataset);
+        ready.wakeAll();
+    });
+}
+
+int
+renderJobs(const QList<FileJob>& jobs, const QSize& size, double scale, int threads)
+{
+    PlotRenderer renderer;
+    renderer.setSize(size);
+    renderer.setScale(scale);
+    DatasetQueue queue(jobs, threads);
+    int failed = 0;
+    for (int i = 0; i < jobs.size(); ++i) {
+        SpecFile::Dataset dataset = queue.take(i);
+        if (!dataset.loaded) {
+            qWarning() << "specviz-render: could not load dataset from:" << jobs[i].input;
+            failed++;
+            continue;
+        }
+        QDir().mkpath(QFileInfo(jobs[i].output).absolutePath());
+        if (!renderer.render(dataset, jobs[i].output)) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+int
+spawnWorkers(int count, const QStringList& arguments)
+{
+    QList<QProcess*> processes;
+    for (int i = 0; i < count; ++i) {
+        QProcess* process = new QProcess();
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(),
+                       QStringList() << arguments << "--shard" << QString("%1/%2").arg(i).arg(count));
+        processes.append(process);
+    }
+    int failed = 0;
+    for (QProcess* process : processes) {
+        if (!process->waitForFinished(-1) || process->exitStatus() != QProcess::NormalExit) {
+            qWarning() << "specviz-render: worker process failed:" << process->errorString();
+            failed++;
+        }
+        else {
+            failed += process->exitCode();
+        }
+        delete process;
+    }
+    return failed;
+}
+
+int
+main(int argc, char* argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("specviz-render");
+    QCoreApplication::setApplicationVersion(PROJECT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders spectral data files to png, pdf or svg plots.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption outputOption({ "o", "output" }, "Output directory.", "dir", ".");
+    QCommandLineOption formatOption({ "f", "format" }, "Output format: png, pdf or svg.", "format", "png");
+    QCommandLineOption sizeOption({ "s", "size" }, "Plot size in pixels.", "WxH", "800x500");
+    QCommandLineOption scaleOption("scale", "Scale factor of png output.", "factor", "1.0");
+    QCommandLineOption jobsOption({ "j", "jobs" }, "Number of render processes.", "n",
+                                  QString::number(QThread::idealThreadCount()));
+    QCommandLineOption shardOption("shard", "Render every n:th file starting at i.", "i/n");
+    shardOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    QCommandLineOption quietOption({ "q", "quiet" }, "Only report errors.");
+    parser.addOptions({ outputOption, formatOption, sizeOption, scaleOption, jobsOption, shardOption, quietOption });
+    parser.addPositionalArgument("inputs", "Spectral data files or directories.", "inputs...");
+    addCacheOptions(parser);
+    parser.process(app);
+    applyCacheOptions(parser);
+
+    QString format = parser.value(formatOption).toLower();
+    if (!PlotRenderer::availableFormats().contains(format)) {
+        qWarning() << "specviz-render: unsupported format:" << format;
+        return 1;
+    }
+    QStringList sizes = parser.value(sizeOption).split('x');
+    QSize size = sizes.size() == 2 ? QSize(sizes[0].toInt(), sizes[1].toInt()) : QSize();
+    double scale = parser.value(scaleOption).toDouble();
+    if (size.isEmpty() || scale <= 0.0) {
+        qWarning() << "specviz-render: invalid size or scale";
+        return 1;
+    }
+    QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QList<FileJob> jobs = uniqueOutputs(collectFileJobs(inputs, parser.value(outputOption), format));
+    int processes = qBound(1, parser.value(jobsOption).toInt(), qMax(1, int(jobs.size())));
+    bool quiet = parser.isSet(quietOption);
+
+    QElapsedTimer timer;
+    timer.start();
+    int failed = 0;
+    if (parser.isSet(shardOption)) {
+        QStringList shard = parser.value(shardOption).split('/');
+        int index = shard.value(0).toInt();
+        int count = qMax(1, shard.value(1).toInt());
+        QList<FileJob> subset;
+        for (int i = index; i < jobs.size(); i += count) {
+            subset.append(jobs[i]);
+        }
+        return qMin(renderJobs(subset, size, scale, 1), 255);
+    }
+    else if (processes > 1) {
+        // qcustomplot is a widget and can only render on the gui thread, scale out with processes
+        QStringList arguments;
+        arguments << "--output" << parser.value(outputOption) << "--format" << format << "--size"
+                  << parser.value(sizeOption) << "--scale" << parser.value(scaleOption);
+        if (parser.isSet("no-cache")) {
+            arguments << "--no-cache";  // the cache is cleared once, here
+        }
+        if (parser.isSet("cache-budget")) {
+            arguments << "--cache-budget" << parser.value("cache-budget");
+        }
+        arguments << inputs;
+        failed = spawnWorkers(processes, arguments);
+    }
+    else {
+        failed = renderJobs(jobs, size, scale, QThread::idealThreadCount());
+    }
+
+    if (!quiet) {
+        double seconds = timer.nsecsElapsed() / 1e9;
+        QTextStream(stdout) << QString("specviz-render: rendered %1 of %2 plots in %3 s (%4 plots/s, %5 processes)\n")
+                                   .arg(jobs.size() - failed)
+                                   .arg(jobs.size())
+                                   .arg(seconds, 0, 'f', 2)
+                                   .arg(seconds > 0.0 ? (jobs.size() - failed) / seconds : 0.0, 0, 'f', 1)
+                                   .arg(processes);
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "../colorimetry.h"
+#include "../spectrallibrary.h"
+#include "../specio.h"
+#include "filejobs.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("specviz-search");
+    QCoreApplication::setApplicationVersion(PROJECT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Finds the closest spectra in a library of spectral data files.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption libraryOption({ "l", "library" }, "Library file or directory, can be repeated.", "path");
+    QCommandLineOption metricOption({ "m", "metric" }, "Distance: rms, angle or de2000.", "metric", "rms");
+    QCommandLineOption illuminantOption("illuminant", "Illuminant for de2000: e, a, d50, d55, d65 or d75.", "name",
+                                        "d65");
+    QCommandLineOption countOption("k", "Number of matches per query spectrum.", "n", "5");
+    QCommandLineOption normalizeOption("normalize", "Normalization: none or peak.", "mode", "none");
+    QCommandLineOption dimensionsOption("dimensions", "Search rms over principal components, 0 for full spectra.",
+                                        "n", "0");
+    QCommandLineOption bruteForceOption("brute-force", "Scan the whole library instead of using the index.");
+    QCommandLineOption quietOption({ "q", "quiet" }, "Only report matches and errors.");
+    parser.addOptions({ libraryOption, metricOption, illuminantOption, countOption, normalizeOption,
+                        dimensionsOption, bruteForceOption, quietOption });
+    parser.addPositionalArgument("queries", "Spectral data files to find matches for.", "queries...");
+    addCacheOptions(parser);
+    parser.process(app);
+    applyCacheOptions(parser);
+
+    bool ok = false;
+    SpectralLibrary::Metric metric = SpectralLibrary::metric(parser.value(metricOption), &ok);
+    if (!ok) {
+        qWarning() << "specviz-search: unsupported metric:" << parser.value(metricOption);
+        return 1;
+    }
+    QString normalize = parser.value(normalizeOption).toLower();
+    if (normalize != "none" && normalize != "peak") {
+        qWarning() << "specviz-search: unsupported normalization:" << normalize;
+        return 1;
+    }
+    SpectralLibrary library(Resampler::uniformGrid(380, 780, 5),
+                            normalize == "peak" ? SpectralLibrary::Peak : SpectralLibrary::None);
+    QVector<double> illuminant = Colorimetry::illuminant(parser.value(illuminantOption), library.grid(), &ok);
+    if (!ok) {
+        qWarning() << "specviz-search: unsupported illuminant:" << parser.value(illuminantOption);
+        return 1;
+    }
+    library.setIlluminant(illuminant);
+    library.setDimensions(parser.value(dimensionsOption).toInt());
+    QStringList queries = parser.positionalArguments();
+    if (queries.isEmpty() || !parser.isSet(libraryOption)) {
+        parser.showHelp(1);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList fileNames;
+    for (const FileJob& job : collectFileJobs(parser.values(libraryOption), QString(), QString())) {
+        fileNames.append(job.input);
+    }
+    int files = library.addFiles(fileNames);
+    if (!parser.isSet(quietOption)) {
+        QTextStream(stderr) << QString("specviz-search: %1 spectra from %2 files in %3 s\n")
+                                   .arg(library.count())
+                                   .arg(files)
+                                   .arg(timer.nsecsElapsed() / 1e9, 0, 'f', 2);
+    }
+
+    QTextStream out(stdout);
+    int failed = 0;
+    const int k = qMax(1, parser.value(countOption).toInt());
+    for (const QString& fileName : queries) {
+        SpecIO spec(fileName);
+        if (!spec.isLoaded()) {
+            qWarning() << "specviz-search: could not load dataset from:" << fileName;
+            ++failed;
+            continue;
+        }
+        const SpecFile::Dataset& dataset = spec.data();
+        for (int c = 0; c < dataset.indices.size(); ++c) {
+            out << QString("%1: %2\n").arg(fileName, dataset.indices[c]);
+            const QList<SpectralLibrary::Match> matches
+                = library.find(library.spectrum(dataset, c), k, metric, !parser.isSet(bruteForceOption));
+            for (int i = 0; i < matches.size(); ++i) {
+                const SpectralLibrary::Entry& entry = library.entry(matches[i].entry);
+                out << QString("  %1  %2  %3: %4 (%5)\n")
+                           .arg(i + 1, 2)
+                           .arg(matches[i].distance, 10, 'f', 4)
+                           .arg(entry.name, entry.channel, entry.fileName);
+            }
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "colorimetry.h"
+
+#include <QtMath>
+#include <cmath>
+
+namespace {
+// cie daylight basis functions, 380 to 780 nm in 10 nm steps
+const double daylightS0[41] = { 63.4,  65.8,  94.8,  104.8, 105.9, 96.8,  113.9, 125.6, 125.5, 121.3, 121.3,
+                                113.5, 113.1, 110.8, 106.5, 108.8, 105.3, 104.4, 100.0, 96.0,  95.1,  89.1,
+                                90.5,  90.3,  88.4,  84.0,  85.1,  81.9,  82.6,  84.9,  81.3,  71.9,  74.3,
+                                76.4,  63.3,  71.7,  77.0,  65.2,  47.7,  68.6,  65.0 };
+const double daylightS1[41] = { 38.5,  35.0,  43.4,  46.3,  43.9,  37.1,  36.7,  35.9,  32.6,  27.9,  24.3,
+                                20.1,  16.2,  13.2,  8.6,   6.1,   4.2,   1.9,   0.0,   -1.6,  -3.5,  -3.5,
+                                -5.8,  -7.2,  -8.6,  -9.5,  -10.9, -10.7, -12.0, -14.0, -13.6, -12.0, -13.3,
+                                -12.9, -10.6, -11.6, -12.2, -10.2, -7.8,  -11.2, -10.4 };
+const double daylightS2[41] = { 3.0,  1.2,  -1.1, -0.5, -0.7, -1.2, -2.6, -2.9, -2.8, -2.6, -2.6, -1.8, -1.5, -1.3,
+                                -1.2, -1.0, -0.5, -0.3, 0.0,  0.2,  0.5,  2.1,  3.2,  4.1,  4.7,  5.1,  6.7,  7.3,
+                                8.6,  9.8,  10.2, 8.3,  9.6,  8.5,  7.0,  7.6,  8.0,  6.7,  5.2,  7.4,  6.8 };
+
+double
+tabulated(const double* table, double wavelength)
+{
+    // linear between the 10 nm samples, held at the ends
+    const double position = qBound(0.0, (wavelength - 380.0) / 10.0, 40.0);
+    const int i = qMin(int(position), 39);
+    const double r = position - i;
+    return table[i] * (1.0 - r) + table[i + 1] * r;
+}
+
+double
+lobe(double wavelength, double mean, double lower, double upper)
+{
+    const double t = (wavelength - mean) / (wavelength < mean ? lower : upper);
+    return std::exp(-0.5 * t * t);
+}
+
+double
+planck(double wavelength, double temperature)
+{
+    // c2 as in the cie definition of illuminant a, the constant factor cancels out in the normalization
+    const double c2 = 1.435e-2;
+    const double lambda = wavelength * 1e-9;
+    return 1.0 / (std::pow(lambda, 5.0) * (std::exp(c2 / (lambda * temperature)) - 1.0));
+}
+
+double
+labf(double t)
+{
+    const double delta = 6.0 / 29.0;
+    return t > delta * delta * delta ? std::cbrt(t) : t / (3.0 * delta * delta) + 4.0 / 29.0;
+}
+
+double
+hue(double b, double a)
+{
+    if (a == 0.0 && b == 0.0) {
+        return 0.0;
+    }
+    double h = qRadiansToDegrees(std::atan2(b, a));
+    return h < 0.0 ? h + 360.0 : h;
+}
+}  // namespace
+
+QVector<double>
+Colorimetry::observer(const QVector<double>& grid)
+{
+    const int size = grid.size();
+    QVector<double> cmfs(qsizetype(size) * 3);
+    for (int i = 0; i < size; ++i) {
+        const double w = grid[i];
+        cmfs[i] = 1.056 * lobe(w, 599.8, 37.9, 31.0) + 0.362 * lobe(w, 442.0, 16.0, 26.7)
+                  - 0.065 * lobe(w, 501.1, 20.4, 26.2);
+        cmfs[size + i] = 0.821 * lobe(w, 568.8, 46.9, 40.5) + 0.286 * lobe(w, 530.9, 16.3, 31.1);
+        cmfs[2 * size + i] = 1.217 * lobe(w, 437.0, 11.8, 36.0) + 0.681 * lobe(w, 459.0, 26.0, 13.8);
+    }
+    return cmfs;
+}
+
+QVector<double>
+Colorimetry::illuminant(const QString& name, const QVector<double>& grid, bool* ok)
+{
+    const QString upper = name.toUpper();
+    if (ok) {
+        *ok = true;
+    }
+    if (upper == "A") {
+        return blackbody(2856.0, grid);
+    }
+    if (upper == "D50") {
+        return daylight(5003.0, grid);
+    }
+    if (upper == "D55") {
+        return daylight(5503.0, grid);
+    }
+    if (upper == "D65") {
+        return daylight(6504.0, grid);
+    }
+    if (upper == "D75") {
+        return daylight(7504.0, grid);
+    }
+    if (ok) {
+        *ok = upper == "E";
+    }
+    return QVector<double>(grid.size(), 100.0);
+}
+
+QVector<double>
+Colorimetry::daylight(double temperature, const QVector<double>& grid)
+{
+    const double t = qBound(4000.0, temperature, 25000.0);
+    const double x = t <= 7000.0 ? -4.6070e9 / (t * t * t) + 2.9678e6 / (t * t) + 0.09911e3 / t + 0.244063
+                                 : -2.0064e9 / (t * t * t) + 1.9018e6 / (t * t) + 0.24748e3 / t + 0.237040;
+    const double y = -3.0 * x * x + 2.870 * x - 0.275;
+    const double m = 0.0241 + 0.2562 * x - 0.7341 * y;
+    const double m1 = (-1.3515 - 1.7703 * x + 5.9114 * y) / m;
+    const double m2 = (0.0300 - 31.4424 * x + 30.0717 * y) / m;
+    QVector<double> spd(grid.size());
+    for (int i = 0; i < grid.size(); ++i) {
+        spd[i] = tabulated(daylightS0, grid[i]) + m1 * tabulated(daylightS1, grid[i])
+                 + m2 * tabulated(daylightS2, grid[i]);
+    }
+    return spd;
+}
+
+QVector<double>
+Colorimetry::blackbody(double temperature, const QVector<double>& grid)
+{
+    const double reference = planck(560.0, temperature);
+    QVector<double> spd(grid.size());
+    for (int i = 0; i < grid.size(); ++i) {
+        spd[i] = 100.0 * planck(grid[i], temperature) / reference;
+    }
+    return spd;
+}
+
+QVector<double>
+Colorimetry::weights(const QVector<double>& illuminant, const QVector<double>& grid)
+{
+    const int size = grid.size();
+    QVector<double> weights = observer(grid);
+    double sum = 0.0;
+    for (int i = 0; i < size; ++i) {
+        sum += illuminant.value(i, 0.0) * weights[size + i];
+    }
+    const double k = sum > 0.0 ? 100.0 / sum : 0.0;
+    for (int c = 0; c < 3; ++c) {
+        for (int i = 0; i < size; ++i) {
+            weights[c * size + i] *= k * illuminant.value(i, 0.0);
+        }
+    }
+    return weights;
+}
+
+void
+Colorimetry::lab(const double xyz[3], const double white[3], double lab[3])
+{
+    const double fx = labf(xyz[0] / white[0]);
+    const double fy = labf(xyz[1] / white[1]);
+    const double fz = labf(xyz[2] / white[2]);
+    lab[0] = 116.0 * fy - 16.0;
+    lab[1] = 500.0 * (fx - fy);
+    lab[2] = 200.0 * (fy - fz);
+}
+
+double
+Colorimetry::deltaE2000(const double lab1[3], const double lab2[3])
+{
+    // sharma, wu and dalal 2005 formulation
+    const double c1 = std::hypot(lab1[1], lab1[2]);
+    const double c2 = std::hypot(lab2[1], lab2[2]);
+    const double cb7 = std::pow((c1 + c2) / 2.0, 7.0);
+    const double g = 0.5 * (1.0 - std::sqrt(cb7 / (cb7 + 6103515625.0)));  // 25^7
+    const double a1 = (1.0 + g) * lab1[1];
+    const double a2 = (1.0 + g) * lab2[1];
+    const double c1p = std::hypot(a1, lab1[2]);
+    const double c2p = std::hypot(a2, lab2[2]);
+    const double h1p = hue(lab1[2], a1);
+    const double h2p = hue(lab2[2], a2);
+
+    const double dl = lab2[0] - lab1[0];
+    const double dc = c2p - c1p;
+    double dh = 0.0;
+    if (c1p * c2p != 0.0) {
+        dh = h2p - h1p;
+        if (dh > 180.0) {
+            dh -= 360.0;
+        }
+        else if (dh < -180.0) {
+            dh += 360.0;
+        }
+    }
+    const double dH = 2.0 * std::sqrt(c1p * c2p) * std::sin(qDegreesToRadians(dh / 2.0));
+
+    const double lbp = (lab1[0] + lab2[0]) / 2.0;
+    const double cbp = (c1p + c2p) / 2.0;
+    double hbp = h1p + h2p;
+    if (c1p * c2p != 0.0) {
+        if (std::abs(h1p - h2p) <= 180.0) {
+            hbp /= 2.0;
+        }
+        else {
+            hbp = hbp < 360.0 ? (hbp + 360.0) / 2.0 : (hbp - 360.0) / 2.0;
+        }
+    }
+    const double t = 1.0 - 0.17 * std::cos(qDegreesToRadians(hbp - 30.0))
+                     + 0.24 * std::cos(qDegreesToRadians(2.0 * hbp))
+                     + 0.32 * std::cos(qDegreesToRadians(3.0 * hbp + 6.0))
+                     - 0.20 * std::cos(qDegreesToRadians(4.0 * hbp - 63.0));
+    const double theta = 30.0 * std::exp(-std::pow((hbp - 275.0) / 25.0, 2.0));
+    const double cbp7 = std::pow(cbp, 7.0);
+    const double rc = 2.0 * std::sqrt(cbp7 / (cbp7 + 6103515625.0));
+    const double l50 = (lbp - 50.0) * (lbp - 50.0);
+    const double sl = 1.0 + 0.015 * l50 / std::sqrt(20.0 + l50);
+    const double sc = 1.0 + 0.045 * cbp;
+    const double sh = 1.0 + 0.015 * cbp * t;
+    const double rt = -std::sin(qDegreesToRadians(2.0 * theta)) * rc;
+    const double l = dl / sl;
+    const double c = dc / sc;
+    const double h = dH / sh;
+    return std::sqrt(l * l + c * c + h * h + rt * c * h);
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+// cie colorimetry sampled on a wavelength grid. the observer is the wyman, sloan and shirley 2013 multi-lobe fit of
+// the cie 1931 2 degree functions, accurate to the tabulated data within plotting and search tolerances
+class Colorimetry {
+public:
+    // x, y and z functions one after the other, 3 x grid.size()
+    static QVector<double> observer(const QVector<double>& grid);
+    // e, a, d50, d55, d65 or d75, relative to 100 at 560 nm
+    static QVector<double> illuminant(const QString& name, const QVector<double>& grid, bool* ok = nullptr);
+    static QVector<double> daylight(double temperature, const QVector<double>& grid);
+    static QVector<double> blackbody(double temperature, const QVector<double>& grid);
+
+    // weights of spectral values to xyz under an illuminant with white at y = 100, 3 x grid.size()
+    static QVector<double> weights(const QVector<double>& illuminant, const QVector<double>& grid);
+    static void lab(const double xyz[3], const double white[3], double lab[3]);
+    static double deltaE2000(const double lab1[3], const double lab2[3]);
+};
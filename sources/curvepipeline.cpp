@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "curvepipeline.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+inline double
+applyStep(CurvePipeline::Operation operation, double value, const double* operand, double scale, int i)
+{
+    switch (operation) {
+    case CurvePipeline::Ratio:
+        return operand[i] != 0.0 ? value / operand[i] : std::numeric_limits<double>::quiet_NaN();
+    case CurvePipeline::Difference: return value - operand[i];
+    case CurvePipeline::Multiply: return value * operand[i];
+    case CurvePipeline::NormalizePeak:
+    case CurvePipeline::NormalizeAt: return value * scale;
+    }
+    return value;
+}
+}  // namespace
+
+CurvePipeline::CurvePipeline()
+    : session(nullptr)
+{}
+
+void
+CurvePipeline::setSession(const SessionMatrix* session)
+{
+    this->session = session;
+    invalidateAll();
+}
+
+void
+CurvePipeline::clear()
+{
+    curves.clear();
+}
+
+int
+CurvePipeline::add(const QString& name, const Source& input, const QList<Step>& steps)
+{
+    Curve curve;
+    curve.name = name;
+    curve.input = input;
+    curve.steps = steps;
+    curves.append(curve);
+    return curves.size() - 1;
+}
+
+const QVector<double>&
+CurvePipeline::result(int index)
+{
+    Curve& curve = curves[index];
+    if (curve.dirty) {
+        evaluate(curve);
+    }
+    return curve.values;
+}
+
+void
+CurvePipeline::invalidate(const Source& source)
+{
+    // derived curves only refer to earlier ones, one forward sweep reaches all transitive dependents
+    QVector<bool> changed(curves.size(), false);
+    for (int i = 0; i < curves.size(); ++i) {
+        bool dirty = dependsOn(curves[i], source);
+        for (int j = 0; j < i && !dirty; ++j) {
+            dirty = changed[j] && dependsOn(curves[i], { true, j });
+        }
+        if (dirty) {
+            curves[i].dirty = true;
+            changed[i] = true;
+        }
+    }
+}
+
+void
+CurvePipeline::invalidateAll()
+{
+    for (Curve& curve : curves) {
+        curve.dirty = true;
+    }
+}
+
+bool
+CurvePipeline::dependsOn(const Curve& curve, const Source& source) const
+{
+    auto same = [&](const Source& other) { return other.derived == source.derived && other.index == source.index; };
+    if (same(curve.input)) {
+        return true;
+    }
+    for (const Step& step : curve.steps) {
+        if ((step.operation == Ratio || step.operation == Difference || step.operation == Multiply) && same(step.operand)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const double*
+CurvePipeline::values(const Source& source, QVector<double>& buffer)
+{
+    if (source.derived) {
+        return source.index >= 0 && source.index < curves.size() ? result(source.index).constData() : nullptr;
+    }
+    if (source.index < 0 || source.index >= session->curveCount()) {
+        return nullptr;
+    }
+    if (session->precision() == SpecFile::Float64) {
+        return session->curve(source.index);
+    }
+    // derived curves are computed in double, float32 session curves are widened once per evaluation
+    buffer.resize(session->grid().size());
+    session->copyCurves(source.index, 1, buffer.data());
+    return buffer.constData();
+}
+
+void
+CurvePipeline::evaluate(Curve& curve)
+{
+    const int n = session ? session->grid().size() : 0;
+    curve.values.fill(std::numeric_limits<double>::quiet_NaN(), n);
+    curve.dirty = false;
+    QVector<double> inputBuffer;
+    const double* input = n ? values(curve.input, inputBuffer) : nullptr;
+    if (!input) {
+        return;
+    }
+    const int count = curve.steps.size();
+    QVector<const double*> operands(count, nullptr);
+    QVector<QVector<double>> buffers(count);
+    QVector<double> scales(count, 1.0);
+    for (int s = 0; s < count; ++s) {
+        const Step& step = curve.steps[s];
+        if (step.operation == Ratio || step.operation == Difference || step.operation == Multiply) {
+            operands[s] = values(step.operand, buffers[s]);
+            if (!operands[s]) {
+                return;
+            }
+        }
+    }
+    auto prefix = [&](int steps, int i) {
+        double value = input[i];
+        for (int s = 0; s < steps; ++s) {
+            value = applyStep(curve.steps[s].operation, value, operands[s], scales[s], i);
+        }
+        return value;
+    };
+    // normalizations need a scalar from the chain before them, everything else is element wise
+    for (int s = 0; s < count; ++s) {
+        double reference = 0.0;
+        if (curve.steps[s].operation == NormalizeAt) {
+            reference = prefix(s, session->gridIndex(curve.steps[s].wavelength));
+        }
+        else if (curve.steps[s].operation == NormalizePeak) {
+            for (int i = 0; i < n; ++i) {
+                double value = prefix(s, i);
+                if (std::isfinite(value) && std::abs(value) > std::abs(reference)) {
+                    reference = value;
+                }
+            }
+        }
+        else {
+            continue;
+        }
+        scales[s] = reference != 0.0 && std::isfinite(reference) ? 1.0 / reference : 1.0;
+    }
+    double* out = curve.values.data();
+    for (int i = 0; i < n; ++i) {
+        out[i] = prefix(count, i);
+    }
+}
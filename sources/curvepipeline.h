@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "sessionmatrix.h"
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// derived curves over session curves or other derived curves. results are evaluated lazily, all steps of a curve
+// are fused into one pass over the grid and changed inputs only mark their dependents dirty
+class CurvePipeline {
+public:
+    enum Operation { Ratio, Difference, Multiply, NormalizePeak, NormalizeAt };
+    struct Source {
+        bool derived = false;
+        int index = -1;
+    };
+    struct Step {
+        Operation operation;
+        Source operand;            // ratio, difference and multiply
+        double wavelength = 560.0;  // normalize at
+    };
+
+    CurvePipeline();
+    void setSession(const SessionMatrix* session);
+    void clear();
+
+    int add(const QString& name, const Source& input, const QList<Step>& steps);
+    int count() const { return curves.size(); }
+    QString name(int index) const { return curves[index].name; }
+    Source input(int index) const { return curves[index].input; }
+    QList<Step> steps(int index) const { return curves[index].steps; }
+    bool isDirty(int index) const { return curves[index].dirty; }
+    const QVector<double>& result(int index);
+
+    void invalidate(const Source& source);
+    void invalidateAll();
+
+private:
+    struct Curve {
+        QString name;
+        Source input;
+        QList<Step> steps;
+        QVector<double> values;
+        bool dirty = true;
+    };
+    bool dependsOn(const Curve& curve, const Source& source) const;
+    const double* values(const Source& source, QVector<double>& buffer);
+    void evaluate(Curve& curve);
+    const SessionMatrix* session;
+    QList<Curve> curves;
+};
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "datasetstore.h"
+#include "specio.h"
+
+#include <QDebug>
+
+DatasetStore::DatasetStore()
+    : limit(0)
+    , resident(0)
+    , clock(0)
+{}
+
+void
+DatasetStore::setBudget(qint64 bytes)
+{
+    limit = qMax<qint64>(0, bytes);
+}
+
+int
+DatasetStore::append(const SpecFile::Dataset& dataset, const QString& fileName)
+{
+    Entry entry;
+    entry.dataset = dataset;
+    entry.fileName = fileName;
+    store(entry, dataset.data);
+    entry.used = ++clock;
+    resident += entry.bytes;
+    entries.append(entry);
+    return entries.size() - 1;
+}
+
+int
+DatasetStore::appendMetadata(const SpecFile::Dataset& metadata, const QString& fileName)
+{
+    Entry entry;
+    entry.dataset = metadata;
+    entry.dataset.data.clear();
+    entry.fileName = fileName;
+    entry.used = ++clock;
+    entry.resident = false;
+    entry.pinned = false;
+    entries.append(entry);
+    return entries.size() - 1;
+}
+
+void
+DatasetStore::replace(int index, const SpecFile::Dataset& dataset)
+{
+    Entry& entry = entries[index];
+    if (entry.resident) {
+        resident -= entry.bytes;
+    }
+    entry.dataset = dataset;
+    store(entry, dataset.data);
+    entry.resident = true;
+    entry.used = ++clock;
+    resident += entry.bytes;
+}
+
+void
+DatasetStore::clear()
+{
+    entries.clear();
+    resident = 0;
+}
+
+int
+DatasetStore::indexOf(const QString& fileName) const
+{
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        if (entries[i].fileName == fileName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+SpecFile::Dataset
+DatasetStore::dataset(int index, bool* ok)
+{
+    Entry& entry = entries[index];
+    entry.used = ++clock;
+    if (ok) {
+        *ok = true;
+    }
+    if (!entry.resident) {
+        SpecIO spec(entry.fileName);
+        if (!spec.isLoaded() || spec.data().indices.size() != entry.dataset.indices.size()) {
+            qWarning() << "DatasetStore: could not reload dataset from:" << entry.fileName;
+            if (ok) {
+                *ok = false;
+            }
+            return entry.dataset;
+        }
+        store(entry, spec.data().data);
+        entry.resident = true;
+        resident += entry.bytes;
+    }
+    if (entry.samples.isEmpty()) {
+        return entry.dataset;
+    }
+    // writers and graphs work in double
+    SpecFile::Dataset dataset = entry.dataset;
+    const float* samples = entry.samples.constData();
+    for (int wavelength : entry.wavelengths) {
+        QVector<double> row(entry.stride);
+        for (int i = 0; i < entry.stride; ++i) {
+            row[i] = samples[i];
+        }
+        samples += entry.stride;
+        dataset.data.insert(dataset.data.cend(), wavelength, row);  // already sorted
+    }
+    return dataset;
+}
+
+void
+DatasetStore::setPinned(int index, bool pinned)
+{
+    entries[index].pinned = pinned;
+    entries[index].used = ++clock;
+}
+
+QVector<int>
+DatasetStore::trim()
+{
+    QVector<int> evicted;
+    while (limit > 0 && resident > limit) {
+        int oldest = -1;
+        for (int i = 0; i < entries.size(); ++i) {
+            const Entry& entry = entries[i];
+            // datasets without a file can not be read again
+            if (entry.resident && !entry.pinned && !entry.fileName.isEmpty() && entry.bytes > 0
+                && (oldest < 0 || entry.used < entries[oldest].used)) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) {
+            break;  // everything left is pinned
+        }
+        Entry& entry = entries[oldest];
+        entry.dataset.data.clear();
+        entry.wavelengths.clear();
+        entry.samples.clear();
+        entry.resident = false;
+        resident -= entry.bytes;
+        evicted.append(oldest);
+    }
+    return evicted;
+}
+
+void
+DatasetStore::store(Entry& entry, const QMap<int, QVector<double>>& data)
+{
+    // rows of different lengths stay in double, they are rare and only float32 datasets are narrowed
+    entry.wavelengths.clear();
+    entry.samples.clear();
+    entry.stride = data.isEmpty() ? 0 : data.first().size();
+    bool narrow = entry.dataset.precision == SpecFile::Float32 && entry.stride > 0;
+    for (auto it = data.constBegin(); it != data.constEnd() && narrow; ++it) {
+        narrow = it.value().size() == entry.stride;
+    }
+    if (!narrow) {
+        entry.dataset.data = data;
+        entry.bytes = bytes(entry.dataset);
+        return;
+    }
+    entry.dataset.data.clear();
+    entry.wavelengths.reserve(data.size());
+    entry.samples.reserve(data.size() * entry.stride);
+    for (auto it = data.constBegin(); it != data.constEnd(); ++it) {
+        entry.wavelengths.append(it.key());
+        for (double value : it.value()) {
+            entry.samples.append(float(value));
+        }
+    }
+    entry.bytes = qint64(entry.wavelengths.size()) * sizeof(int) + qint64(entry.samples.size()) * sizeof(float);
+}
+
+qint64
+DatasetStore::bytes(const SpecFile::Dataset& dataset)
+{
+    // map nodes and the per wavelength vectors
+    return qint64(dataset.data.size()) * (64 + dataset.indices.size() * sizeof(double));
+}
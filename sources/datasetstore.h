@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+#include <QString>
+#include <QVector>
+
+// loaded datasets with a memory budget for their samples. metadata is always resident, samples of datasets that
+// are not pinned can be evicted least recently used first and are read again from the file, or the binary cache,
+// when they are needed. samples of float32 datasets are kept as float and widened to double on access
+class DatasetStore {
+public:
+    DatasetStore();
+    qint64 budget() const { return limit; }
+    void setBudget(qint64 bytes);  // 0 for no limit
+
+    int count() const { return entries.size(); }
+    bool isEmpty() const { return entries.isEmpty(); }
+    int append(const SpecFile::Dataset& dataset, const QString& fileName);
+    // evicted and unpinned from the start, the samples are read when the dataset is first needed
+    int appendMetadata(const SpecFile::Dataset& metadata, const QString& fileName);
+    void replace(int index, const SpecFile::Dataset& dataset);
+    void clear();
+    int indexOf(const QString& fileName) const;  // last dataset loaded from the file
+    QString fileName(int index) const { return entries[index].fileName; }
+
+    // name, header, units and indices, the samples are empty when evicted or stored as float
+    const SpecFile::Dataset& metadata(int index) const { return entries[index].dataset; }
+    // samples are read again if they were evicted, ok is false when the file could not be read. the samples are
+    // then empty and the dataset stays evicted, so the next call tries again
+    SpecFile::Dataset dataset(int index, bool* ok = nullptr);
+    bool isResident(int index) const { return entries[index].resident; }
+    bool isPinned(int index) const { return entries[index].pinned; }
+    void setPinned(int index, bool pinned);
+
+    // evicts until the resident samples fit the budget, returns the evicted datasets
+    QVector<int> trim();
+    qint64 residentBytes() const { return resident; }
+    static qint64 bytes(const SpecFile::Dataset& dataset);
+
+private:
+    struct Entry {
+        SpecFile::Dataset dataset;
+        QVector<int> wavelengths;  // float32 samples, rows of stride values in wavelength order
+        QVector<float> samples;
+        int stride = 0;
+        QString fileName;
+        qint64 bytes = 0;
+        quint64 used = 0;
+        bool resident = true;
+        bool pinned = true;
+    };
+    static void store(Entry& entry, const QMap<int, QVector<double>>& data);
+    QVector<Entry> entries;
+    qint64 limit;
+    qint64 resident;
+    quint64 clock;
+};
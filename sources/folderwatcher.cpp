@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "folderwatcher.h"
+#include "specio.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
+
+class FolderWatcherPrivate : public QObject {
+    Q_OBJECT
+public:
+    FolderWatcherPrivate();
+    ~FolderWatcherPrivate();
+    void init();
+    void parsed(int scanGeneration, const QString& fileName, const SpecFile::Dataset& dataset);
+
+public Q_SLOTS:
+    void scan();
+
+public:
+    struct Stamp {
+        qint64 size;
+        qint64 modified;
+        bool operator==(const Stamp& other) const { return size == other.size && modified == other.modified; }
+    };
+    QString path;
+    QStringList filters;
+    QHash<QString, Stamp> stamps;  // files parsed or queued
+    QFileSystemWatcher watcher;
+    QTimer timer;
+    QThreadPool pool;
+    int generation;
+    QPointer<FolderWatcher> object;
+};
+
+FolderWatcherPrivate::FolderWatcherPrivate()
+    : generation(0)
+{
+    for (const QString& ext : SpecIO::availableExtensions()) {
+        filters.append("*." + ext);
+    }
+}
+
+FolderWatcherPrivate::~FolderWatcherPrivate()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+void
+FolderWatcherPrivate::init()
+{
+    // writers touch a file several times per measurement, changes are collected until the folder is quiet
+    timer.setSingleShot(true);
+    timer.setInterval(250);
+    pool.setMaxThreadCount(1);
+    connect(&timer, &QTimer::timeout, this, &FolderWatcherPrivate::scan);
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, &timer, qOverload<>(&QTimer::start));
+    connect(&watcher, &QFileSystemWatcher::fileChanged, &timer, qOverload<>(&QTimer::start));
+}
+
+void
+FolderWatcherPrivate::scan()
+{
+    if (path.isEmpty()) {
+        return;
+    }
+    const QFileInfoList entries = QDir(path).entryInfoList(filters, QDir::Files, QDir::Name);
+    QStringList watched = watcher.files();
+    for (const QFileInfo& info : entries) {
+        const QString fileName = info.absoluteFilePath();
+        const Stamp stamp = { info.size(), info.lastModified().toMSecsSinceEpoch() };
+        auto it = stamps.constFind(fileName);
+        if (it != stamps.constEnd() && it.value() == stamp) {
+            continue;
+        }
+        stamps.insert(fileName, stamp);
+        if (!watched.contains(fileName)) {
+            watcher.addPath(fileName);  // modifications of existing files are only reported per file
+        }
+        const int current = generation;
+        pool.start([this, fileName, current]() {
+            SpecIO spec(fileName);
+            SpecFile::Dataset dataset = spec.data();
+            QMetaObject::invokeMethod(
+                this, [this, current, fileName, dataset]() { parsed(current, fileName, dataset); },
+                Qt::QueuedConnection);
+        });
+    }
+}
+
+void
+FolderWatcherPrivate::parsed(int scanGeneration, const QString& fileName, const SpecFile::Dataset& dataset)
+{
+    if (scanGeneration != generation) {
+        return;  // the path changed while the file was parsed
+    }
+    if (!dataset.loaded) {
+        stamps.remove(fileName);  // most likely still being written, retried on the next change
+        return;
+    }
+    Q_EMIT object->datasetChanged(fileName, dataset);
+}
+
+#include "folderwatcher.moc"
+
+FolderWatcher::FolderWatcher(QObject* parent)
+    : QObject(parent)
+    , p(new FolderWatcherPrivate())
+{
+    p->object = this;
+    p->init();
+}
+
+FolderWatcher::~FolderWatcher() {}
+
+QString
+FolderWatcher::path() const
+{
+    return p->path;
+}
+
+int
+FolderWatcher::debounce() const
+{
+    return p->timer.interval();
+}
+
+void
+FolderWatcher::setPath(const QString& path)
+{
+    if (!p->watcher.directories().isEmpty()) {
+        p->watcher.removePaths(p->watcher.directories());
+    }
+    if (!p->watcher.files().isEmpty()) {
+        p->watcher.removePaths(p->watcher.files());
+    }
+    p->timer.stop();
+    p->stamps.clear();
+    p->generation++;
+    p->path = path.isEmpty() ? QString() : QDir(path).absolutePath();
+    if (!p->path.isEmpty()) {
+        p->watcher.addPath(p->path);
+        p->scan();
+    }
+}
+
+void
+FolderWatcher::setDebounce(int msecs)
+{
+    p->timer.setInterval(msecs);
+}
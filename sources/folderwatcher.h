@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+#include <QObject>
+#include <QScopedPointer>
+
+// watches a folder for new and modified spectral files. change notifications are debounced, only files with a new
+// size or modification time are parsed, one at a time on a worker thread, and reported back on the owning thread
+class FolderWatcherPrivate;
+class FolderWatcher : public QObject {
+    Q_OBJECT
+public:
+    FolderWatcher(QObject* parent = nullptr);
+    virtual ~FolderWatcher();
+    QString path() const;
+    int debounce() const;
+
+public Q_SLOTS:
+    void setPath(const QString& path);
+    void setDebounce(int msecs);
+
+Q_SIGNALS:
+    void datasetChanged(const QString& fileName, const SpecFile::Dataset& dataset);
+
+private:
+    QScopedPointer<FolderWatcherPrivate> p;
+};
@@ -3,6 +3,7 @@
 // https://github.com/mikaelsundell/specviz
 
 #include "icctransform.h"
+#include "instrumentation.h"
 #include <QApplication>
 #include <QColorSpace>
 #include <QMap>
@@ -29,9 +30,16 @@ public:
     QString outputProfile;
     QMap<QString, QMap<QImage::Format, QMap<QString, cmsHTRANSFORM>>> cache;
     QPointer<ICCTransform> transform;
+    Instrumentation::Counter* hits;
+    Instrumentation::Counter* misses;
+    Instrumentation::Histogram* images;
 };
 
-ICCTransformPrivate::ICCTransformPrivate() {}
+ICCTransformPrivate::ICCTransformPrivate()
+    : hits(Instrumentation::instance()->counter("icc.cache.hits"))
+    , misses(Instrumentation::instance()->counter("icc.cache.misses"))
+    , images(Instrumentation::instance()->histogram("icc.map.image"))
+{}
 
 ICCTransformPrivate::~ICCTransformPrivate()
 {
@@ -80,7 +88,11 @@ ICCTransformPrivate::mapTransform(const QString& profile, const QString& outProf
     if (!cache[profile].contains(format)) {
         cache[profile].insert(format, QMap<QString, cmsHTRANSFORM>());
     }
-    if (!cache[profile][format].contains(outProfile)) {
+    if (cache[profile][format].contains(outProfile)) {
+        hits->add();
+    }
+    else {
+        misses->add();
         cmsHPROFILE cmsProfile = cmsOpenProfileFromFile(profile.toLocal8Bit().constData(), "r");
         cmsHPROFILE cmsDisplayProfile = cmsOpenProfileFromFile(outProfile.toLocal8Bit().constData(), "r");
         int flags = (format == QImage::Format_ARGB32_Premultiplied ? cmsFLAGS_COPY_ALPHA : 0);
@@ -103,7 +115,11 @@ ICCTransformPrivate::mapTransform(const QColorSpace& colorSpace, const QString&
     if (!cache[profile].contains(format)) {
         cache[profile].insert(format, QMap<QString, cmsHTRANSFORM>());
     }
-    if (!cache[profile][format].contains(outProfile)) {
+    if (cache[profile][format].contains(outProfile)) {
+        hits->add();
+    }
+    else {
+        misses->add();
         cmsHPROFILE cmsProfile = cmsOpenProfileFromMem(data.constData(), static_cast<cmsUInt32Number>(data.size()));
         cmsHPROFILE cmsDisplayProfile = cmsOpenProfileFromFile(outProfile.toLocal8Bit().constData(), "r");
         int flags = (format == QImage::Format_ARGB32_Premultiplied ? cmsFLAGS_COPY_ALPHA : 0);
@@ -118,6 +134,7 @@ ICCTransformPrivate::mapTransform(const QColorSpace& colorSpace, const QString&
 QImage
 ICCTransformPrivate::mapImage(QImage image, cmsHTRANSFORM transform)
 {
+    Instrumentation::Timer timer(images);
     QImage mapped(image.width(), image.height(), image.format());
     cmsDoTransformLineStride(transform, image.constBits(), mapped.bits(), image.width(), image.height(),
                              static_cast<cmsUInt32Number>(image.bytesPerLine()),
@@ -129,6 +146,9 @@ ICCTransformPrivate::mapImage(QImage image, cmsHTRANSFORM transform)
 QRgb
 ICCTransformPrivate::map(QRgb color, const QString& profile, const QString& outProfile)
 {
+    if (profile == outProfile) {
+        return color;  // unmanaged displays fall back to the input profile, no transform is needed
+    }
     cmsHTRANSFORM transform = mapTransform(profile, outProfile, QImage::Format_RGB32);
     QRgb transformColor;
     cmsDoTransform(transform, &color, &transformColor, 1);
@@ -138,6 +158,9 @@ ICCTransformPrivate::map(QRgb color, const QString& profile, const QString& outP
 QImage
 ICCTransformPrivate::map(QImage image, const QString& profile, const QString& outProfile)
 {
+    if (profile == outProfile) {
+        return image;
+    }
     cmsHTRANSFORM transform = mapTransform(profile, outProfile, image.format());
     return mapImage(image, transform);
 }
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "instrumentation.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <map>
+#include <memory>
+
+QScopedPointer<Instrumentation, Instrumentation::Deleter> Instrumentation::pi;
+
+class InstrumentationPrivate {
+public:
+    mutable QMutex mutex;  // guards the maps, never the metrics
+    std::map<QString, std::unique_ptr<Instrumentation::Counter>> counters;
+    std::map<QString, std::unique_ptr<Instrumentation::Histogram>> histograms;
+};
+
+void
+Instrumentation::Histogram::record(qint64 nsecs)
+{
+    nsecs = qMax<qint64>(0, nsecs);
+    const quint64 usecs = quint64(nsecs / 1000);
+    int bucket = 0;
+    while (bucket < bucketCount - 1 && (quint64(2) << bucket) <= usecs) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nsecs, std::memory_order_relaxed);
+    qint64 current = maximum.load(std::memory_order_relaxed);
+    while (current < nsecs && !maximum.compare_exchange_weak(current, nsecs, std::memory_order_relaxed)) {}
+}
+
+qint64
+Instrumentation::Histogram::percentile(double fraction) const
+{
+    const qint64 total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const qint64 rank = qMax<qint64>(1, qint64(fraction * total + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return qMin((qint64(2) << i) * 1000, max());
+        }
+    }
+    return max();
+}
+
+Instrumentation::Instrumentation()
+    : p(new InstrumentationPrivate())
+{}
+
+Instrumentation::~Instrumentation() {}
+
+Instrumentation*
+Instrumentation::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!pi) {
+        pi.reset(new Instrumentation());
+    }
+    return pi.data();
+}
+
+Instrumentation::Counter*
+Instrumentation::counter(const QString& name)
+{
+    QMutexLocker locker(&p->mutex);
+    std::unique_ptr<Counter>& counter = p->counters[name];
+    if (!counter) {
+        counter.reset(new Counter());
+    }
+    return counter.get();
+}
+
+Instrumentation::Histogram*
+Instrumentation::histogram(const QString& name)
+{
+    QMutexLocker locker(&p->mutex);
+    std::unique_ptr<Histogram>& histogram = p->histograms[name];
+    if (!histogram) {
+        histogram.reset(new Histogram());
+    }
+    return histogram.get();
+}
+
+QStringList
+Instrumentation::counters() const
+{
+    QMutexLocker locker(&p->mutex);
+    QStringList names;
+    for (const auto& counter : p->counters) {
+        names.append(counter.first);
+    }
+    return names;
+}
+
+QStringList
+Instrumentation::histograms() const
+{
+    QMutexLocker locker(&p->mutex);
+    QStringList names;
+    for (const auto& histogram : p->histograms) {
+        names.append(histogram.first);
+    }
+    return names;
+}
+
+QJsonObject
+Instrumentation::report() const
+{
+    QMutexLocker locker(&p->mutex);
+    QJsonObject counters;
+    for (const auto& counter : p->counters) {
+        counters.insert(counter.first, counter.second->value());
+    }
+    QJsonObject histograms;
+    for (const auto& entry : p->histograms) {
+        const Histogram* histogram = entry.second.get();
+        const qint64 count = histogram->count();
+        QJsonObject object;
+        object.insert("count", count);
+        object.insert("total_ms", histogram->total() / 1e6);
+        object.insert("mean_ms", count > 0 ? histogram->total() / 1e6 / count : 0.0);
+        object.insert("p50_ms", histogram->percentile(0.5) / 1e6);
+        object.insert("p95_ms", histogram->percentile(0.95) / 1e6);
+        object.insert("max_ms", histogram->max() / 1e6);
+        histograms.insert(entry.first, object);
+    }
+    QJsonObject report;
+    report.insert("application", QCoreApplication::applicationName());
+    report.insert("version", QCoreApplication::applicationVersion());
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("counters", counters);
+    report.insert("histograms", histograms);
+    return report;
+}
+
+bool
+Instrumentation::writeReport(const QString& fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Instrumentation: could not write report:" << fileName;
+        return false;
+    }
+    file.write(QJsonDocument(report()).toJson());
+    return file.commit();
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <atomic>
+
+// named counters and timing histograms. metrics are created once under a lock and live as long as the process,
+// call sites keep the returned pointer, e.g in a function local static, and update it without locking
+class InstrumentationPrivate;
+class Instrumentation {
+public:
+    class Counter {
+    public:
+        void add(qint64 value = 1) { count.fetch_add(value, std::memory_order_relaxed); }
+        void set(qint64 value) { count.store(value, std::memory_order_relaxed); }
+        qint64 value() const { return count.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> count { 0 };
+    };
+
+    // durations in power of two buckets of microseconds, percentiles are the upper bound of their bucket
+    class Histogram {
+    public:
+        static const int bucketCount = 32;
+        void record(qint64 nsecs);
+        qint64 count() const { return samples.load(std::memory_order_relaxed); }
+        qint64 total() const { return sum.load(std::memory_order_relaxed); }
+        qint64 max() const { return maximum.load(std::memory_order_relaxed); }
+        qint64 percentile(double fraction) const;
+
+    private:
+        std::atomic<qint64> samples { 0 };
+        std::atomic<qint64> sum { 0 };
+        std::atomic<qint64> maximum { 0 };
+        std::atomic<qint64> buckets[bucketCount] = {};
+    };
+
+    class Timer {
+    public:
+        Timer(Histogram* histogram)
+            : histogram(histogram)
+        {
+            timer.start();
+        }
+        ~Timer() { histogram->record(timer.nsecsElapsed()); }
+
+    private:
+        Histogram* histogram;
+        QElapsedTimer timer;
+    };
+
+    static Instrumentation* instance();
+    Counter* counter(const QString& name);
+    Histogram* histogram(const QString& name);
+    QStringList counters() const;
+    QStringList histograms() const;
+
+    QJsonObject report() const;
+    bool writeReport(const QString& fileName) const;
+
+private:
+    Instrumentation();
+    ~Instrumentation();
+    Instrumentation(const Instrumentation&) = delete;
+    Instrumentation& operator=(const Instrumentation&) = delete;
+    class Deleter {
+    public:
+        static void cleanup(Instrumentation* pointer) { delete pointer; }
+    };
+    static QScopedPointer<Instrumentation, Deleter> pi;
+    QScopedPointer<InstrumentationPrivate> p;
+};
@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "libraryindex.h"
+#include "parallel.h"
+#include "specio.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiHash>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+const quint32 indexMagic = 0x53564c49;  // SVLI
+const quint32 indexVersion = 1;
+
+enum Status { Unchanged, Added, Updated, Moved, Failed };
+
+QDataStream&
+operator<<(QDataStream& stream, const LibraryIndex::Record& record)
+{
+    stream << record.fileName << record.size << record.modified << record.fingerprint << record.valid << record.name
+           << record.units << record.indices << record.header << qint32(record.start) << qint32(record.end)
+           << qint32(record.samples);
+    return stream;
+}
+
+QDataStream&
+operator>>(QDataStream& stream, LibraryIndex::Record& record)
+{
+    qint32 start, end, samples;
+    stream >> record.fileName >> record.size >> record.modified >> record.fingerprint >> record.valid >> record.name
+        >> record.units >> record.indices >> record.header >> start >> end >> samples;
+    record.start = start;
+    record.end = end;
+    record.samples = samples;
+    return stream;
+}
+
+void
+describe(LibraryIndex::Record& record, const SpecFile::Dataset& dataset)
+{
+    record.valid = true;
+    record.name = dataset.name;
+    record.units = dataset.units;
+    record.indices = dataset.indices;
+    record.header = dataset.header;
+    record.start = dataset.data.isEmpty() ? 0 : dataset.data.firstKey();
+    record.end = dataset.data.isEmpty() ? 0 : dataset.data.lastKey();
+    record.samples = dataset.data.size();
+}
+}  // namespace
+
+LibraryIndex::LibraryIndex() {}
+
+QString
+LibraryIndex::defaultFileName(const QString& root)
+{
+    // next to the files when possible so that everyone browsing a shared disk benefits from the same index
+    QFileInfo info(root);
+    if (info.isDir() && info.isWritable()) {
+        return QDir(root).filePath(".specvizlibrary");
+    }
+    QByteArray key = QDir::cleanPath(info.absoluteFilePath()).toUtf8();
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation))
+        .filePath(QString("specviz/libraries/%1.index").arg(hash));
+}
+
+bool
+LibraryIndex::load(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic, version;
+    stream >> magic >> version;
+    if (magic != indexMagic || version != indexVersion) {
+        qWarning() << "LibraryIndex: unsupported index file, a full rescan is needed:" << fileName;
+        return false;
+    }
+    QString root;
+    qint32 count;
+    stream >> root >> count;
+    QList<Record> loaded;
+    loaded.reserve(qMax(0, count));
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Record record;
+        stream >> record;
+        loaded.append(record);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "LibraryIndex: could not read index file:" << fileName;
+        return false;
+    }
+    rootPath = root;
+    records = loaded;
+    updateFields();
+    return true;
+}
+
+bool
+LibraryIndex::save(const QString& fileName) const
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "LibraryIndex: could not write index file:" << fileName;
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << indexMagic << indexVersion << rootPath << qint32(records.size());
+    for (const Record& record : records) {
+        stream << record;
+    }
+    return file.commit();
+}
+
+LibraryIndex::Scan
+LibraryIndex::rescan(const QString& root)
+{
+    Scan scan;
+    QDir dir(root);
+    QString path = QDir::cleanPath(dir.absolutePath());
+    if (path != rootPath) {
+        records.clear();
+        rootPath = path;
+    }
+    QHash<QString, int> existing;
+    for (int i = 0; i < records.size(); ++i) {
+        existing.insert(records[i].fileName, i);
+    }
+
+    // stat only, unchanged files keep their record
+    QStringList filters;
+    for (const QString& ext : SpecIO::availableExtensions()) {
+        filters.append("*." + ext);
+    }
+    QList<Record> scanned;
+    QVector<int> pending;
+    QSet<int> seen;
+    QDirIterator it(rootPath, filters, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        Record current;
+        current.fileName = dir.relativeFilePath(info.filePath());
+        current.size = info.size();
+        current.modified = info.lastModified().toMSecsSinceEpoch();
+        auto found = existing.constFind(current.fileName);
+        if (found != existing.constEnd()) {
+            seen.insert(found.value());
+            const Record& previous = records[found.value()];
+            if (previous.size == current.size && previous.modified == current.modified) {
+                scanned.append(previous);
+                ++scan.unchanged;
+                continue;
+            }
+        }
+        pending.append(scanned.size());
+        scanned.append(current);
+    }
+
+    // records that were not seen are removed, or moved if a new file has the same size and fingerprint
+    QMultiHash<qint64, int> removed;
+    for (int i = 0; i < records.size(); ++i) {
+        if (!seen.contains(i)) {
+            removed.insert(records[i].size, i);
+        }
+    }
+    QVector<int> status(pending.size(), Unchanged);
+    QVector<int> sources(pending.size(), -1);
+    Record* updates = scanned.data();
+    int* states = status.data();
+    int* origins = sources.data();
+    parallel::forEachBlock(pending.size(), parallel::grainSize(pending.size(), 4), [&](int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+            Record& record = updates[pending[p]];
+            QString fileName = dir.filePath(record.fileName);
+            QFile file(fileName);
+            if (file.open(QIODevice::ReadOnly)) {
+                QCryptographicHash hash(QCryptographicHash::Sha1);
+                hash.addData(&file);
+                record.fingerprint = hash.result();
+            }
+            const bool known = existing.contains(record.fileName);
+            const QList<int> candidates = known ? QList<int>() : removed.values(record.size);
+            for (int candidate : candidates) {
+                const Record& previous = records[candidate];
+                if (!record.fingerprint.isEmpty() && previous.fingerprint == record.fingerprint) {
+                    Record moved = previous;
+                    moved.fileName = record.fileName;
+                    moved.modified = record.modified;
+                    record = moved;
+                    states[p] = Moved;
+                    origins[p] = candidate;
+                    break;
+                }
+            }
+            if (states[p] == Moved) {
+                continue;
+            }
+            SpecIO spec(fileName);
+            if (spec.isLoaded()) {
+                describe(record, spec.data());
+                states[p] = known ? Updated : Added;
+            }
+            else {
+                record.valid = false;  // kept so that unchanged broken files are not parsed again
+                states[p] = Failed;
+            }
+        }
+    });
+
+    QSet<int> matched;
+    for (int p = 0; p < pending.size(); ++p) {
+        switch (status[p]) {
+        case Added: ++scan.added; break;
+        case Updated: ++scan.updated; break;
+        case Moved:
+            ++scan.moved;
+            matched.insert(sources[p]);
+            break;
+        case Failed: ++scan.failed; break;
+        default: break;
+        }
+    }
+    scan.removed = removed.size() - matched.size();
+    std::sort(scanned.begin(), scanned.end(),
+              [](const Record& a, const Record& b) { return a.fileName < b.fileName; });
+    records = scanned;
+    updateFields();
+    return scan;
+}
+
+QString
+LibraryIndex::filePath(int index) const
+{
+    return QDir(rootPath).filePath(records[index].fileName);
+}
+
+QVector<int>
+LibraryIndex::filter(const Filter& filter) const
+{
+    QList<QPair<QString, QString>> terms;
+    for (auto it = filter.header.constBegin(); it != filter.header.constEnd(); ++it) {
+        if (!it.value().isEmpty()) {
+            terms.append({ it.key().toLower(), it.value().toLower() });
+        }
+    }
+    QVector<int> matches;
+    for (int i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        if ((filter.start > 0 || filter.end > 0) && !record.valid) {
+            continue;
+        }
+        if ((filter.start > 0 && record.start > filter.start) || (filter.end > 0 && record.end < filter.end)) {
+            continue;
+        }
+        bool match = true;
+        for (const auto& term : terms) {
+            auto value = fields[i].constFind(term.first);
+            if (value == fields[i].constEnd() || !value->contains(term.second)) {
+                match = false;
+                break;
+            }
+        }
+        if (match && !filter.text.isEmpty()) {
+            match = record.name.contains(filter.text, Qt::CaseInsensitive)
+                    || record.fileName.contains(filter.text, Qt::CaseInsensitive);
+        }
+        if (match) {
+            matches.append(i);
+        }
+    }
+    return matches;
+}
+
+QStringList
+LibraryIndex::values(const QString& key) const
+{
+    QSet<QString> values;
+    for (const Record& record : records) {
+        for (auto it = record.header.constBegin(); it != record.header.constEnd(); ++it) {
+            if (it.key().compare(key, Qt::CaseInsensitive) == 0) {
+                values.insert(it.value().toString());
+            }
+        }
+    }
+    QStringList sorted(values.constBegin(), values.constEnd());
+    sorted.sort(Qt::CaseInsensitive);
+    return sorted;
+}
+
+void
+LibraryIndex::updateFields()
+{
+    fields.resize(records.size());
+    for (int i = 0; i < records.size(); ++i) {
+        fields[i].clear();
+        const QVariantMap& header = records[i].header;
+        for (auto it = header.constBegin(); it != header.constEnd(); ++it) {
+            fields[i].insert(it.key().toLower(), it.value().toString().toLower());
+        }
+    }
+}
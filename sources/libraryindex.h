@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+// metadata of every spectral file below a root directory, kept in one self-contained index file. rescans compare
+// modification times and sizes and only parse new or changed files, moved files are recognized by fingerprint
+class LibraryIndex {
+public:
+    struct Record {
+        QString fileName;  // relative to the root
+        qint64 size = 0;
+        qint64 modified = 0;  // ms since epoch
+        QByteArray fingerprint;
+        bool valid = false;  // false if the file could not be parsed
+        QString name;
+        QString units;
+        QStringList indices;
+        QVariantMap header;
+        int start = 0;  // wavelength range in nm
+        int end = 0;
+        int samples = 0;
+    };
+    struct Filter {
+        QMap<QString, QString> header;  // key to value substring, compared without case
+        QString text;                   // substring of the name or file name
+        int start = 0;                  // wavelengths the dataset has to cover, unset when zero
+        int end = 0;
+    };
+    struct Scan {
+        int added = 0;
+        int updated = 0;
+        int moved = 0;
+        int removed = 0;
+        int unchanged = 0;
+        int failed = 0;
+    };
+
+    LibraryIndex();
+    static QString defaultFileName(const QString& root);
+
+    bool load(const QString& fileName);
+    bool save(const QString& fileName) const;
+    Scan rescan(const QString& root);
+
+    QString root() const { return rootPath; }
+    int count() const { return records.size(); }
+    const Record& record(int index) const { return records[index]; }
+    QString filePath(int index) const;
+
+    QVector<int> filter(const Filter& filter) const;
+    QStringList values(const QString& key) const;
+
+private:
+    void updateFields();
+    QString rootPath;
+    QList<Record> records;
+    QVector<QHash<QString, QString>> fields;  // lower case header per record for filtering
+};
@@ -3,14 +3,31 @@
 // https://github.com/mikaelsundell/specviz
 
 #include "specviz.h"
+#include "instrumentation.h"
+#include "startuptrace.h"
 #include <QApplication>
 
 int
 main(int argc, char* argv[])
 {
     QApplication app(argc, argv);
+    const QStringList arguments = QCoreApplication::arguments();
+    StartupTrace::setEnabled(arguments.contains("--trace-startup"));
+    int budget = arguments.indexOf("--startup-budget");
+    if (budget >= 0 && budget + 1 < arguments.size()) {
+        StartupTrace::setBudget(arguments[budget + 1].toInt());
+    }
+    StartupTrace::mark("application");
     Specviz specviz;
-    specviz.setArguments(QCoreApplication::arguments());
+    StartupTrace::mark("window");
+    specviz.setArguments(arguments);
+    StartupTrace::watchFirstFrame(&specviz);
     specviz.show();
-    return app.exec();
+    StartupTrace::mark("show");
+    int result = app.exec();
+    int report = arguments.indexOf("--perf-report");
+    if (report >= 0 && report + 1 < arguments.size()) {
+        Instrumentation::instance()->writeReport(arguments[report + 1]);
+    }
+    return result;
 }
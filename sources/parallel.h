@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+namespace parallel {
+// a few blocks per thread evens out the load without making blocks too small
+inline int
+grainSize(int count, int minimum)
+{
+    return qMax(minimum, count / qMax(1, QThread::idealThreadCount() * 4) + 1);
+}
+
+// calls function(begin, end) for blocks of grain over [0, count) on the global pool, the calling thread takes the
+// last block while it waits
+template<typename Function>
+void
+forEachBlock(int count, int grain, Function function)
+{
+    const int blocks = (count + grain - 1) / grain;
+    if (blocks <= 0) {
+        return;
+    }
+    QSemaphore done;
+    for (int b = 0; b < blocks - 1; ++b) {
+        QThreadPool::globalInstance()->start([&function, &done, b, grain, count]() {
+            function(b * grain, qMin(count, (b + 1) * grain));
+            done.release();
+        });
+    }
+    function((blocks - 1) * grain, count);
+    done.acquire(blocks - 1);
+}
+}  // namespace parallel
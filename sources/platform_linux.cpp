@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "platform.h"
+
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QScreen>
+#include <QStandardPaths>
+#include <cstdio>
+
+#if defined(SPECVIZ_HAVE_XCB) && QT_CONFIG(xcb)
+#    include <QGuiApplication>
+#    include <xcb/xcb.h>
+#endif
+
+namespace platform {
+namespace utils {
+    struct IccProfileData {
+        int screenNumber;
+        QString profilePath;
+        QByteArray profile;  // set when the profile came from the display server
+        IccProfileData()
+            : screenNumber(0)
+            , profilePath()
+        {}
+    };
+    QMap<QString, IccProfileData> iccCache;  // screen name to profile, screens are resolved once
+
+    QScreen* toScreen(WId wid)
+    {
+        QWidget* widget = QWidget::find(wid);
+        QScreen* screen = widget ? widget->screen() : nullptr;
+        return screen ? screen : QGuiApplication::primaryScreen();
+    }
+
+    QByteArray grabX11Profile(int screenNumber)
+    {
+        QByteArray profile;
+#if defined(SPECVIZ_HAVE_XCB) && QT_CONFIG(xcb)
+        // icc profiles in x specification, _ICC_PROFILE for the first screen and _ICC_PROFILE_n for the others
+        if (QGuiApplication::platformName() != "xcb") {
+            return profile;
+        }
+        auto* x11 = qGuiApp->nativeInterface<QNativeInterface::QX11Application>();
+        xcb_connection_t* connection = x11 ? x11->connection() : nullptr;
+        if (!connection) {
+            return profile;
+        }
+        QByteArray name = screenNumber > 0 ? QByteArray("_ICC_PROFILE_") + QByteArray::number(screenNumber)
+                                           : QByteArray("_ICC_PROFILE");
+        xcb_intern_atom_reply_t* atom = xcb_intern_atom_reply(
+            connection, xcb_intern_atom(connection, 1, name.size(), name.constData()), nullptr);
+        if (!atom) {
+            return profile;
+        }
+        if (atom->atom != XCB_ATOM_NONE) {
+            xcb_window_t root = xcb_setup_roots_iterator(xcb_get_setup(connection)).data->root;
+            xcb_get_property_reply_t* property = xcb_get_property_reply(
+                connection, xcb_get_property(connection, 0, root, atom->atom, XCB_ATOM_CARDINAL, 0, UINT32_MAX / 4),
+                nullptr);
+            if (property) {
+                int length = xcb_get_property_value_length(property);
+                if (property->format == 8 && length > 0) {
+                    profile = QByteArray(static_cast<const char*>(xcb_get_property_value(property)), length);
+                }
+                free(property);
+            }
+        }
+        free(atom);
+#else
+        Q_UNUSED(screenNumber);
+#endif
+        return profile;
+    }
+
+    QString storeProfile(const QByteArray& profile)
+    {
+        // the transform opens profiles by path, identical profiles share one file across runs
+        QString hash = QString::fromLatin1(QCryptographicHash::hash(profile, QCryptographicHash::Sha1).toHex());
+        QDir dir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/specviz/icc");
+        QString path = dir.filePath(hash + ".icc");
+        if (QFileInfo(path).size() == profile.size()) {
+            return path;
+        }
+        dir.mkpath(".");
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(profile) != profile.size() || !file.commit()) {
+            qWarning() << "platform: could not write display profile to:" << path;
+            return QString();
+        }
+        return path;
+    }
+
+    QString configProfile(const QString& screenName)
+    {
+        // user provided profiles, per output first, e.g ~/.config/specviz/display-HDMI-1.icc
+        QStringList names;
+        if (!screenName.isEmpty()) {
+            names.append(QString("specviz/display-%1.icc").arg(screenName));
+        }
+        names.append("specviz/display.icc");
+        for (const QString& name : names) {
+            QString path = QStandardPaths::locate(QStandardPaths::GenericConfigLocation, name);
+            if (!path.isEmpty()) {
+                return path;
+            }
+        }
+        return QString();
+    }
+
+    IccProfileData grabDisplayProfile(QScreen* screen)
+    {
+        QString screenName = screen ? screen->name() : QString();
+        auto it = iccCache.constFind(screenName);
+        if (it != iccCache.constEnd()) {
+            return it.value();
+        }
+        IccProfileData iccProfile;
+        iccProfile.screenNumber = qMax(0, QGuiApplication::screens().indexOf(screen));
+        iccProfile.profile = grabX11Profile(iccProfile.screenNumber);
+        if (!iccProfile.profile.isEmpty()) {
+            iccProfile.profilePath = storeProfile(iccProfile.profile);
+        }
+        if (iccProfile.profilePath.isEmpty()) {
+            iccProfile.profilePath = configProfile(screenName);
+        }
+        if (iccProfile.profilePath.isEmpty()) {
+            iccProfile.profilePath = getApplicationPath() + "/Resources/sRGB2014.icc";  // unmanaged display
+        }
+        iccCache.insert(screenName, iccProfile);
+        return iccProfile;
+    }
+}  // namespace utils
+
+void
+setDarkTheme()
+{}  // dark theme is carried by the stylesheet
+
+IccProfile
+getIccProfile(WId wid)
+{
+    QScreen* screen = utils::toScreen(wid);
+    QString path = qEnvironmentVariable("SPECVIZ_ICC_PROFILE");
+    if (!path.isEmpty()) {
+        return IccProfile { qMax(0, QGuiApplication::screens().indexOf(screen)), path };
+    }
+    utils::IccProfileData iccData = utils::grabDisplayProfile(screen);
+    return IccProfile { iccData.screenNumber, iccData.profilePath };
+}
+
+QString
+getIccProfileUrl(WId wid)
+{
+    return getIccProfile(wid).displayProfileUrl;
+}
+
+QString
+getApplicationPath()
+{
+    // build trees keep resources next to the binary, installs below share
+    QString path = QApplication::applicationDirPath();
+    if (!QDir(path + "/Resources").exists() && QDir(path + "/../share/specviz/Resources").exists()) {
+        return QDir::cleanPath(path + "/../share/specviz");
+    }
+    return path;
+}
+
+QString
+restoreScopedPath(const QString& path)
+{
+    return path;  // ignore on linux
+}
+
+QString
+persistScopedPath(const QString& path)
+{
+    return path;  // ignore on linux
+}
+
+void
+console(const QString& message)
+{
+    std::fprintf(stderr, "specviz: %s\n", message.toLocal8Bit().constData());
+}
+
+}  // namespace platform
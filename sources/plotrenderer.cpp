@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "plotrenderer.h"
+#include "qcustomplot/qcustomplot.h"
+#include "vectorexport.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QPointer>
+
+class PlotRendererPrivate : public QObject {
+    Q_OBJECT
+public:
+    PlotRendererPrivate();
+    void init();
+    void setup(const SpecFile::Dataset& dataset);
+    bool renderImage(const QString& fileName);
+    bool renderVector(const QString& fileName, const QString& title);
+    struct Data {
+        QSize size;
+        double scale;
+        QVector<double> keys;
+        QVector<double> values;
+        QScopedPointer<QCustomPlot> plot;
+        QPointer<QCPItemRect> gradientRect;
+    };
+    Data d;
+};
+
+PlotRendererPrivate::PlotRendererPrivate()
+{
+    d.size = QSize(800, 500);
+    d.scale = 1.0;
+}
+
+void
+PlotRendererPrivate::init()
+{
+    // the plot is never shown, graphs, legend items and the gradient are reused between renders
+    d.plot.reset(new QCustomPlot());
+    d.plot->setPlottingHint(QCP::phRasterPolylines, true);
+    d.plot->xAxis->setLabel("wavelength (nm)");
+
+    QFont labelFont = d.plot->xAxis->labelFont();
+    labelFont.setPointSize(11);
+    d.plot->xAxis->setLabelFont(labelFont);
+    d.plot->yAxis->setLabelFont(labelFont);
+    QFont legendFont = d.plot->legend->font();
+    legendFont.setPointSize(11);
+    d.plot->legend->setFont(legendFont);
+    d.plot->legend->setVisible(true);
+
+    d.gradientRect = new QCPItemRect(d.plot.data());
+    d.gradientRect->topLeft->setType(QCPItemPosition::ptPlotCoords);
+    d.gradientRect->bottomRight->setType(QCPItemPosition::ptPlotCoords);
+    d.gradientRect->setBrush(QBrush(PlotRenderer::spectrumGradient()));
+    d.gradientRect->setPen(Qt::NoPen);
+}
+
+void
+PlotRendererPrivate::setup(const SpecFile::Dataset& dataset)
+{
+    QCustomPlot* plot = d.plot.data();
+    const int count = dataset.indices.size();
+    while (plot->graphCount() > count) {
+        plot->removeGraph(plot->graphCount() - 1);
+    }
+    while (plot->graphCount() < count) {
+        plot->addGraph();
+    }
+
+    d.keys.resize(dataset.data.size());
+    int k = 0;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it) {
+        d.keys[k++] = it.key();
+    }
+    d.values.resize(d.keys.size());
+    for (int i = 0; i < count; ++i) {
+        QCPGraph* graph = plot->graph(i);
+        graph->setName(dataset.indices[i]);
+        graph->setPen(QPen(PlotRenderer::indexColor(dataset.indices[i], i), 2));
+        k = 0;
+        for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it) {
+            d.values[k++] = i < it.value().size() ? it.value().at(i) : 0.0;
+        }
+        graph->setData(d.keys, d.values, true);  // wavelength keys are sorted by the map
+    }
+    plot->yAxis->setLabel(dataset.units);
+    plot->rescaleAxes();
+
+    QCPRange yr = plot->yAxis->range();
+    double height = (yr.upper - yr.lower) * 0.01;
+    d.gradientRect->topLeft->setCoords(380, yr.lower);
+    d.gradientRect->bottomRight->setCoords(780, yr.lower + height);
+}
+
+bool
+PlotRendererPrivate::renderImage(const QString& fileName)
+{
+    QImage image = d.plot->toImage(d.size.width(), d.size.height(), d.scale);
+    if (image.isNull()) {
+        return false;
+    }
+    return image.save(fileName);
+}
+
+bool
+PlotRendererPrivate::renderVector(const QString& fileName, const QString& title)
+{
+    VectorExport vectorExport;
+    vectorExport.setSize(d.size);
+    vectorExport.setTitle(title);
+    vectorExport.setBackground(d.plot->backgroundBrush());  // same page as the raster output
+    return vectorExport.write(d.plot.data(), fileName);
+}
+
+#include "plotrenderer.moc"
+
+PlotRenderer::PlotRenderer(QObject* parent)
+    : QObject(parent)
+    , p(new PlotRendererPrivate())
+{
+    p->init();
+}
+
+PlotRenderer::~PlotRenderer() {}
+
+QStringList
+PlotRenderer::availableFormats()
+{
+    return { "png", "pdf", "svg" };
+}
+
+QColor
+PlotRenderer::indexColor(const QString& index, int i)
+{
+    QString idx = index.toUpper();
+    if (idx == "R")
+        return Qt::red;
+    else if (idx == "G")
+        return Qt::green;
+    else if (idx == "B")
+        return Qt::blue;
+    else
+        return QColor::fromHslF((i * 0.15), 0.7, 0.5);
+}
+
+QLinearGradient
+PlotRenderer::spectrumGradient()
+{
+    QLinearGradient grad(0, 0, 1, 0);
+    grad.setCoordinateMode(QGradient::ObjectBoundingMode);
+    grad.setColorAt(0.0, QColor::fromHslF(0.72, 1.0, 0.5));
+    grad.setColorAt(0.15, QColor::fromHslF(0.66, 1.0, 0.5));
+    grad.setColorAt(0.3, QColor::fromHslF(0.5, 1.0, 0.5));
+    grad.setColorAt(0.55, QColor::fromHslF(0.17, 1.0, 0.5));
+    grad.setColorAt(0.75, QColor::fromHslF(0.0, 1.0, 0.5));
+    grad.setColorAt(1.0, QColor::fromHslF(0.0, 1.0, 0.2));
+    return grad;
+}
+
+QSize
+PlotRenderer::size() const
+{
+    return p->d.size;
+}
+
+void
+PlotRenderer::setSize(const QSize& size)
+{
+    p->d.size = size;
+}
+
+double
+PlotRenderer::scale() const
+{
+    return p->d.scale;
+}
+
+void
+PlotRenderer::setScale(double scale)
+{
+    p->d.scale = scale;
+}
+
+QCustomPlot*
+PlotRenderer::plot() const
+{
+    return p->d.plot.data();
+}
+
+bool
+PlotRenderer::render(const SpecFile::Dataset& dataset, const QString& fileName)
+{
+    if (!dataset.loaded) {
+        qWarning() << "PlotRenderer: dataset is not loaded:" << dataset.name;
+        return false;
+    }
+    QString format = QFileInfo(fileName).suffix().toLower();
+    if (!availableFormats().contains(format)) {
+        qWarning() << "PlotRenderer: unsupported format:" << format;
+        return false;
+    }
+    p->setup(dataset);
+    bool success = false;
+    if (format == "png") {
+        success = p->renderImage(fileName);
+    }
+    else {
+        success = p->renderVector(fileName, dataset.name);
+    }
+    if (!success) {
+        qWarning() << "PlotRenderer: could not write:" << fileName;
+    }
+    return success;
+}
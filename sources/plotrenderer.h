@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+#include <QColor>
+#include <QLinearGradient>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSize>
+
+class QCustomPlot;
+class PlotRendererPrivate;
+class PlotRenderer : public QObject {
+    Q_OBJECT
+public:
+    PlotRenderer(QObject* parent = nullptr);
+    virtual ~PlotRenderer();
+    static QStringList availableFormats();
+    static QColor indexColor(const QString& index, int i);
+    static QLinearGradient spectrumGradient();
+
+    QSize size() const;
+    double scale() const;
+    QCustomPlot* plot() const;
+    bool render(const SpecFile::Dataset& dataset, const QString& fileName);
+
+public Q_SLOTS:
+    void setSize(const QSize& size);
+    void setScale(double scale);
+
+private:
+    QScopedPointer<PlotRendererPrivate> p;
+};
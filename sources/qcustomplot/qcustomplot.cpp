@@ -25,6 +25,17 @@
 
 #include "qcustomplot.h"
 
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define QCP_SIMD_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define QCP_SIMD_NEON
+#endif
+
 
 /* including file 'src/vector2d.cpp'       */
 /* modified 2022-11-06T12:45:56, size 7973 */
@@ -485,6 +496,288 @@ void QCPPainter::makeNonCosmetic()
     QPainter::setPen(p);
   }
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLineRasterizer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLineRasterizer
+  \brief Antialiased CPU line rasterizer writing directly into a QImage
+
+  This class draws thin antialiased polylines by computing the pixel coverage of each line column
+  (or row, for steep segments) analytically, in the spirit of Xiaolin Wu's algorithm extended to
+  pen widths of 1 to 3 pixels. Covered pixels are blended with integer source-over arithmetic
+  straight into the premultiplied ARGB32 scan lines of the target image. This avoids QPainter's
+  general purpose stroker, which dominates replot time for plots with thousands of 2 pixel lines.
+
+  It is used by \ref QCPGraph when the plotting hint \ref QCP::phRasterPolylines is set and the
+  layer is drawn into a \ref QCPPaintBufferImage. \ref begin returns false whenever the painter
+  state can't be reproduced faithfully (e.g. vectorized or export painting, rotated transforms,
+  non-rectangular clips, custom dash patterns or wide pens), so callers fall back to QPainter.
+
+  Supported pen styles are Qt::SolidLine, Qt::DashLine, Qt::DotLine, Qt::DashDotLine and
+  Qt::DashDotDotLine. Dash patterns are measured along the line in units of the pen width,
+  including the extension of dashes by square and round caps, like QPainter does.
+*/
+
+/*!
+  Creates an inactive rasterizer. Call \ref begin before drawing.
+*/
+QCPLineRasterizer::QCPLineRasterizer() :
+  mBits(nullptr),
+  mBytesPerLine(0),
+  mColor(0),
+  mWidth(1.0),
+  mDashLength(0),
+  mDashStart(0),
+  mDashPos(0)
+{
+}
+
+/*!
+  Prepares the rasterizer to draw into the paint device of \a painter with its current pen,
+  transform and clip rect.
+
+  Returns false if the device is not a premultiplied ARGB32 image or the painter state is not
+  supported by the rasterizer. In that case the caller should draw with \a painter instead.
+*/
+bool QCPLineRasterizer::begin(QCPPainter *painter)
+{
+  mBits = nullptr;
+  if (!painter || !painter->isActive() || !painter->antialiasing())
+    return false;
+  if (painter->modes().testFlag(QCPPainter::pmVectorized) || painter->modes().testFlag(QCPPainter::pmNoCaching))
+    return false;
+  if (painter->compositionMode() != QPainter::CompositionMode_SourceOver || painter->opacity() < 1.0)
+    return false;
+  QPaintDevice *device = painter->device();
+  if (!device || device->devType() != QInternal::Image)
+    return false;
+  
+  const QTransform transform = painter->deviceTransform(); // includes the device pixel ratio scaling
+  QRect clipRect;
+  if (painter->hasClipping())
+  {
+    const QRegion region = painter->clipRegion();
+    if (region.rectCount() > 1)
+      return false;
+    clipRect = transform.mapRect(QRectF(region.boundingRect())).toAlignedRect();
+    if (clipRect.isEmpty())
+      return false;
+  }
+  return begin(static_cast<QImage*>(device), painter->pen(), transform, clipRect);
+}
+
+/*! \overload
+
+  Prepares the rasterizer to draw into \a image with \a pen. Points passed to \ref drawPolyline are
+  mapped with \a transform, which may only translate and scale uniformly. If \a clipRect is valid,
+  drawing is restricted to it (in device pixels), otherwise to the whole image.
+*/
+bool QCPLineRasterizer::begin(QImage *image, const QPen &pen, const QTransform &transform, const QRect &clipRect)
+{
+  mBits = nullptr;
+  if (!image || image->isNull() || image->format() != QImage::Format_ARGB32_Premultiplied)
+    return false;
+  if (transform.type() > QTransform::TxScale || !qFuzzyCompare(qAbs(transform.m11()), qAbs(transform.m22())))
+    return false;
+  if (pen.brush().style() != Qt::SolidPattern || pen.widthF() > 3.0)
+    return false;
+  switch (pen.style())
+  {
+    case Qt::SolidLine:
+    case Qt::DashLine:
+    case Qt::DotLine:
+    case Qt::DashDotLine:
+    case Qt::DashDotDotLine: break;
+    default: return false;
+  }
+  
+  double alphaScale = 1.0;
+  mWidth = pen.isCosmetic() ? pen.widthF() : pen.widthF()*qAbs(transform.m11());
+  if (mWidth < 1.0) // zero width is a cosmetic one pixel line, thinner lines are approximated by reducing opacity
+  {
+    alphaScale = qFuzzyIsNull(mWidth) ? 1.0 : mWidth;
+    mWidth = 1.0;
+  }
+  QColor color = pen.color();
+  color.setAlphaF(color.alphaF()*alphaScale);
+  mColor = qPremultiply(color.rgba());
+  if (qAlpha(mColor) == 0)
+    return false;
+  
+  mDashes.clear();
+  mDashLength = 0;
+  mDashStart = 0;
+  if (pen.style() != Qt::SolidLine)
+  {
+    // QPainter extends every dash by half the pen width on both ends unless flat caps are used:
+    const double capExtension = pen.capStyle() == Qt::FlatCap ? 0 : mWidth;
+    const QVector<qreal> pattern = pen.dashPattern();
+    for (int i=0; i<pattern.size(); ++i)
+    {
+      const double length = pattern.at(i)*mWidth + (i % 2 == 0 ? capExtension : -capExtension);
+      mDashes.append(qMax(0.0, length));
+      mDashLength += mDashes.last();
+    }
+    if (mDashLength <= 0)
+      return false;
+    mDashStart = pen.dashOffset()*mWidth + 0.5*capExtension;
+  }
+  
+  mTransform = transform;
+  mClipRect = image->rect();
+  if (clipRect.isValid())
+    mClipRect &= clipRect;
+  if (mClipRect.isEmpty())
+    return false;
+  mBits = image->bits();
+  mBytesPerLine = image->bytesPerLine();
+  return true;
+}
+
+/*!
+  Draws lines between the points in \a lineData, given in logical pixel coordinates. NaN points
+  create gaps in the line, and every connected part restarts the dash pattern, matching what \ref
+  QCPAbstractPlottable1D::drawPolyline does with QPainter.
+*/
+void QCPLineRasterizer::drawPolyline(const QVector<QPointF> &lineData)
+{
+  if (!mBits)
+    return;
+  
+  const double sx = mTransform.m11(), sy = mTransform.m22();
+  const double dx = mTransform.dx(), dy = mTransform.dy();
+  QPointF previous;
+  bool hasPrevious = false;
+  mDashPos = mDashStart;
+  for (const QPointF &point : lineData)
+  {
+    if (qIsNaN(point.x()) || qIsNaN(point.y()))
+    {
+      hasPrevious = false;
+      mDashPos = mDashStart;
+      continue;
+    }
+    const QPointF mapped(point.x()*sx + dx, point.y()*sy + dy);
+    if (hasPrevious)
+      drawSegment(previous, mapped);
+    previous = mapped;
+    hasPrevious = true;
+  }
+}
+
+/*! \internal
+
+  Rasterizes the segment from \a start to \a end (in device pixels). The segment is walked along its
+  major axis one pixel at a time; for every step the covered span on the minor axis is the pen width
+  divided by the cosine of the segment angle, and each pixel receives the length of its overlap with
+  that span as coverage. Pixels are visited on the half-open interval [start, end) so that joints of
+  consecutive segments aren't blended twice.
+*/
+void QCPLineRasterizer::drawSegment(const QPointF &start, const QPointF &end)
+{
+  // shift coordinates so that pixel centers lie on integers:
+  double u0 = start.x()-0.5, v0 = start.y()-0.5, u1 = end.x()-0.5, v1 = end.y()-0.5;
+  const bool steep = qAbs(v1-v0) > qAbs(u1-u0);
+  if (steep)
+  {
+    qSwap(u0, v0);
+    qSwap(u1, v1);
+  }
+  const double du = u1-u0, dv = v1-v0;
+  if (qFuzzyIsNull(du))
+    return;
+  const double segmentLength = qSqrt(du*du + dv*dv);
+  const double slope = dv/du;
+  const double stepLength = qSqrt(1.0 + slope*slope); // distance along the line per major axis step
+  const double halfSpan = 0.5*mWidth*stepLength;
+  
+  const int uMin = steep ? mClipRect.top() : mClipRect.left();
+  const int uMax = steep ? mClipRect.bottom() : mClipRect.right();
+  const int vMin = steep ? mClipRect.left() : mClipRect.top();
+  const int vMax = steep ? mClipRect.right() : mClipRect.bottom();
+  
+  const int direction = du > 0 ? 1 : -1;
+  double first = direction > 0 ? std::ceil(u0) : std::floor(u0);
+  double last = direction > 0 ? std::ceil(u1)-1 : std::floor(u1)+1;
+  // clamp before converting to int, plottables may pass coordinates far outside of the view:
+  if (direction > 0)
+  {
+    first = qMax(first, double(uMin));
+    last = qMin(last, double(uMax));
+  } else
+  {
+    first = qMin(first, double(uMax));
+    last = qMax(last, double(uMin));
+  }
+  if ((last-first)*direction >= 0)
+  {
+    const int uEnd = int(last)+direction;
+    for (int u=int(first); u!=uEnd; u+=direction)
+    {
+      const double t = u-u0;
+      if (!mDashes.isEmpty() && !dashVisible(mDashPos + qAbs(t)*stepLength))
+        continue;
+      const double vc = v0 + t*slope;
+      const double lower = vc-halfSpan;
+      const double upper = vc+halfSpan;
+      const double vLow = std::floor(lower+0.5);
+      const double vHigh = std::ceil(upper-0.5);
+      if (vHigh < vMin || vLow > vMax)
+        continue;
+      const int vLast = int(qMin(vHigh, double(vMax)));
+      for (int v=int(qMax(vLow, double(vMin))); v<=vLast; ++v)
+      {
+        const double coverage = qMin(v+0.5, upper) - qMax(v-0.5, lower);
+        if (coverage > 0)
+        {
+          if (steep)
+            blend(v, u, coverage);
+          else
+            blend(u, v, coverage);
+        }
+      }
+    }
+  }
+  mDashPos += segmentLength;
+}
+
+/*! \internal
+
+  Returns whether the dash pattern is on at \a position, measured along the line in device pixels.
+*/
+bool QCPLineRasterizer::dashVisible(double position) const
+{
+  double remainder = std::fmod(position, mDashLength);
+  for (int i=0; i<mDashes.size(); ++i)
+  {
+    if (remainder < mDashes.at(i))
+      return i % 2 == 0;
+    remainder -= mDashes.at(i);
+  }
+  return false;
+}
+
+/*! \internal
+
+  Blends the pen color with \a coverage (0..1) onto the pixel at \a x, \a y with source-over
+  composition. All four premultiplied channels are processed at once, two per 32 bit multiply.
+*/
+void QCPLineRasterizer::blend(int x, int y, double coverage)
+{
+  auto byteMul = [](quint32 pixel, quint32 alpha) {
+    quint32 rb = (pixel & 0xff00ff)*alpha;
+    rb = ((rb + ((rb >> 8) & 0xff00ff) + 0x800080) >> 8) & 0xff00ff;
+    quint32 ag = ((pixel >> 8) & 0xff00ff)*alpha;
+    ag = (ag + ((ag >> 8) & 0xff00ff) + 0x800080) & 0xff00ff00;
+    return ag | rb;
+  };
+  quint32 *pixel = reinterpret_cast<quint32*>(mBits + y*mBytesPerLine) + x;
+  const quint32 source = byteMul(mColor, quint32(qMin(coverage, 1.0)*255.0 + 0.5));
+  *pixel = source + byteMul(*pixel, 255-qAlpha(source));
+}
 /* end of 'src/painter.cpp' */
 
 
@@ -720,6 +1013,73 @@ void QCPPaintBufferPixmap::reallocateBuffer()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering
+
+  This paint buffer behaves like \ref QCPPaintBufferPixmap, but keeps a premultiplied ARGB32 QImage
+  as internal buffer, so that \ref QCPLineRasterizer can write into the pixels directly. It is used
+  if the plotting hint \ref QCP::phRasterPolylines is set and \ref QCustomPlot::setOpenGl is false.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio)
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  return new QCPPainter(&mBuffer);
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+}
+
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferGlPbuffer
@@ -6123,7 +6483,8 @@ void QCPLabelPainterPrivate::analyzeFontMetrics()
 QCPAxisTicker::QCPAxisTicker() :
   mTickStepStrategy(tssReadability),
   mTickCount(5),
-  mTickOrigin(0)
+  mTickOrigin(0),
+  mRevision(0)
 {
 }
 
@@ -6138,6 +6499,7 @@ QCPAxisTicker::~QCPAxisTicker()
 */
 void QCPAxisTicker::setTickStepStrategy(QCPAxisTicker::TickStepStrategy strategy)
 {
+  ++mRevision;
   mTickStepStrategy = strategy;
 }
 
@@ -6151,6 +6513,7 @@ void QCPAxisTicker::setTickStepStrategy(QCPAxisTicker::TickStepStrategy strategy
 */
 void QCPAxisTicker::setTickCount(int count)
 {
+  ++mRevision;
   if (count > 0)
     mTickCount = count;
   else
@@ -6167,6 +6530,7 @@ void QCPAxisTicker::setTickCount(int count)
 */
 void QCPAxisTicker::setTickOrigin(double origin)
 {
+  ++mRevision;
   mTickOrigin = origin;
 }
 
@@ -6571,6 +6935,7 @@ QCPAxisTickerDateTime::QCPAxisTickerDateTime() :
 */
 void QCPAxisTickerDateTime::setDateTimeFormat(const QString &format)
 {
+  ++mRevision;
   mDateTimeFormat = format;
 }
 
@@ -6589,6 +6954,7 @@ void QCPAxisTickerDateTime::setDateTimeFormat(const QString &format)
 */
 void QCPAxisTickerDateTime::setDateTimeSpec(Qt::TimeSpec spec)
 {
+  ++mRevision;
   mDateTimeSpec = spec;
 }
 
@@ -6601,6 +6967,7 @@ void QCPAxisTickerDateTime::setDateTimeSpec(Qt::TimeSpec spec)
 */
 void QCPAxisTickerDateTime::setTimeZone(const QTimeZone &zone)
 {
+  ++mRevision;
   mTimeZone = zone;
   mDateTimeSpec = Qt::TimeZone;
 }
@@ -6617,6 +6984,7 @@ void QCPAxisTickerDateTime::setTimeZone(const QTimeZone &zone)
 */
 void QCPAxisTickerDateTime::setTickOrigin(double origin)
 {
+  ++mRevision;
   QCPAxisTicker::setTickOrigin(origin);
 }
 
@@ -6629,6 +6997,7 @@ void QCPAxisTickerDateTime::setTickOrigin(double origin)
 */
 void QCPAxisTickerDateTime::setTickOrigin(const QDateTime &origin)
 {
+  ++mRevision;
   setTickOrigin(dateTimeToKey(origin));
 }
 
@@ -6919,6 +7288,7 @@ QCPAxisTickerTime::QCPAxisTickerTime() :
 */
 void QCPAxisTickerTime::setTimeFormat(const QString &format)
 {
+  ++mRevision;
   mTimeFormat = format;
   
   // determine smallest and biggest unit in format, to optimize unit replacement and allow biggest
@@ -6950,6 +7320,7 @@ void QCPAxisTickerTime::setTimeFormat(const QString &format)
 */
 void QCPAxisTickerTime::setFieldWidth(QCPAxisTickerTime::TimeUnit unit, int width)
 {
+  ++mRevision;
   mFieldWidth[unit] = qMax(width, 1);
 }
 
@@ -7130,6 +7501,7 @@ QCPAxisTickerFixed::QCPAxisTickerFixed() :
 */
 void QCPAxisTickerFixed::setTickStep(double step)
 {
+  ++mRevision;
   if (step > 0)
     mTickStep = step;
   else
@@ -7145,6 +7517,7 @@ void QCPAxisTickerFixed::setTickStep(double step)
 */
 void QCPAxisTickerFixed::setScaleStrategy(QCPAxisTickerFixed::ScaleStrategy strategy)
 {
+  ++mRevision;
   mScaleStrategy = strategy;
 }
 
@@ -7245,6 +7618,7 @@ QCPAxisTickerText::QCPAxisTickerText() :
 */
 void QCPAxisTickerText::setTicks(const QMap<double, QString> &ticks)
 {
+  ++mRevision;
   mTicks = ticks;
 }
 
@@ -7258,6 +7632,7 @@ void QCPAxisTickerText::setTicks(const QMap<double, QString> &ticks)
 */
 void QCPAxisTickerText::setTicks(const QVector<double> &positions, const QVector<QString> &labels)
 {
+  ++mRevision;
   clear();
   addTicks(positions, labels);
 }
@@ -7269,6 +7644,7 @@ void QCPAxisTickerText::setTicks(const QVector<double> &positions, const QVector
 */
 void QCPAxisTickerText::setSubTickCount(int subTicks)
 {
+  ++mRevision;
   if (subTicks >= 0)
     mSubTickCount = subTicks;
   else
@@ -7285,6 +7661,7 @@ void QCPAxisTickerText::setSubTickCount(int subTicks)
 */
 void QCPAxisTickerText::clear()
 {
+  ++mRevision;
   mTicks.clear();
 }
 
@@ -7296,6 +7673,7 @@ void QCPAxisTickerText::clear()
 */
 void QCPAxisTickerText::addTick(double position, const QString &label)
 {
+  ++mRevision;
   mTicks.insert(position, label);
 }
 
@@ -7311,6 +7689,7 @@ void QCPAxisTickerText::addTick(double position, const QString &label)
 */
 void QCPAxisTickerText::addTicks(const QMap<double, QString> &ticks)
 {
+  ++mRevision;
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
   mTicks.unite(ticks);
 #else
@@ -7331,6 +7710,7 @@ void QCPAxisTickerText::addTicks(const QMap<double, QString> &ticks)
 */
 void QCPAxisTickerText::addTicks(const QVector<double> &positions, const QVector<QString> &labels)
 {
+  ++mRevision;
   if (positions.size() != labels.size())
     qDebug() << Q_FUNC_INFO << "passed unequal length vectors for positions and labels:" << positions.size() << labels.size();
   int n = qMin(positions.size(), labels.size());
@@ -7447,6 +7827,7 @@ QCPAxisTickerPi::QCPAxisTickerPi() :
 */
 void QCPAxisTickerPi::setPiSymbol(QString symbol)
 {
+  ++mRevision;
   mPiSymbol = symbol;
 }
 
@@ -7458,6 +7839,7 @@ void QCPAxisTickerPi::setPiSymbol(QString symbol)
 */
 void QCPAxisTickerPi::setPiValue(double pi)
 {
+  ++mRevision;
   mPiValue = pi;
 }
 
@@ -7471,6 +7853,7 @@ void QCPAxisTickerPi::setPiValue(double pi)
 */
 void QCPAxisTickerPi::setPeriodicity(int multiplesOfPi)
 {
+  ++mRevision;
   mPeriodicity = qAbs(multiplesOfPi);
 }
 
@@ -7480,6 +7863,7 @@ void QCPAxisTickerPi::setPeriodicity(int multiplesOfPi)
 */
 void QCPAxisTickerPi::setFractionStyle(QCPAxisTickerPi::FractionStyle style)
 {
+  ++mRevision;
   mFractionStyle = style;
 }
 
@@ -7738,6 +8122,7 @@ QCPAxisTickerLog::QCPAxisTickerLog() :
 */
 void QCPAxisTickerLog::setLogBase(double base)
 {
+  ++mRevision;
   if (base > 0)
   {
     mLogBase = base;
@@ -7758,6 +8143,7 @@ void QCPAxisTickerLog::setLogBase(double base)
 */
 void QCPAxisTickerLog::setSubTickCount(int subTicks)
 {
+  ++mRevision;
   if (subTicks >= 0)
     mSubTickCount = subTicks;
   else
@@ -8240,6 +8626,12 @@ QCPAxis::QCPAxis(QCPAxisRect *parent, AxisType type) :
   mTicker(new QCPAxisTicker),
   mCachedMarginValid(false),
   mCachedMargin(0),
+  mTickCacheValid(false),
+  mLayoutCacheValid(false),
+  mTickCacheHits(0),
+  mTickCacheMisses(0),
+  mLayoutCacheHits(0),
+  mLayoutCacheMisses(0),
   mDragging(false)
 {
   setParent(parent);
@@ -8571,8 +8963,10 @@ void QCPAxis::setRangeReversed(bool reversed)
 void QCPAxis::setTicker(QSharedPointer<QCPAxisTicker> ticker)
 {
   if (ticker)
+  {
     mTicker = ticker;
-  else
+    mTickCacheValid = false; // a new ticker can reuse the address and revision of a deleted one
+  } else
     qDebug() << Q_FUNC_INFO << "can not set nullptr as axis ticker";
   // no need to invalidate margin cache here because produced tick labels are checked for changes in setupTickVector
 }
@@ -9449,6 +9843,19 @@ QList<QCPAbstractItem*> QCPAxis::items() const
   return result;
 }
 
+/*!
+  Resets the tick and layout cache counters (\ref tickCacheHits, \ref tickCacheMisses, \ref
+  layoutCacheHits, \ref layoutCacheMisses) to zero. The caches themselves are kept.
+*/
+void QCPAxis::resetCacheStatistics()
+{
+  mTickCacheHits = 0;
+  mTickCacheMisses = 0;
+  mLayoutCacheHits = 0;
+  mLayoutCacheMisses = 0;
+  mLayoutCacheValid = false; // tick generation numbers restart, so the layout key isn't reliable anymore
+}
+
 /*!
   Transforms a margin side to the logically corresponding axis type. (QCP::msLeft to
   QCPAxis::atLeft, QCP::msRight to QCPAxis::atRight, etc.)
@@ -9677,29 +10084,7 @@ void QCPAxis::applyDefaultAntialiasingHint(QCPPainter *painter) const
 */
 void QCPAxis::draw(QCPPainter *painter)
 {
-  QVector<double> subTickPositions; // the final coordToPixel transformed vector passed to QCPAxisPainter
-  QVector<double> tickPositions; // the final coordToPixel transformed vector passed to QCPAxisPainter
-  QVector<QString> tickLabels; // the final vector passed to QCPAxisPainter
-  tickPositions.reserve(mTickVector.size());
-  tickLabels.reserve(mTickVector.size());
-  subTickPositions.reserve(mSubTickVector.size());
-  
-  if (mTicks)
-  {
-    for (int i=0; i<mTickVector.size(); ++i)
-    {
-      tickPositions.append(coordToPixel(mTickVector.at(i)));
-      if (mTickLabels)
-        tickLabels.append(mTickVectorLabels.at(i));
-    }
-
-    if (mSubTicks)
-    {
-      const int subTickCount = mSubTickVector.size();
-      for (int i=0; i<subTickCount; ++i)
-        subTickPositions.append(coordToPixel(mSubTickVector.at(i)));
-    }
-  }
+  setupTickPositions();
   
   // transfer all properties of this axis to QCPAxisPainterPrivate which it needs to draw the axis.
   // Note that some axis painter properties are already set by direct feed-through with QCPAxis setters
@@ -9717,9 +10102,10 @@ void QCPAxis::draw(QCPPainter *painter)
   mAxisPainter->viewportRect = mParentPlot->viewport();
   mAxisPainter->abbreviateDecimalPowers = mScaleType == stLogarithmic;
   mAxisPainter->reversedEndings = mRangeReversed;
-  mAxisPainter->tickPositions = tickPositions;
-  mAxisPainter->tickLabels = tickLabels;
-  mAxisPainter->subTickPositions = subTickPositions;
+  mAxisPainter->tickPositions = mTickPositions;
+  mAxisPainter->tickValues = mTicks && mTickLabels ? mTickVector : QVector<double>();
+  mAxisPainter->tickLabels = mTicks && mTickLabels ? mTickVectorLabels : QVector<QString>();
+  mAxisPainter->subTickPositions = mSubTickPositions;
   mAxisPainter->draw(painter);
 }
 
@@ -9736,9 +10122,86 @@ void QCPAxis::setupTickVectors()
   if (!mParentPlot) return;
   if ((!mTicks && !mTickLabels && !mGrid->visible()) || mRange.size() <= 0) return;
   
+  // ticks only depend on the range, the ticker state and the number format, so replots that leave
+  // those unchanged (e.g. when only items on an overlay layer moved) reuse the previous vectors:
+  TickCacheKey key;
+  key.range = mRange;
+  key.ticker = mTicker.data();
+  key.tickerRevision = mTicker->revision();
+  key.locale = mParentPlot->locale();
+  key.formatChar = mNumberFormatChar;
+  key.precision = mNumberPrecision;
+  key.subTicks = mSubTicks;
+  key.tickLabels = mTickLabels;
+  if (mTickCacheValid && key == mTickCacheKey)
+  {
+    ++mTickCacheHits;
+    return;
+  }
+  ++mTickCacheMisses;
+  
   QVector<QString> oldLabels = mTickVectorLabels;
   mTicker->generate(mRange, mParentPlot->locale(), mNumberFormatChar, mNumberPrecision, mTickVector, mSubTicks ? &mSubTickVector : nullptr, mTickLabels ? &mTickVectorLabels : nullptr);
   mCachedMarginValid &= mTickVectorLabels == oldLabels; // if labels have changed, margin might have changed, too
+  mTickCacheKey = key;
+  mTickCacheValid = true;
+  mLayoutCacheValid = false;
+}
+
+/*! \internal
+  
+  Transforms the tick and sub tick vectors to pixel positions for \ref draw. The positions are
+  kept from the previous call if neither the ticks nor the axis rect geometry, range direction or
+  scale type have changed since.
+*/
+void QCPAxis::setupTickPositions()
+{
+  LayoutCacheKey key;
+  key.tickGeneration = mTickCacheMisses;
+  key.axisRect = mAxisRect->rect();
+  key.rangeReversed = mRangeReversed;
+  key.scaleType = mScaleType;
+  key.ticks = mTicks;
+  key.subTicks = mSubTicks;
+  key.tickLabels = mTickLabels;
+  if (mLayoutCacheValid && key == mLayoutCacheKey)
+  {
+    ++mLayoutCacheHits;
+    return;
+  }
+  ++mLayoutCacheMisses;
+  
+  mTickPositions.clear();
+  mSubTickPositions.clear();
+  if (mTicks)
+  {
+    mTickPositions.reserve(mTickVector.size());
+    for (int i=0; i<mTickVector.size(); ++i)
+      mTickPositions.append(coordToPixel(mTickVector.at(i)));
+    if (mSubTicks)
+    {
+      mSubTickPositions.reserve(mSubTickVector.size());
+      for (int i=0; i<mSubTickVector.size(); ++i)
+        mSubTickPositions.append(coordToPixel(mSubTickVector.at(i)));
+    }
+  }
+  mLayoutCacheKey = key;
+  mLayoutCacheValid = true;
+}
+
+/*! \internal */
+bool QCPAxis::TickCacheKey::operator==(const TickCacheKey &other) const
+{
+  return range == other.range && ticker == other.ticker && tickerRevision == other.tickerRevision &&
+         locale == other.locale && formatChar == other.formatChar && precision == other.precision &&
+         subTicks == other.subTicks && tickLabels == other.tickLabels;
+}
+
+/*! \internal */
+bool QCPAxis::LayoutCacheKey::operator==(const LayoutCacheKey &other) const
+{
+  return tickGeneration == other.tickGeneration && axisRect == other.axisRect && rangeReversed == other.rangeReversed &&
+         scaleType == other.scaleType && ticks == other.ticks && subTicks == other.subTicks && tickLabels == other.tickLabels;
 }
 
 /*! \internal
@@ -9859,6 +10322,7 @@ int QCPAxis::calculateMargin()
   mAxisPainter->axisRect = mAxisRect->rect();
   mAxisPainter->viewportRect = mParentPlot->viewport();
   mAxisPainter->tickPositions = tickPositions;
+  mAxisPainter->tickValues = mTicks && mTickLabels ? mTickVector : QVector<double>();
   mAxisPainter->tickLabels = tickLabels;
   margin += mAxisPainter->size();
   margin += mPadding;
@@ -9916,7 +10380,8 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   abbreviateDecimalPowers(false),
   reversedEndings(false),
   mParentPlot(parentPlot),
-  mLabelCache(16) // cache at most 16 (tick) labels
+  mLabelCache(16), // cache at most 16 (tick) labels
+  mTickLabelLayoutValid(false)
 {
 }
 
@@ -9939,6 +10404,7 @@ void QCPAxisPainterPrivate::draw(QCPPainter *painter)
     mLabelCache.clear();
     mLabelParameterHash = newHash;
   }
+  updateTickLabelLayout();
   
   QPoint origin;
   switch (type)
@@ -10032,7 +10498,7 @@ void QCPAxisPainterPrivate::draw(QCPPainter *painter)
     if (tickLabelSide == QCPAxis::lsInside)
       distanceToAxis = -(qMax(tickLengthIn, subTickLengthIn)+tickLabelPadding);
     for (int i=0; i<maxLabelIndex; ++i)
-      placeTickLabel(painter, tickPositions.at(i), distanceToAxis, tickLabels.at(i), &tickLabelsSize);
+      placeTickLabel(painter, tickPositions.at(i), distanceToAxis, tickLabels.at(i), mTickLabelLayout.at(i), &tickLabelsSize);
     if (tickLabelSide == QCPAxis::lsOutside)
       margin += (QCPAxis::orientation(type) == Qt::Horizontal) ? tickLabelsSize.height() : tickLabelsSize.width();
   }
@@ -10134,6 +10600,7 @@ int QCPAxisPainterPrivate::size()
     mLabelCache.clear();
     mLabelParameterHash = newHash;
   }
+  updateTickLabelLayout();
   
   // get length of tick marks pointing outwards:
   if (!tickPositions.isEmpty())
@@ -10145,8 +10612,8 @@ int QCPAxisPainterPrivate::size()
     QSize tickLabelsSize(0, 0);
     if (!tickLabels.isEmpty())
     {
-      foreach (const QString &tickLabel, tickLabels)
-        getMaxTickLabelSize(tickLabelFont, tickLabel, &tickLabelsSize);
+      for (int i=0; i<tickLabels.size(); ++i)
+        getMaxTickLabelSize(mTickLabelLayout.at(i), tickLabels.at(i), &tickLabelsSize);
       result += QCPAxis::orientation(type) == Qt::Horizontal ? tickLabelsSize.height() : tickLabelsSize.width();
     result += tickLabelPadding;
     }
@@ -10173,6 +10640,7 @@ int QCPAxisPainterPrivate::size()
 void QCPAxisPainterPrivate::clearCache()
 {
   mLabelCache.clear();
+  mTickLabelLayoutValid = false;
 }
 
 /*! \internal
@@ -10195,6 +10663,38 @@ QByteArray QCPAxisPainterPrivate::generateLabelParameterHash() const
   return result;
 }
 
+/*! \internal
+  
+  Lays out every tick label with \ref getTickLabelData, unless the tick values, labels, label
+  parameters (font, device pixel ratio, rotation, etc.) and viewport size are the same as for the
+  previous layout. Font metrics are the expensive part of drawing an axis, so replots that don't
+  change the ticks of this axis keep the previous layout.
+*/
+void QCPAxisPainterPrivate::updateTickLabelLayout()
+{
+  TickLabelLayoutKey key;
+  key.labelParameterHash = mLabelParameterHash;
+  key.tickValues = tickValues;
+  key.tickLabels = tickLabels;
+  key.viewportSize = viewportRect.size();
+  if (mTickLabelLayoutValid && key == mTickLabelLayoutKey)
+    return;
+  
+  mTickLabelLayout.clear();
+  mTickLabelLayout.reserve(tickLabels.size());
+  for (int i=0; i<tickLabels.size(); ++i)
+    mTickLabelLayout.append(getTickLabelData(tickLabelFont, tickLabels.at(i)));
+  mTickLabelLayoutKey = key;
+  mTickLabelLayoutValid = true;
+}
+
+/*! \internal */
+bool QCPAxisPainterPrivate::TickLabelLayoutKey::operator==(const TickLabelLayoutKey &other) const
+{
+  return labelParameterHash == other.labelParameterHash && tickValues == other.tickValues &&
+         tickLabels == other.tickLabels && viewportSize == other.viewportSize;
+}
+
 /*! \internal
   
   Draws a single tick label with the provided \a painter, utilizing the internal label cache to
@@ -10214,7 +10714,7 @@ QByteArray QCPAxisPainterPrivate::generateLabelParameterHash() const
   superscripted powers, the font is temporarily made smaller by a fixed factor (see \ref
   getTickLabelData).
 */
-void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position, int distanceToAxis, const QString &text, QSize *tickLabelsSize)
+void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position, int distanceToAxis, const QString &text, const TickLabelData &labelData, QSize *tickLabelsSize)
 {
   // warning: if you change anything here, also adapt getMaxTickLabelSize() accordingly!
   if (text.isEmpty()) return;
@@ -10233,7 +10733,6 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
     if (!cachedLabel)  // no cached label existed, create it
     {
       cachedLabel = new CachedLabel;
-      TickLabelData labelData = getTickLabelData(painter->font(), text);
       cachedLabel->offset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
       if (!qFuzzyCompare(1.0, mParentPlot->bufferDevicePixelRatio()))
       {
@@ -10269,7 +10768,6 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
     mLabelCache.insert(text, cachedLabel); // return label to cache or insert for the first time if newly created
   } else // label caching disabled, draw text directly on surface:
   {
-    TickLabelData labelData = getTickLabelData(painter->font(), text);
     QPointF finalPosition = labelAnchor + getTickLabelDrawOffset(labelData);
     // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
      bool labelClippedByBorder = false;
@@ -10525,7 +11023,7 @@ QPointF QCPAxisPainterPrivate::getTickLabelDrawOffset(const TickLabelData &label
   margin calculation, the passed \a tickLabelsSize is only expanded, if it's currently set to a
   smaller width/height.
 */
-void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString &text,  QSize *tickLabelsSize) const
+void QCPAxisPainterPrivate::getMaxTickLabelSize(const TickLabelData &labelData, const QString &text,  QSize *tickLabelsSize) const
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
@@ -10535,7 +11033,6 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
     finalSize = cachedLabel->pixmap.size()/mParentPlot->bufferDevicePixelRatio();
   } else // label caching disabled or no label with this text cached:
   {
-    TickLabelData labelData = getTickLabelData(font, text);
     finalSize = labelData.rotatedTotalBounds.size();
   }
   
@@ -13923,7 +14420,14 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  const bool recreateBuffers = (hints ^ mPlottingHints).testFlag(QCP::phRasterPolylines);
   mPlottingHints = hints;
+  // the raster line hint needs image backed paint buffers:
+  if (recreateBuffers && !mOpenGl)
+  {
+    mPaintBuffers.clear();
+    setupPaintBuffers();
+  }
 }
 
 /*!
@@ -15894,7 +16398,9 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 #endif
-  } else
+  } else if (mPlottingHints.testFlag(QCP::phRasterPolylines))
+    return new QCPPaintBufferImage(viewport().size(), mBufferDevicePixelRatio);
+  else
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 }
 
@@ -16457,6 +16963,66 @@ QPixmap QCustomPlot::toPixmap(int width, int height, double scale)
   return result;
 }
 
+/*!
+  Renders the plot to an image in QImage::Format_ARGB32_Premultiplied and returns it.
+  
+  This works like \ref toPixmap, but since the target is a QImage, graph lines may take the fast
+  raster path enabled with \ref QCP::phRasterPolylines. This makes it the preferred way of
+  rendering many plots offscreen, e.g. in batch exports. The painter is only put into \ref
+  QCPPainter::pmNoCaching mode if \a scale is not 1.0, since cached tick labels would otherwise
+  be scaled up.
+  
+  \see toPixmap, toPainter
+*/
+QImage QCustomPlot::toImage(int width, int height, double scale)
+{
+  // this method is somewhat similar to toPixmap. Change something here, and a change in toPixmap might be necessary, too.
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+  
+  QImage result(scaledWidth, scaledHeight, QImage::Format_ARGB32_Premultiplied);
+  if (result.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't allocate image of size" << scaledWidth << scaledHeight;
+    return QImage();
+  }
+  result.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
+  QCPPainter painter;
+  painter.begin(&result);
+  if (painter.isActive())
+  {
+    QRect oldViewport = viewport();
+    setViewport(QRect(0, 0, newWidth, newHeight));
+    if (!qFuzzyCompare(scale, 1.0))
+    {
+      painter.setMode(QCPPainter::pmNoCaching);
+      if (scale > 1.0)
+        painter.setMode(QCPPainter::pmNonCosmetic);
+      painter.scale(scale, scale);
+    }
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+      painter.fillRect(mViewport, mBackgroundBrush);
+    draw(&painter);
+    setViewport(oldViewport);
+    painter.end();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on image";
+    return QImage();
+  }
+  return result;
+}
+
 /*!
   Renders the plot using the passed \a painter.
   
@@ -16724,7 +17290,55 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
   
   const bool skipNanCheck = mNanHandling == nhNone;
   const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
+  int i = 0;
+#if defined(QCP_SIMD_SSE2) || defined(QCP_SIMD_NEON)
+  // linear, non-periodic lookups of contiguous data compute four color indices at a time. Clamping before the
+  // truncation yields the same indices as the scalar loop, which takes over at the first block containing NaN:
+  if (!logarithmic && !mPeriodic && dataIndexFactor == 1)
+  {
+    const QRgb *colors = mColorBuffer.constData();
+#  if defined(QCP_SIMD_SSE2)
+    const __m128d lower = _mm_set1_pd(range.lower);
+    const __m128d factor = _mm_set1_pd(posToIndexFactor);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d top = _mm_set1_pd(mLevelCount-1);
+    alignas(16) int index[4];
+    for (; i+4 <= n; i += 4)
+    {
+      const __m128d a = _mm_loadu_pd(data+i);
+      const __m128d b = _mm_loadu_pd(data+i+2);
+      if (!skipNanCheck && _mm_movemask_pd(_mm_or_pd(_mm_cmpunord_pd(a, a), _mm_cmpunord_pd(b, b))))
+        break;
+      const __m128i ia = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_sub_pd(a, lower), factor), zero), top));
+      const __m128i ib = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_sub_pd(b, lower), factor), zero), top));
+      _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_unpacklo_epi64(ia, ib));
+      scanLine[i] = colors[index[0]];
+      scanLine[i+1] = colors[index[1]];
+      scanLine[i+2] = colors[index[2]];
+      scanLine[i+3] = colors[index[3]];
+    }
+#  else
+    const float64x2_t lower = vdupq_n_f64(range.lower);
+    const float64x2_t factor = vdupq_n_f64(posToIndexFactor);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    const float64x2_t top = vdupq_n_f64(mLevelCount-1);
+    for (; i+4 <= n; i += 4)
+    {
+      const float64x2_t a = vld1q_f64(data+i);
+      const float64x2_t b = vld1q_f64(data+i+2);
+      if (!skipNanCheck && vminvq_u32(vreinterpretq_u32_u64(vandq_u64(vceqq_f64(a, a), vceqq_f64(b, b)))) == 0)
+        break;
+      const int64x2_t ia = vcvtq_s64_f64(vminq_f64(vmaxq_f64(vmulq_f64(vsubq_f64(a, lower), factor), zero), top));
+      const int64x2_t ib = vcvtq_s64_f64(vminq_f64(vmaxq_f64(vmulq_f64(vsubq_f64(b, lower), factor), zero), top));
+      scanLine[i] = colors[vgetq_lane_s64(ia, 0)];
+      scanLine[i+1] = colors[vgetq_lane_s64(ia, 1)];
+      scanLine[i+2] = colors[vgetq_lane_s64(ib, 0)];
+      scanLine[i+3] = colors[vgetq_lane_s64(ib, 1)];
+    }
+#  endif
+  }
+#endif
+  for (; i<n; ++i)
   {
     const double value = data[dataIndexFactor*i];
     if (skipNanCheck || !std::isnan(value))
@@ -21655,6 +22269,15 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines)
   if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
   {
     applyDefaultAntialiasingHint(painter);
+    if (mParentPlot->plottingHints().testFlag(QCP::phRasterPolylines))
+    {
+      QCPLineRasterizer rasterizer;
+      if (rasterizer.begin(painter))
+      {
+        rasterizer.drawPolyline(lines);
+        return;
+      }
+    }
     drawPolyline(painter, lines);
   }
 }
@@ -25791,6 +26414,41 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
 /* including file 'src/plottables/plottable-colormap.cpp' */
 /* modified 2022-11-06T12:45:56, size 48189               */
 
+namespace {
+
+/*! \internal
+
+  Calls \a function(begin, end) for blocks of scan lines covering [0, \a lineCount) on the global
+  thread pool and returns when all blocks are done. The calling thread processes the last block.
+  Maps with fewer than \a minimumCells cells are processed on the calling thread in one block,
+  since dispatching to the pool costs more than colorizing them.
+*/
+template <typename Function>
+void qcpForEachLineBlock(int lineCount, qint64 cellCount, Function function, qint64 minimumCells=65536)
+{
+  const int threads = QThreadPool::globalInstance()->maxThreadCount();
+  if (lineCount < 2 || threads < 2 || cellCount < minimumCells)
+  {
+    function(0, lineCount);
+    return;
+  }
+  const int grain = qMax(1, lineCount/(threads*4)); // a few blocks per thread even out the load
+  const int blocks = (lineCount+grain-1)/grain;
+  QSemaphore done;
+  for (int b=0; b<blocks-1; ++b)
+  {
+    QThreadPool::globalInstance()->start([&function, &done, b, grain, lineCount]()
+    {
+      function(b*grain, qMin(lineCount, (b+1)*grain));
+      done.release();
+    });
+  }
+  function((blocks-1)*grain, lineCount);
+  done.acquire(blocks-1);
+}
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMapData
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -25853,7 +26511,9 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
   mIsEmpty(true),
   mData(nullptr),
   mAlpha(nullptr),
-  mDataModified(true)
+  mDataModified(true),
+  mModifiedBegin(0),
+  mModifiedEnd(std::numeric_limits<int>::max())
 {
   setSize(keySize, valueSize);
   fill(0);
@@ -25874,7 +26534,9 @@ QCPColorMapData::QCPColorMapData(const QCPColorMapData &other) :
   mIsEmpty(true),
   mData(nullptr),
   mAlpha(nullptr),
-  mDataModified(true)
+  mDataModified(true),
+  mModifiedBegin(0),
+  mModifiedEnd(std::numeric_limits<int>::max())
 {
   *this = other;
 }
@@ -25902,7 +26564,7 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
         memcpy(mAlpha, other.mAlpha, sizeof(mAlpha[0])*size_t(keySize*valueSize));
     }
     mDataBounds = other.mDataBounds;
-    mDataModified = true;
+    markModified();
   }
   return *this;
 }
@@ -25982,7 +26644,7 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
     if (mAlpha) // if we had an alpha map, recreate it with new size
       createAlpha();
     
-    mDataModified = true;
+    markModified();
   }
 }
 
@@ -26085,7 +26747,7 @@ void QCPColorMapData::setData(double key, double value, double z)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    markModified(valueCell, valueCell+1);
   }
 }
 
@@ -26109,11 +26771,39 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    markModified(valueIndex, valueIndex+1);
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
+/*!
+  Sets the data of all cells with value index \a valueIndex to the \ref keySize values in \a z,
+  ordered by key index.
+
+  This is equivalent to calling \ref setCell for every key index of the row, but copies the row in
+  one go. Only the modified row is colorized again by the next replot of the \ref QCPColorMap, so
+  appending rows to a large map stays cheap.
+
+  \see setCell
+*/
+void QCPColorMapData::setValueRow(int valueIndex, const double *z)
+{
+  if (valueIndex >= 0 && valueIndex < mValueSize && z)
+  {
+    double *row = mData+valueIndex*mKeySize;
+    for (int i=0; i<mKeySize; ++i)
+    {
+      row[i] = z[i];
+      if (z[i] < mDataBounds.lower)
+        mDataBounds.lower = z[i];
+      if (z[i] > mDataBounds.upper)
+        mDataBounds.upper = z[i];
+    }
+    markModified(valueIndex, valueIndex+1);
+  } else
+    qDebug() << Q_FUNC_INFO << "index out of bounds:" << valueIndex;
+}
+
 /*!
   Sets the alpha of the color map cell given by \a keyIndex and \a valueIndex to \a alpha. A value
   of 0 for \a alpha results in a fully transparent cell, and a value of 255 results in a fully
@@ -26136,7 +26826,7 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
     if (mAlpha || createAlpha())
     {
       mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
-      mDataModified = true;
+      markModified(valueIndex, valueIndex+1);
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
@@ -26193,7 +26883,7 @@ void QCPColorMapData::clearAlpha()
   {
     delete[] mAlpha;
     mAlpha = nullptr;
-    mDataModified = true;
+    markModified();
   }
 }
 
@@ -26203,9 +26893,9 @@ void QCPColorMapData::clearAlpha()
 void QCPColorMapData::fill(double z)
 {
   const int dataCount = mValueSize*mKeySize;
-  memset(mData, z, dataCount*sizeof(*mData));
+  std::fill(mData, mData+dataCount, z); // memset would truncate z to a byte pattern
   mDataBounds = QCPRange(z, z);
-  mDataModified = true;
+  markModified();
 }
 
 /*!
@@ -26223,7 +26913,7 @@ void QCPColorMapData::fillAlpha(unsigned char alpha)
   {
     const int dataCount = mValueSize*mKeySize;
     memset(mAlpha, alpha, dataCount*sizeof(*mAlpha));
-    mDataModified = true;
+    markModified();
   }
 }
 
@@ -26313,6 +27003,27 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   }
 }
 
+/*! \internal
+
+  Records that the cells with value indices from \a valueBegin up to (excluding) \a valueEnd were
+  modified since the color map image was last updated. \ref QCPColorMap::updateMapImage only
+  colorizes these rows again, as long as nothing else invalidated the image. Called without
+  arguments, the whole map is marked as modified.
+*/
+void QCPColorMapData::markModified(int valueBegin, int valueEnd)
+{
+  if (mDataModified)
+  {
+    mModifiedBegin = qMin(mModifiedBegin, valueBegin);
+    mModifiedEnd = qMax(mModifiedEnd, valueEnd);
+  } else
+  {
+    mModifiedBegin = valueBegin;
+    mModifiedEnd = valueEnd;
+    mDataModified = true;
+  }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMap
@@ -26742,6 +27453,15 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
   Updates the internal map image buffer by going through the internal \ref QCPColorMapData and
   turning the data values into color pixels with \ref QCPColorGradient::colorize.
   
+  Scan lines are colorized in parallel on the global thread pool for large maps. Each scan line is
+  written by exactly one task, and the gradient's color buffer is brought up to date before the
+  tasks start, so they only read shared state.
+  
+  If only cells were modified since the last update (see \ref QCPColorMapData::setCell and \ref
+  QCPColorMapData::setValueRow) and the image is otherwise still valid, only the scan lines of the
+  modified value rows are colorized again. This applies to horizontal key axes, where scan lines
+  and value rows coincide.
+  
   This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
   has been invalidated for a different reason (e.g. a change of the data range with \ref
   setDataRange).
@@ -26763,11 +27483,19 @@ void QCPColorMap::updateMapImage()
   int keyOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(keySize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   int valueOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(valueSize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   
+  // only the modified rows need to be colorized again if the image is otherwise still valid:
+  bool partial = !mMapImageInvalidated && !mMapImage.isNull();
+  
   // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
   if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
+  {
     mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
-  else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+    partial = false;
+  } else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+  {
     mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
+    partial = false;
+  }
   
   if (mMapImage.isNull())
   {
@@ -26781,39 +27509,57 @@ void QCPColorMap::updateMapImage()
     {
       // resize undersampled map image to actual key/value cell sizes:
       if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
+      {
         mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
-      else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+        partial = false;
+      } else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+      {
         mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
+        partial = false;
+      }
       localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
     } else if (!mUndersampledMapImage.isNull())
       mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
     
     const double *rawData = mMapData->mData;
     const unsigned char *rawAlpha = mMapData->mAlpha;
+    const bool logarithmic = mDataScaleType==QCPAxis::stLogarithmic;
+    mGradient.color(mDataRange.lower, mDataRange, logarithmic); // updates the color buffer before it is shared between threads
+    uchar *bits = localMapImage->bits(); // detaches once here instead of in concurrent scanLine calls
+    const qsizetype bytesPerLine = localMapImage->bytesPerLine();
     if (keyAxis->orientation() == Qt::Horizontal)
     {
+      // scan lines correspond to value rows, so modified rows map directly to the lines to update:
       const int lineCount = valueSize;
       const int rowCount = keySize;
-      for (int line=0; line<lineCount; ++line)
+      const int firstLine = partial ? qBound(0, mMapData->mModifiedBegin, lineCount) : 0;
+      const int lastLine = partial ? qBound(firstLine, mMapData->mModifiedEnd, lineCount) : lineCount;
+      qcpForEachLineBlock(lastLine-firstLine, qint64(lastLine-firstLine)*rowCount, [&](int begin, int end)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-      }
+        for (int line=firstLine+begin; line<firstLine+end; ++line)
+        {
+          QRgb* pixels = reinterpret_cast<QRgb*>(bits+(lineCount-1-line)*bytesPerLine); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+          if (rawAlpha)
+            mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, logarithmic);
+          else
+            mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, logarithmic);
+        }
+      });
     } else // keyAxis->orientation() == Qt::Vertical
     {
       const int lineCount = keySize;
       const int rowCount = valueSize;
-      for (int line=0; line<lineCount; ++line)
+      qcpForEachLineBlock(lineCount, qint64(lineCount)*rowCount, [&](int begin, int end)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-      }
+        for (int line=begin; line<end; ++line)
+        {
+          QRgb* pixels = reinterpret_cast<QRgb*>(bits+(lineCount-1-line)*bytesPerLine); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+          if (rawAlpha)
+            mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, logarithmic);
+          else
+            mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, logarithmic);
+        }
+      });
     }
     
     if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
@@ -26825,6 +27571,8 @@ void QCPColorMap::updateMapImage()
     }
   }
   mMapData->mDataModified = false;
+  mMapData->mModifiedBegin = std::numeric_limits<int>::max();
+  mMapData->mModifiedEnd = 0;
   mMapImageInvalidated = false;
 }
 
@@ -57,6 +57,7 @@
 #include <QtGui/QMouseEvent>
 #include <QtGui/QWheelEvent>
 #include <QtGui/QPixmap>
+#include <QtGui/QImage>
 #include <QtCore/QVector>
 #include <QtCore/QString>
 #include <QtCore/QDateTime>
@@ -268,6 +269,8 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phRasterPolylines  = 0x008 ///< <tt>0x008</tt> Graph lines are rasterized directly into an image paint buffer by \ref QCPLineRasterizer instead of QPainter's
+                                                ///<                antialiased stroker. It is only used for solid and dashed pens up to 3 pixels wide and never for exports.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -565,6 +568,38 @@ protected:
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPPainter::PainterModes)
 Q_DECLARE_METATYPE(QCPPainter::PainterMode)
 
+
+class QCP_LIB_DECL QCPLineRasterizer
+{
+public:
+  QCPLineRasterizer();
+  
+  // getters:
+  bool isActive() const { return mBits != nullptr; }
+  double width() const { return mWidth; }
+  
+  // non-virtual methods:
+  bool begin(QCPPainter *painter);
+  bool begin(QImage *image, const QPen &pen, const QTransform &transform=QTransform(), const QRect &clipRect=QRect());
+  void drawPolyline(const QVector<QPointF> &lineData);
+  
+protected:
+  // non-property members:
+  uchar *mBits;
+  qsizetype mBytesPerLine;
+  QRect mClipRect;
+  QTransform mTransform;
+  quint32 mColor;
+  double mWidth;
+  QVector<double> mDashes;
+  double mDashLength, mDashStart, mDashPos;
+  
+  // non-virtual methods:
+  void drawSegment(const QPointF &start, const QPointF &end);
+  bool dashVisible(double position) const;
+  void blend(int x, int y, double coverage);
+};
+
 /* end of 'src/painter.h' */
 
 
@@ -626,6 +661,26 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio);
+  virtual ~QCPPaintBufferImage() Q_DECL_OVERRIDE;
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  QImage mBuffer;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
@@ -1752,6 +1807,7 @@ public:
   TickStepStrategy tickStepStrategy() const { return mTickStepStrategy; }
   int tickCount() const { return mTickCount; }
   double tickOrigin() const { return mTickOrigin; }
+  int revision() const { return mRevision; }
   
   // setters:
   void setTickStepStrategy(TickStepStrategy strategy);
@@ -1767,6 +1823,9 @@ protected:
   int mTickCount;
   double mTickOrigin;
   
+  // non-property members:
+  int mRevision; // incremented whenever a setter changes the generated ticks, see \ref revision
+  
   // introduced virtual methods:
   virtual double getTickStep(const QCPRange &range);
   virtual int getSubTickCount(double tickStep);
@@ -2255,6 +2314,10 @@ public:
   QCPLineEnding lowerEnding() const;
   QCPLineEnding upperEnding() const;
   QCPGrid *grid() const { return mGrid; }
+  quint64 tickCacheHits() const { return mTickCacheHits; }
+  quint64 tickCacheMisses() const { return mTickCacheMisses; }
+  quint64 layoutCacheHits() const { return mLayoutCacheHits; }
+  quint64 layoutCacheMisses() const { return mLayoutCacheMisses; }
   
   // setters:
   Q_SLOT void setScaleType(QCPAxis::ScaleType type);
@@ -2319,6 +2382,7 @@ public:
   QList<QCPAbstractPlottable*> plottables() const;
   QList<QCPGraph*> graphs() const;
   QList<QCPAbstractItem*> items() const;
+  void resetCacheStatistics();
   
   static AxisType marginSideToAxisType(QCP::MarginSide side);
   static Qt::Orientation orientation(AxisType type) { return type==atBottom || type==atTop ? Qt::Horizontal : Qt::Vertical; }
@@ -2377,6 +2441,31 @@ protected:
   QVector<double> mSubTickVector;
   bool mCachedMarginValid;
   int mCachedMargin;
+  struct TickCacheKey
+  {
+    QCPRange range;
+    const QCPAxisTicker *ticker;
+    int tickerRevision;
+    QLocale locale;
+    QChar formatChar;
+    int precision;
+    bool subTicks, tickLabels;
+    bool operator==(const TickCacheKey &other) const;
+  };
+  struct LayoutCacheKey
+  {
+    quint64 tickGeneration;
+    QRect axisRect;
+    bool rangeReversed;
+    ScaleType scaleType;
+    bool ticks, subTicks, tickLabels;
+    bool operator==(const LayoutCacheKey &other) const;
+  };
+  TickCacheKey mTickCacheKey;
+  LayoutCacheKey mLayoutCacheKey;
+  bool mTickCacheValid, mLayoutCacheValid;
+  QVector<double> mTickPositions, mSubTickPositions; // coordToPixel transformed tick vectors of the last draw
+  quint64 mTickCacheHits, mTickCacheMisses, mLayoutCacheHits, mLayoutCacheMisses;
   bool mDragging;
   QCPRange mDragStartRange;
   QCP::AntialiasedElements mAADragBackup, mNotAADragBackup;
@@ -2399,6 +2488,7 @@ protected:
   
   // non-virtual methods:
   void setupTickVectors();
+  void setupTickPositions();
   QPen getBasePen() const;
   QPen getTickPen() const;
   QPen getSubTickPen() const;
@@ -2460,6 +2550,7 @@ public:
   
   QVector<double> subTickPositions;
   QVector<double> tickPositions;
+  QVector<double> tickValues;
   QVector<QString> tickLabels;
   
 protected:
@@ -2474,18 +2565,30 @@ protected:
     QRect baseBounds, expBounds, suffixBounds, totalBounds, rotatedTotalBounds;
     QFont baseFont, expFont;
   };
+  struct TickLabelLayoutKey
+  {
+    QByteArray labelParameterHash; // font, device pixel ratio, rotation, side and color
+    QVector<double> tickValues;
+    QVector<QString> tickLabels;
+    QSize viewportSize;
+    bool operator==(const TickLabelLayoutKey &other) const;
+  };
   QCustomPlot *mParentPlot;
   QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
   QCache<QString, CachedLabel> mLabelCache;
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
+  TickLabelLayoutKey mTickLabelLayoutKey;
+  QVector<TickLabelData> mTickLabelLayout; // getTickLabelData of every tick label, in the order of tickLabels
+  bool mTickLabelLayoutValid;
   
   virtual QByteArray generateLabelParameterHash() const;
+  void updateTickLabelLayout();
   
-  virtual void placeTickLabel(QCPPainter *painter, double position, int distanceToAxis, const QString &text, QSize *tickLabelsSize);
+  virtual void placeTickLabel(QCPPainter *painter, double position, int distanceToAxis, const QString &text, const TickLabelData &labelData, QSize *tickLabelsSize);
   virtual void drawTickLabel(QCPPainter *painter, double x, double y, const TickLabelData &labelData) const;
   virtual TickLabelData getTickLabelData(const QFont &font, const QString &text) const;
   virtual QPointF getTickLabelDrawOffset(const TickLabelData &labelData) const;
-  virtual void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
+  virtual void getMaxTickLabelSize(const TickLabelData &labelData, const QString &text, QSize *tickLabelsSize) const;
 };
 
 /* end of 'src/axis/axis.h' */
@@ -3832,6 +3935,7 @@ public:
   QRect viewport() const { return mViewport; }
   double bufferDevicePixelRatio() const { return mBufferDevicePixelRatio; }
   QPixmap background() const { return mBackgroundPixmap; }
+  QBrush backgroundBrush() const { return mBackgroundBrush; }
   bool backgroundScaled() const { return mBackgroundScaled; }
   Qt::AspectRatioMode backgroundScaledMode() const { return mBackgroundScaledMode; }
   QCPLayoutGrid *plotLayout() const { return mPlotLayout; }
@@ -3937,6 +4041,7 @@ public:
   bool saveBmp(const QString &fileName, int width=0, int height=0, double scale=1.0, int resolution=96, QCP::ResolutionUnit resolutionUnit=QCP::ruDotsPerInch);
   bool saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1, int resolution=96, QCP::ResolutionUnit resolutionUnit=QCP::ruDotsPerInch);
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
+  QImage toImage(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
   double replotTime(bool average=false) const;
@@ -6046,6 +6151,7 @@ public:
   void setValueRange(const QCPRange &valueRange);
   void setData(double key, double value, double z);
   void setCell(int keyIndex, int valueIndex, double z);
+  void setValueRow(int valueIndex, const double *z);
   void setAlpha(int keyIndex, int valueIndex, unsigned char alpha);
   
   // non-property methods:
@@ -6069,8 +6175,10 @@ protected:
   unsigned char *mAlpha;
   QCPRange mDataBounds;
   bool mDataModified;
+  int mModifiedBegin, mModifiedEnd; // value rows modified since the last map image update
   
   bool createAlpha(bool initializeOpaque=true);
+  void markModified(int valueBegin=0, int valueEnd=std::numeric_limits<int>::max());
   
   friend class QCPColorMap;
 };
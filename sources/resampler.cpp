@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "resampler.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+// banded weight matrix, target value t is the dot product of taps weights with source values from offsets[t]. akima
+// depends on the values and keeps the source interval and position per target instead
+class ResamplerWeights {
+public:
+    Resampler::Method method;
+    int sourceSize;
+    int targetSize;
+    int taps;
+    QVector<int> offsets;
+    QVector<double> weights;
+    QVector<double> positions;  // akima, distance from the interval start
+    QVector<double> source;     // akima, source grid
+};
+
+namespace {
+// cie 167:2005 coefficients, extrapolates two points beyond each end from the six nearest samples
+const double spragueBoundary[4][6] = { { 884, -1960, 3033, -2648, 1080, -180 },
+                                       { 508, -540, 488, -367, 144, -24 },
+                                       { -24, 144, -367, 488, -540, 508 },
+                                       { -180, 1080, -2648, 3033, -1960, 884 } };
+
+// fifth order sprague polynomial between p0 and p1, coefficients of p-2 .. p3 per power of x
+const double spragueCoefficients[6][6] = { { 0, 0, 24, 0, 0, 0 },           { 2, -16, 0, 16, -2, 0 },
+                                           { -1, 16, -30, 16, -1, 0 },      { -9, 39, -70, 66, -33, 7 },
+                                           { 13, -64, 126, -124, 61, -12 }, { -5, 25, -50, 50, -25, 5 } };
+
+int
+interval(const QVector<double>& source, double x)
+{
+    // index i of the interval source[i] <= x < source[i + 1], clamped to the first and last interval
+    int i = int(std::upper_bound(source.constBegin(), source.constEnd(), x) - source.constBegin()) - 1;
+    return qBound(0, i, int(source.size()) - 2);
+}
+
+bool
+isUniform(const QVector<double>& source)
+{
+    const double step = source[1] - source[0];
+    for (int i = 2; i < source.size(); ++i) {
+        if (std::abs((source[i] - source[i - 1]) - step) > 1e-6 * std::abs(step)) {
+            return false;
+        }
+    }
+    return step > 0.0;
+}
+
+void
+linearWeights(ResamplerWeights& w, const QVector<double>& source, const QVector<double>& target)
+{
+    w.taps = 2;
+    w.offsets.resize(target.size());
+    w.weights.resize(target.size() * 2);
+    for (int t = 0; t < target.size(); ++t) {
+        int i = interval(source, target[t]);
+        double r = qBound(0.0, (target[t] - source[i]) / (source[i + 1] - source[i]), 1.0);
+        w.offsets[t] = i;
+        w.weights[t * 2] = 1.0 - r;
+        w.weights[t * 2 + 1] = r;
+    }
+}
+
+void
+spragueWeights(ResamplerWeights& w, const QVector<double>& source, const QVector<double>& target)
+{
+    const int n = source.size();
+    w.taps = 6;
+    w.offsets.resize(target.size());
+    w.weights.fill(0.0, target.size() * 6);
+    for (int t = 0; t < target.size(); ++t) {
+        int i = interval(source, target[t]);
+        double r = qBound(0.0, (target[t] - source[i]) / (source[i + 1] - source[i]), 1.0);
+        int offset = qBound(0, i - 2, n - 6);
+        double* tap = w.weights.data() + t * 6;
+        double power = 1.0;
+        double window[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int k = 0; k < 6; ++k, power *= r) {
+            for (int j = 0; j < 6; ++j) {
+                window[j] += spragueCoefficients[k][j] * power / 24.0;
+            }
+        }
+        // fold the window p[i - 2] .. p[i + 3] onto real samples, points beyond the ends are extrapolated
+        for (int j = 0; j < 6; ++j) {
+            int index = i - 2 + j;
+            if (index >= 0 && index < n) {
+                tap[index - offset] += window[j];
+            }
+            else {
+                const double* boundary = index < 0 ? spragueBoundary[index + 2] : spragueBoundary[index - n + 2];
+                for (int m = 0; m < 6; ++m) {
+                    tap[m] += window[j] * boundary[m] / 209.0;
+                }
+            }
+        }
+        w.offsets[t] = offset;
+    }
+}
+
+void
+akimaPositions(ResamplerWeights& w, const QVector<double>& source, const QVector<double>& target)
+{
+    w.taps = 0;
+    w.source = source;
+    w.offsets.resize(target.size());
+    w.positions.resize(target.size());
+    for (int t = 0; t < target.size(); ++t) {
+        int i = interval(source, target[t]);
+        w.offsets[t] = i;
+        w.positions[t] = qBound(0.0, target[t] - source[i], source[i + 1] - source[i]);
+    }
+}
+
+template<int Taps>
+void
+applyBanded(const ResamplerWeights& w, const double* source, double* target, int columns)
+{
+    for (int c = 0; c < columns; ++c) {
+        const double* src = source + qsizetype(c) * w.sourceSize;
+        double* dst = target + qsizetype(c) * w.targetSize;
+        const int* offsets = w.offsets.constData();
+        const double* weights = w.weights.constData();
+        for (int t = 0; t < w.targetSize; ++t, weights += Taps) {
+            const double* s = src + offsets[t];
+            double sum = 0.0;
+            for (int k = 0; k < Taps; ++k) {
+                sum += weights[k] * s[k];
+            }
+            dst[t] = sum;
+        }
+    }
+}
+
+void
+applyAkima(const ResamplerWeights& w, const double* source, double* target, int columns)
+{
+    const int n = w.sourceSize;
+    const double* x = w.source.constData();
+    QVector<double> slopes(n + 3);   // m[-2] .. m[n], stored from index 0
+    QVector<double> tangents(n);
+    for (int c = 0; c < columns; ++c) {
+        const double* y = source + qsizetype(c) * n;
+        double* dst = target + qsizetype(c) * w.targetSize;
+        double* m = slopes.data() + 2;
+        for (int i = 0; i < n - 1; ++i) {
+            m[i] = (y[i + 1] - y[i]) / (x[i + 1] - x[i]);
+        }
+        m[-1] = 2.0 * m[0] - m[1];
+        m[-2] = 2.0 * m[-1] - m[0];
+        m[n - 1] = 2.0 * m[n - 2] - m[n - 3];
+        m[n] = 2.0 * m[n - 1] - m[n - 2];
+        for (int i = 0; i < n; ++i) {
+            double a = std::abs(m[i + 1] - m[i]);
+            double b = std::abs(m[i - 1] - m[i - 2]);
+            tangents[i] = a + b > 0.0 ? (a * m[i - 1] + b * m[i]) / (a + b) : 0.5 * (m[i - 1] + m[i]);
+        }
+        for (int t = 0; t < w.targetSize; ++t) {
+            int i = w.offsets[t];
+            double h = x[i + 1] - x[i];
+            double d = w.positions[t];
+            double p = (3.0 * m[i] - 2.0 * tangents[i] - tangents[i + 1]) / h;
+            double q = (tangents[i] + tangents[i + 1] - 2.0 * m[i]) / (h * h);
+            dst[t] = y[i] + d * (tangents[i] + d * (p + d * q));
+        }
+    }
+}
+
+QSharedPointer<const ResamplerWeights>
+cachedWeights(const QVector<double>& source, const QVector<double>& target, Resampler::Method method)
+{
+    // fall back to the methods the source grid supports
+    if (method == Resampler::Sprague && (source.size() < 6 || !isUniform(source))) {
+        method = Resampler::Linear;
+    }
+    if (method == Resampler::Akima && source.size() < 3) {
+        method = Resampler::Linear;
+    }
+
+    static QMutex mutex;
+    static QHash<QByteArray, QSharedPointer<const ResamplerWeights>> cache;
+    QByteArray key;
+    key.reserve(int(sizeof(int) + (source.size() + target.size()) * sizeof(double) + 1));
+    key.append(char(method));
+    key.append(reinterpret_cast<const char*>(source.constData()), source.size() * sizeof(double));
+    key.append('|');
+    key.append(reinterpret_cast<const char*>(target.constData()), target.size() * sizeof(double));
+    {
+        QMutexLocker locker(&mutex);
+        auto it = cache.constFind(key);
+        if (it != cache.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QSharedPointer<ResamplerWeights> w(new ResamplerWeights());
+    w->method = method;
+    w->sourceSize = source.size();
+    w->targetSize = target.size();
+    if (source.size() < 2) {
+        // a single sample is held constant
+        w->taps = 1;
+        w->offsets.fill(0, target.size());
+        w->weights.fill(source.isEmpty() ? 0.0 : 1.0, target.size());
+    }
+    else if (method == Resampler::Sprague) {
+        spragueWeights(*w, source, target);
+    }
+    else if (method == Resampler::Akima) {
+        akimaPositions(*w, source, target);
+    }
+    else {
+        linearWeights(*w, source, target);
+    }
+
+    QMutexLocker locker(&mutex);
+    if (cache.size() >= 64) {
+        cache.clear();  // grids rarely vary, keep the cache bounded when they do
+    }
+    cache.insert(key, w);
+    return w;
+}
+}  // namespace
+
+Resampler::Resampler(const QVector<double>& source, const QVector<double>& target, Method method)
+    : weights(cachedWeights(source, target, method))
+{}
+
+QVector<double>
+Resampler::uniformGrid(double start, double end, double step)
+{
+    QVector<double> grid;
+    if (step <= 0.0 || end < start) {
+        return grid;
+    }
+    const int count = int(std::floor((end - start) / step + 1e-9)) + 1;
+    grid.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        grid.append(start + i * step);
+    }
+    return grid;
+}
+
+QVector<double>
+Resampler::grid(const SpecFile::Dataset& dataset)
+{
+    QVector<double> grid;
+    grid.reserve(dataset.data.size());
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it) {
+        grid.append(it.key());
+    }
+    return grid;
+}
+
+Resampler::Method
+Resampler::method(const QString& name, bool* ok)
+{
+    QString lower = name.toLower();
+    if (ok) {
+        *ok = lower == "linear" || lower == "sprague" || lower == "akima";
+    }
+    if (lower == "sprague") {
+        return Sprague;
+    }
+    if (lower == "akima") {
+        return Akima;
+    }
+    return Linear;
+}
+
+SpecFile::Dataset
+Resampler::resample(const SpecFile::Dataset& dataset, const QVector<double>& target, Method method)
+{
+    SpecFile::Dataset resampled = dataset;
+    resampled.data.clear();
+    if (dataset.data.isEmpty()) {
+        return resampled;
+    }
+    const int columns = dataset.data.first().size();
+    const QVector<double> source = grid(dataset);
+    QVector<double> values(source.size() * columns);
+    int r = 0;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it, ++r) {
+        for (int c = 0; c < columns; ++c) {
+            values[c * source.size() + r] = it.value().value(c, 0.0);
+        }
+    }
+    Resampler resampler(source, target, method);
+    QVector<double> result = resampler.apply(values, columns);
+    for (int t = 0; t < target.size(); ++t) {
+        QVector<double> row(columns);
+        for (int c = 0; c < columns; ++c) {
+            row[c] = result[c * target.size() + t];
+        }
+        resampled.data.insert(qRound(target[t]), row);
+    }
+    return resampled;
+}
+
+Resampler::Method
+Resampler::method() const
+{
+    return weights->method;
+}
+
+int
+Resampler::sourceSize() const
+{
+    return weights->sourceSize;
+}
+
+int
+Resampler::targetSize() const
+{
+    return weights->targetSize;
+}
+
+void
+Resampler::apply(const double* source, double* target, int columns) const
+{
+    if (!weights->sourceSize) {
+        std::fill(target, target + qsizetype(columns) * weights->targetSize, 0.0);
+        return;
+    }
+    switch (weights->taps) {
+    case 0: applyAkima(*weights, source, target, columns); break;
+    case 1: applyBanded<1>(*weights, source, target, columns); break;
+    case 2: applyBanded<2>(*weights, source, target, columns); break;
+    case 6: applyBanded<6>(*weights, source, target, columns); break;
+    default: break;
+    }
+}
+
+QVector<double>
+Resampler::apply(const QVector<double>& source, int columns) const
+{
+    QVector<double> target(qsizetype(columns) * weights->targetSize);
+    apply(source.constData(), target.data(), columns);
+    return target;
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+#include <QSharedPointer>
+#include <QVector>
+
+class ResamplerWeights;
+class Resampler {
+public:
+    enum Method { Linear, Sprague, Akima };
+
+    Resampler(const QVector<double>& source, const QVector<double>& target, Method method = Linear);
+    static QVector<double> uniformGrid(double start, double end, double step);
+    static QVector<double> grid(const SpecFile::Dataset& dataset);
+    static Method method(const QString& name, bool* ok = nullptr);
+    static SpecFile::Dataset resample(const SpecFile::Dataset& dataset, const QVector<double>& target,
+                                      Method method = Linear);
+
+    Method method() const;
+    int sourceSize() const;
+    int targetSize() const;
+    // columns are curve contiguous, columns * sourceSize() values in and columns * targetSize() values out
+    void apply(const double* source, double* target, int columns) const;
+    QVector<double> apply(const QVector<double>& source, int columns) const;
+
+private:
+    QSharedPointer<const ResamplerWeights> weights;
+};
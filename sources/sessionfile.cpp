@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "sessionfile.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace {
+const int sessionVersion = 1;
+
+QJsonObject
+toJson(const CurvePipeline::Source& source)
+{
+    return QJsonObject { { "derived", source.derived }, { "index", source.index } };
+}
+
+CurvePipeline::Source
+toSource(const QJsonObject& object)
+{
+    CurvePipeline::Source source;
+    source.derived = object.value("derived").toBool();
+    source.index = object.value("index").toInt(-1);
+    return source;
+}
+}  // namespace
+
+SessionFile::SessionFile() {}
+
+bool
+SessionFile::load(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SessionFile: cannot open file:" << fileName;
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull() || !doc.isObject()) {
+        qWarning() << "SessionFile: JSON parse error:" << parseError.errorString();
+        return false;
+    }
+    QJsonObject root = doc.object();
+    if (root.value("version").toInt() != sessionVersion) {
+        qWarning() << "SessionFile: unsupported session version:" << fileName;
+        return false;
+    }
+    QDir dir = QFileInfo(fileName).absoluteDir();
+    datasets.clear();
+    for (const QJsonValue& value : root.value("datasets").toArray()) {
+        QJsonObject object = value.toObject();
+        Dataset dataset;
+        dataset.fileName = QDir::cleanPath(dir.absoluteFilePath(object.value("file").toString()));
+        dataset.metadata.name = object.value("name").toString();
+        dataset.metadata.units = object.value("units").toString();
+        dataset.metadata.header = object.value("header").toObject().toVariantMap();
+        dataset.metadata.precision = object.value("precision").toString() == "float64" ? SpecFile::Float64
+                                                                                       : SpecFile::Float32;
+        dataset.metadata.loaded = true;
+        dataset.style = object.value("style").toInt();
+        for (const QJsonValue& channelValue : object.value("channels").toArray()) {
+            QJsonObject channelObject = channelValue.toObject();
+            dataset.metadata.indices.append(channelObject.value("index").toString());
+            Channel channel;
+            channel.color = QColor(channelObject.value("color").toString());
+            channel.visible = channelObject.value("visible").toBool(true);
+            dataset.channels.append(channel);
+        }
+        datasets.append(dataset);
+    }
+    derived.clear();
+    for (const QJsonValue& value : root.value("derived").toArray()) {
+        QJsonObject object = value.toObject();
+        Derived curve;
+        curve.name = object.value("name").toString();
+        curve.input = toSource(object.value("input").toObject());
+        curve.visible = object.value("visible").toBool(true);
+        for (const QJsonValue& stepValue : object.value("steps").toArray()) {
+            QJsonObject stepObject = stepValue.toObject();
+            CurvePipeline::Step step;
+            step.operation = CurvePipeline::Operation(stepObject.value("operation").toInt());
+            step.operand = toSource(stepObject.value("operand").toObject());
+            step.wavelength = stepObject.value("wavelength").toDouble(560.0);
+            curve.steps.append(step);
+        }
+        derived.append(curve);
+    }
+    QJsonObject display = root.value("display").toObject();
+    align = display.value("align").toBool();
+    heatmap = display.value("heatmap").toBool();
+    return true;
+}
+
+bool
+SessionFile::save(const QString& fileName) const
+{
+    QDir dir = QFileInfo(fileName).absoluteDir();
+    QJsonArray datasetArray;
+    for (const Dataset& dataset : datasets) {
+        QJsonArray channelArray;
+        for (int i = 0; i < dataset.channels.size(); ++i) {
+            const Channel& channel = dataset.channels[i];
+            channelArray.append(QJsonObject { { "index", dataset.metadata.indices.value(i) },
+                                              { "color", channel.color.name() },
+                                              { "visible", channel.visible } });
+        }
+        QJsonObject object;
+        object["file"] = dir.relativeFilePath(dataset.fileName);
+        object["name"] = dataset.metadata.name;
+        object["units"] = dataset.metadata.units;
+        object["header"] = QJsonObject::fromVariantMap(dataset.metadata.header);
+        object["precision"] = dataset.metadata.precision == SpecFile::Float64 ? "float64" : "float32";
+        object["style"] = dataset.style;
+        object["channels"] = channelArray;
+        datasetArray.append(object);
+    }
+    QJsonArray derivedArray;
+    for (const Derived& curve : derived) {
+        QJsonArray stepArray;
+        for (const CurvePipeline::Step& step : curve.steps) {
+            stepArray.append(QJsonObject { { "operation", int(step.operation) },
+                                           { "operand", toJson(step.operand) },
+                                           { "wavelength", step.wavelength } });
+        }
+        derivedArray.append(QJsonObject { { "name", curve.name },
+                                          { "input", toJson(curve.input) },
+                                          { "steps", stepArray },
+                                          { "visible", curve.visible } });
+    }
+    QJsonObject root;
+    root["version"] = sessionVersion;
+    root["datasets"] = datasetArray;
+    root["derived"] = derivedArray;
+    root["display"] = QJsonObject { { "align", align }, { "heatmap", heatmap } };
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "SessionFile: cannot write file:" << fileName;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
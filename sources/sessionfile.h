@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "curvepipeline.h"
+#include "specfile.h"
+
+#include <QColor>
+#include <QList>
+#include <QString>
+
+// a saved comparison, references to the dataset files with their pens and visibility, derived curves and display
+// options. the metadata of each dataset is stored with its reference so that a session can be shown before any
+// file is parsed, file names are stored relative to the session file
+class SessionFile {
+public:
+    struct Channel {
+        QColor color;
+        bool visible = true;
+    };
+    struct Dataset {
+        QString fileName;            // absolute
+        SpecFile::Dataset metadata;  // without samples
+        int style = 0;               // index of the line style
+        QList<Channel> channels;
+    };
+    struct Derived {
+        QString name;
+        CurvePipeline::Source input;
+        QList<CurvePipeline::Step> steps;
+        bool visible = true;
+    };
+
+    SessionFile();
+    static QString extension() { return "specviz"; }
+
+    bool load(const QString& fileName);
+    bool save(const QString& fileName) const;
+
+    QList<Dataset> datasets;
+    QList<Derived> derived;
+    bool align = false;
+    bool heatmap = false;
+};
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "sessionmatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+template<typename T>
+T*
+grow(QVector<T>& block, qsizetype size)
+{
+    // grow geometrically, appends are frequent and each copies the whole block otherwise
+    if (size > block.capacity()) {
+        block.reserve(qMax(size, block.capacity() * 2));
+    }
+    block.resize(size);
+    return block.data();
+}
+}  // namespace
+
+SessionMatrix::SessionMatrix()
+    : storage(SpecFile::Float32)
+    , resampling(Resampler::Linear)
+    , curves(0)
+    , start(0.0)
+    , step(0.0)
+{}
+
+void
+SessionMatrix::setGrid(const QVector<double>& grid, Resampler::Method method)
+{
+    clear();
+    wavelengths = grid;
+    resampling = method;
+    start = grid.isEmpty() ? 0.0 : grid.first();
+    step = grid.size() > 1 ? grid[1] - grid[0] : 0.0;
+    for (int i = 2; i < grid.size() && step > 0.0; ++i) {
+        if (std::abs(grid[i] - grid[i - 1] - step) > 1e-6 * step) {
+            step = 0.0;
+        }
+    }
+}
+
+int
+SessionMatrix::append(const SpecFile::Dataset& dataset)
+{
+    const int channels = dataset.indices.size();
+    const qsizetype offset = qsizetype(curves) * wavelengths.size();
+    const qsizetype size = offset + qsizetype(channels) * wavelengths.size();
+    if (dataset.precision == SpecFile::Float64 && storage == SpecFile::Float32) {
+        widen();
+    }
+    if (storage == SpecFile::Float64) {
+        resample(dataset, grow(values, size) + offset);
+    }
+    else {
+        QVector<double> resampled(size - offset);
+        resample(dataset, resampled.data());
+        std::copy(resampled.constBegin(), resampled.constEnd(), grow(singles, size) + offset);
+    }
+    curveOffsets.append(curves);
+    channelCounts.append(channels);
+    curves += channels;
+    return curveOffsets.size() - 1;
+}
+
+bool
+SessionMatrix::replace(int dataset, const SpecFile::Dataset& data)
+{
+    if (dataset < 0 || dataset >= curveOffsets.size() || channelCounts[dataset] != data.indices.size()) {
+        return false;
+    }
+    if (data.precision == SpecFile::Float64 && storage == SpecFile::Float32) {
+        widen();
+    }
+    const qsizetype offset = qsizetype(curveOffsets[dataset]) * wavelengths.size();
+    if (storage == SpecFile::Float64) {
+        resample(data, values.data() + offset);
+    }
+    else {
+        QVector<double> resampled(qsizetype(channelCounts[dataset]) * wavelengths.size());
+        resample(data, resampled.data());
+        std::copy(resampled.constBegin(), resampled.constEnd(), singles.data() + offset);
+    }
+    return true;
+}
+
+const double*
+SessionMatrix::curve(int curve) const
+{
+    return storage == SpecFile::Float64 ? values.constData() + qsizetype(curve) * wavelengths.size() : nullptr;
+}
+
+const float*
+SessionMatrix::curveFloat(int curve) const
+{
+    return storage == SpecFile::Float32 ? singles.constData() + qsizetype(curve) * wavelengths.size() : nullptr;
+}
+
+double
+SessionMatrix::value(int curve, int index) const
+{
+    const qsizetype i = qsizetype(curve) * wavelengths.size() + index;
+    return storage == SpecFile::Float64 ? values[i] : double(singles[i]);
+}
+
+void
+SessionMatrix::copyCurves(int first, int count, double* target) const
+{
+    const qsizetype begin = qsizetype(first) * wavelengths.size();
+    const qsizetype end = begin + qsizetype(count) * wavelengths.size();
+    if (storage == SpecFile::Float64) {
+        std::copy(values.constData() + begin, values.constData() + end, target);
+    }
+    else {
+        std::copy(singles.constData() + begin, singles.constData() + end, target);
+    }
+}
+
+qint64
+SessionMatrix::bytes() const
+{
+    return qint64(values.capacity()) * sizeof(double) + qint64(singles.capacity()) * sizeof(float);
+}
+
+void
+SessionMatrix::widen()
+{
+    // float32 values are exact in float64, the curves already resampled keep their values
+    values.resize(singles.size());
+    std::copy(singles.constBegin(), singles.constEnd(), values.begin());
+    singles = QVector<float>();
+    storage = SpecFile::Float64;
+}
+
+void
+SessionMatrix::resample(const SpecFile::Dataset& dataset, double* target) const
+{
+    const int channels = dataset.indices.size();
+    const QVector<double> source = Resampler::grid(dataset);
+    if (source.isEmpty()) {
+        std::fill(target, target + qsizetype(channels) * wavelengths.size(), 0.0);
+        return;
+    }
+    QVector<double> columns(qsizetype(channels) * source.size());
+    int r = 0;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it, ++r) {
+        for (int c = 0; c < channels; ++c) {
+            columns[qsizetype(c) * source.size() + r] = it.value().value(c, 0.0);
+        }
+    }
+    Resampler resampler(source, wavelengths, resampling);
+    resampler.apply(columns.constData(), target, channels);
+}
+
+void
+SessionMatrix::clear()
+{
+    values.clear();
+    singles.clear();
+    storage = SpecFile::Float32;
+    curveOffsets.clear();
+    channelCounts.clear();
+    curves = 0;
+}
+
+int
+SessionMatrix::gridIndex(double wavelength) const
+{
+    if (wavelengths.isEmpty()) {
+        return -1;
+    }
+    if (step > 0.0) {
+        return qBound(0, int(std::lround((wavelength - start) / step)), int(wavelengths.size()) - 1);
+    }
+    auto it = std::lower_bound(wavelengths.constBegin(), wavelengths.constEnd(), wavelength);
+    if (it == wavelengths.constEnd()) {
+        return wavelengths.size() - 1;
+    }
+    if (it != wavelengths.constBegin() && wavelength - *(it - 1) < *it - wavelength) {
+        --it;
+    }
+    return int(it - wavelengths.constBegin());
+}
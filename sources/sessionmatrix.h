@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "resampler.h"
+#include "specfile.h"
+
+#include <QVector>
+
+// datasets resampled onto one shared wavelength grid, stored as a single block of curves (datasets x channels x
+// wavelengths) where each curve is contiguous. appending a dataset only resamples that dataset. the block is float32
+// while all datasets are measurements and is widened to float64 once a dataset needs it
+class SessionMatrix {
+public:
+    SessionMatrix();
+    void setGrid(const QVector<double>& grid, Resampler::Method method = Resampler::Linear);
+    const QVector<double>& grid() const { return wavelengths; }
+    Resampler::Method method() const { return resampling; }
+    SpecFile::Precision precision() const { return storage; }
+
+    int append(const SpecFile::Dataset& dataset);
+    // resamples a changed dataset in place, false if the number of channels differs
+    bool replace(int dataset, const SpecFile::Dataset& data);
+    void clear();
+
+    int datasetCount() const { return curveOffsets.size(); }
+    int curveCount() const { return curves; }
+    int channelCount(int dataset) const { return channelCounts[dataset]; }
+    int curveIndex(int dataset, int channel) const { return curveOffsets[dataset] + channel; }
+    // curves of the storage precision, null for the other one
+    const double* curve(int curve) const;
+    const float* curveFloat(int curve) const;
+    double value(int curve, int index) const;
+    // count curves from first, widened to double
+    void copyCurves(int first, int count, double* target) const;
+    qint64 bytes() const;
+    int gridIndex(double wavelength) const;
+
+private:
+    void resample(const SpecFile::Dataset& dataset, double* target) const;
+    void widen();
+    QVector<double> wavelengths;
+    QVector<double> values;
+    QVector<float> singles;
+    SpecFile::Precision storage;
+    QVector<int> curveOffsets;
+    QVector<int> channelCounts;
+    Resampler::Method resampling;
+    int curves;
+    double start;
+    double step;  // zero if the grid is not uniform
+};
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "speccache.h"
+#include "binaryfile.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+QScopedPointer<SpecCache, SpecCache::Deleter> SpecCache::pi;
+
+class SpecCachePrivate : public QObject {
+    Q_OBJECT
+public:
+    SpecCachePrivate();
+    QString cacheFileName(const QString& fileName) const;
+    void prune();
+
+    mutable QMutex mutex;
+    QString path;
+    bool enabled;
+    qint64 budget;
+    qint64 usage;  // bytes of all entries, counted on the first write
+};
+
+SpecCachePrivate::SpecCachePrivate()
+    : enabled(true)
+    , budget(qint64(1024) * 1024 * 1024)
+    , usage(-1)
+{
+    // shared between the application and the command line tools
+    path = QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)).filePath("specviz/datasets");
+    QByteArray override = qgetenv("SPECVIZ_CACHE");
+    if (override == "0") {
+        enabled = false;
+    }
+    else if (!override.isEmpty()) {
+        path = QString::fromLocal8Bit(override);
+    }
+}
+
+QString
+SpecCachePrivate::cacheFileName(const QString& fileName) const
+{
+    // a changed source gets a new key, stale entries are never read and age out of the budget
+    QFileInfo info(fileName);
+    if (!info.exists()) {
+        return QString();
+    }
+    QByteArray key = info.absoluteFilePath().toUtf8();
+    key += '\n' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    key += '\n' + QByteArray::number(info.size());
+    key += "\nprecision";  // entries from before the dataset precision was stored are not reused
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    QMutexLocker locker(&mutex);
+    return QDir(path).filePath(hash + ".specbin");
+}
+
+void
+SpecCachePrivate::prune()
+{
+    // oldest first down to a margin below the budget, so that the directory is not listed on every write
+    const QFileInfoList entries = QDir(path).entryInfoList({ "*.specbin" }, QDir::Files, QDir::Time | QDir::Reversed);
+    usage = 0;
+    for (const QFileInfo& entry : entries) {
+        usage += entry.size();
+    }
+    const qint64 target = budget - budget / 5;
+    for (const QFileInfo& entry : entries) {
+        if (usage <= target) {
+            break;
+        }
+        if (QFile::remove(entry.absoluteFilePath())) {
+            usage -= entry.size();
+        }
+    }
+}
+
+#include "speccache.moc"
+
+SpecCache::SpecCache()
+    : p(new SpecCachePrivate())
+{}
+
+SpecCache::~SpecCache() {}
+
+SpecCache*
+SpecCache::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!pi) {
+        pi.reset(new SpecCache());
+    }
+    return pi.data();
+}
+
+QString
+SpecCache::path() const
+{
+    QMutexLocker locker(&p->mutex);
+    return p->path;
+}
+
+void
+SpecCache::setPath(const QString& path)
+{
+    QMutexLocker locker(&p->mutex);
+    p->path = path;
+    p->usage = -1;
+}
+
+bool
+SpecCache::isEnabled() const
+{
+    QMutexLocker locker(&p->mutex);
+    return p->enabled;
+}
+
+void
+SpecCache::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&p->mutex);
+    p->enabled = enabled;
+}
+
+qint64
+SpecCache::budget() const
+{
+    QMutexLocker locker(&p->mutex);
+    return p->budget;
+}
+
+void
+SpecCache::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&p->mutex);
+    p->budget = qMax(qint64(0), bytes);
+    if (p->usage > p->budget) {
+        p->prune();
+    }
+}
+
+SpecFile::Dataset
+SpecCache::read(const QString& fileName)
+{
+    QString cacheFileName = p->cacheFileName(fileName);
+    if (cacheFileName.isEmpty() || !QFileInfo::exists(cacheFileName)) {
+        SpecFile::Dataset dataset;
+        return dataset;
+    }
+    return BinaryFile().read(cacheFileName);
+}
+
+bool
+SpecCache::write(const QString& fileName, const SpecFile::Dataset& dataset)
+{
+    QString cacheFileName = p->cacheFileName(fileName);
+    if (cacheFileName.isEmpty() || !QDir().mkpath(QFileInfo(cacheFileName).absolutePath())) {
+        qWarning() << "SpecCache: cannot create cache entry for:" << fileName;
+        return false;
+    }
+    if (!BinaryFile().write(dataset, cacheFileName)) {  // unpacked, entries are mapped on read
+        return false;
+    }
+    QMutexLocker locker(&p->mutex);
+    if (p->usage < 0 || p->usage + QFileInfo(cacheFileName).size() > p->budget) {
+        p->prune();
+    }
+    else {
+        p->usage += QFileInfo(cacheFileName).size();
+    }
+    return true;
+}
+
+void
+SpecCache::clear()
+{
+    QDir dir(path());
+    for (const QString& entry : dir.entryList({ "*.specbin" }, QDir::Files)) {
+        dir.remove(entry);
+    }
+    QMutexLocker locker(&p->mutex);
+    p->usage = 0;
+}
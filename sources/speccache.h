@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+#include <QObject>
+#include <QScopedPointer>
+
+// parsed datasets as binary files keyed by source path, modification time and size. entries beyond the byte budget
+// are removed oldest first, SPECVIZ_CACHE moves the cache to a directory or disables it with 0
+class SpecCachePrivate;
+class SpecCache : public QObject {
+    Q_OBJECT
+public:
+    static SpecCache* instance();
+    QString path() const;
+    bool isEnabled() const;
+    qint64 budget() const;
+    SpecFile::Dataset read(const QString& fileName);
+    bool write(const QString& fileName, const SpecFile::Dataset& dataset);
+    void clear();
+
+public Q_SLOTS:
+    void setPath(const QString& path);
+    void setEnabled(bool enabled);
+    void setBudget(qint64 bytes);
+
+private:
+    SpecCache();
+    ~SpecCache();
+    SpecCache(const SpecCache&) = delete;
+    SpecCache& operator=(const SpecCache&) = delete;
+    class Deleter {
+    public:
+        static void cleanup(SpecCache* pointer) { delete pointer; }
+    };
+    static QScopedPointer<SpecCache, Deleter> pi;
+    QScopedPointer<SpecCachePrivate> p;
+};
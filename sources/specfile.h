@@ -12,13 +12,15 @@
 
 class SpecFile {
 public:
+    enum Precision { Float32, Float64 };
     struct Dataset {
         QString name;
         QVariantMap header;               // flexible header
         QString units;                    // e.g. "relative"
         QStringList indices;              // e.g. ["R","G","B"]
         QMap<int, QVector<double>> data;  // wavelength -> [values]
-        bool loaded;
+        bool loaded = false;
+        Precision precision = Float64;  // of stored and resampled samples, float32 is plenty for measurements
     };
     virtual ~SpecFile() = default;
     virtual Dataset read(const QString& fileName) = 0;
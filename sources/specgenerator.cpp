@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "specgenerator.h"
+#include "parallel.h"
+
+#include <QAtomicInteger>
+#include <QDebug>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+QRandomGenerator
+generator(quint32 seed, int index, int set)
+{
+    const quint32 seeds[3] = { seed, quint32(index), quint32(set) };
+    return QRandomGenerator(seeds);
+}
+
+double
+gaussian(QRandomGenerator& random)
+{
+    // box muller, one value per call is enough here
+    const double u = 1.0 - random.generateDouble();
+    const double v = random.generateDouble();
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * 3.14159265358979323846 * v);
+}
+
+void
+appendNumber(QByteArray& out, double value)
+{
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%.6f", value);
+    out.append(buffer, length);
+}
+}  // namespace
+
+SpecGenerator::SpecGenerator(const Options& options)
+    : generatorOptions(options)
+{
+    generatorOptions.bands = qMax(1, generatorOptions.bands);
+    generatorOptions.sets = qMax(1, generatorOptions.sets);
+    if (generatorOptions.step < 1.0) {
+        // neighbouring bands would round to the same whole nm, in the readers and in argyll field names
+        qWarning() << "SpecGenerator: step below 1 nm is not supported, using 1 nm:" << generatorOptions.step;
+        generatorOptions.step = 1.0;
+    }
+}
+
+QString
+SpecGenerator::extension(Format format)
+{
+    return format == Ampas ? "json" : "sp";
+}
+
+QVector<double>
+SpecGenerator::spectrum(int index, int set) const
+{
+    const Options& o = generatorOptions;
+    QRandomGenerator random = generator(o.seed, index, set);
+    const double end = o.start + (o.bands - 1) * o.step;
+    const int peaks = 1 + random.bounded(4);
+    double centers[4], widths[4], heights[4];
+    for (int p = 0; p < peaks; ++p) {
+        centers[p] = o.start + (end - o.start) * random.generateDouble();
+        widths[p] = qMax(o.step, (end - o.start) * (0.03 + 0.2 * random.generateDouble()));
+        heights[p] = 0.2 + 0.8 * random.generateDouble();
+    }
+    const double base = 0.05 * random.generateDouble();
+    QVector<double> values(o.bands);
+    for (int b = 0; b < o.bands; ++b) {
+        const double wavelength = o.start + b * o.step;
+        double value = base;
+        for (int p = 0; p < peaks; ++p) {
+            const double x = (wavelength - centers[p]) / widths[p];
+            value += heights[p] * std::exp(-0.5 * x * x);
+        }
+        values[b] = qMax(0.0, value + o.noise * gaussian(random));
+    }
+    return values;
+}
+
+SpecFile::Dataset
+SpecGenerator::dataset(int index) const
+{
+    const Options& o = generatorOptions;
+    SpecFile::Dataset dataset;
+    dataset.name = QString("Synthetic %1").arg(index);
+    dataset.units = "relative";
+    dataset.header.insert("descriptor", "Synthetic spectral data");
+    dataset.header.insert("originator", "specviz-generate");
+    for (int f = 0; f < o.headerFields; ++f) {
+        dataset.header.insert(QString("field_%1").arg(f), header(index, f));
+    }
+    QVector<QVector<double>> sets(o.sets);
+    for (int s = 0; s < o.sets; ++s) {
+        dataset.indices.append(QString("Set %1").arg(s + 1));
+        sets[s] = spectrum(index, s);
+    }
+    for (int b = 0; b < o.bands; ++b) {
+        QVector<double> row(o.sets);
+        for (int s = 0; s < o.sets; ++s) {
+            row[s] = sets[s][b];
+        }
+        dataset.data.insert(qRound(o.start + b * o.step), row);  // steps of at least 1 nm round to distinct nm
+    }
+    dataset.precision = SpecFile::Float32;  // stands in for measurements
+    dataset.loaded = true;
+    return dataset;
+}
+
+QString
+SpecGenerator::header(int index, int field) const
+{
+    return QString("synthetic header value %1 of file %2 seed %3").arg(field).arg(index).arg(generatorOptions.seed);
+}
+
+QByteArray
+SpecGenerator::file(Format format, int index) const
+{
+    // written directly rather than through the readers' writers so that fractional wavelengths are kept
+    const Options& o = generatorOptions;
+    QByteArray out;
+    out.reserve(256 + o.headerFields * 64 + qint64(o.bands) * o.sets * 12);
+    if (format == Argyll) {
+        out.append("SPECT\n\n");
+        out.append("DESCRIPTOR \"Synthetic spectral data\"\n");
+        out.append("ORIGINATOR \"specviz-generate\"\n");
+        out.append("MEAS_TYPE \"REFLECTIVE\"\n");
+        for (int f = 0; f < o.headerFields; ++f) {
+            out.append(QString("KEYWORD \"FIELD_%1\"\nFIELD_%1 \"%2\"\n").arg(f).arg(header(index, f)).toUtf8());
+        }
+        out.append(QString("SPECTRAL_BANDS \"%1\"\n").arg(o.bands).toUtf8());
+        out.append(QString("SPECTRAL_START_NM \"%1\"\n").arg(o.start, 0, 'f', 6).toUtf8());
+        out.append(QString("SPECTRAL_END_NM \"%1\"\n").arg(o.start + (o.bands - 1) * o.step, 0, 'f', 6).toUtf8());
+        out.append("SPECTRAL_NORM \"1.000000\"\n\n");
+        out.append(QString("NUMBER_OF_FIELDS %1\nBEGIN_DATA_FORMAT\n").arg(o.bands).toUtf8());
+        for (int b = 0; b < o.bands; ++b) {
+            out.append(QString("SPEC_%1 ").arg(qRound(o.start + b * o.step), 3, 10, QChar('0')).toUtf8());
+        }
+        out.append(QString("\nEND_DATA_FORMAT\n\nNUMBER_OF_SETS %1\nBEGIN_DATA\n").arg(o.sets).toUtf8());
+        for (int s = 0; s < o.sets; ++s) {
+            const QVector<double> values = spectrum(index, s);
+            for (double value : values) {
+                appendNumber(out, value);
+                out.append(' ');
+            }
+            out.append('\n');
+        }
+        out.append("END_DATA\n");
+    }
+    else {
+        out.append("{\n    \"header\": {\n");
+        out.append("        \"description\": \"Synthetic spectral data\",\n");
+        for (int f = 0; f < o.headerFields; ++f) {
+            out.append(QString("        \"field_%1\": \"%2\",\n").arg(f).arg(header(index, f)).toUtf8());
+        }
+        out.append(QString("        \"model\": \"Synthetic %1\"\n    },\n").arg(index).toUtf8());
+        out.append("    \"spectral_data\": {\n        \"units\": \"relative\",\n        \"index\": {\n");
+        out.append("            \"main\": [");
+        for (int s = 0; s < o.sets; ++s) {
+            out.append(QString("%1\"Set %2\"").arg(QLatin1String(s > 0 ? ", " : "")).arg(s + 1).toUtf8());
+        }
+        out.append("]\n        },\n        \"data\": {\n            \"main\": {\n");
+        QVector<QVector<double>> sets(o.sets);
+        for (int s = 0; s < o.sets; ++s) {
+            sets[s] = spectrum(index, s);
+        }
+        for (int b = 0; b < o.bands; ++b) {
+            out.append("                \"");
+            out.append(QByteArray::number(o.start + b * o.step, 'g', 10));
+            out.append("\": [");
+            for (int s = 0; s < o.sets; ++s) {
+                if (s > 0) {
+                    out.append(", ");
+                }
+                appendNumber(out, sets[s][b]);
+            }
+            out.append(b + 1 < o.bands ? "],\n" : "]\n");
+        }
+        out.append("            }\n        }\n    }\n}\n");
+    }
+    return out;
+}
+
+bool
+SpecGenerator::write(Format format, int index, const QString& fileName) const
+{
+    const QByteArray contents = file(format, index);
+    QSaveFile out(fileName);
+    if (!out.open(QIODevice::WriteOnly) || out.write(contents) != contents.size()) {
+        qWarning() << "SpecGenerator: cannot write file:" << fileName;
+        return false;
+    }
+    return out.commit();
+}
+
+SpecGenerator::Tree
+SpecGenerator::writeTree(Format format, const QString& root, qint64 bytes, int filesPerDirectory) const
+{
+    // files are about the same size, the first one decides how many are needed to reach the total
+    Tree tree;
+    filesPerDirectory = qMax(1, filesPerDirectory);
+    const qint64 size = qMax<qint64>(1, file(format, 0).size());
+    const int count = int(qBound<qint64>(1, (bytes + size - 1) / size, std::numeric_limits<int>::max()));
+    const int directories = (count + filesPerDirectory - 1) / filesPerDirectory;
+    for (int d = 0; d < directories; ++d) {
+        if (!QDir().mkpath(QDir(root).filePath(QString("%1").arg(d, 5, 10, QChar('0'))))) {
+            qWarning() << "SpecGenerator: cannot create directory below:" << root;
+            tree.failed = count;
+            return tree;
+        }
+    }
+    QAtomicInteger<int> files = 0;
+    QAtomicInteger<int> failed = 0;
+    QAtomicInteger<qint64> written = 0;
+    parallel::forEachBlock(count, parallel::grainSize(count, 16), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const QString fileName = QDir(root).filePath(QString("%1/synthetic_%2.%3")
+                                                             .arg(i / filesPerDirectory, 5, 10, QChar('0'))
+                                                             .arg(i, 8, 10, QChar('0'))
+                                                             .arg(extension(format)));
+            const QByteArray contents = file(format, i);
+            QSaveFile out(fileName);
+            if (out.open(QIODevice::WriteOnly) && out.write(contents) == contents.size() && out.commit()) {
+                files.fetchAndAddRelaxed(1);
+                written.fetchAndAddRelaxed(contents.size());
+            }
+            else {
+                failed.fetchAndAddRelaxed(1);
+                qWarning() << "SpecGenerator: cannot write file:" << fileName;
+            }
+        }
+    });
+    tree.files = files.loadRelaxed();
+    tree.failed = failed.loadRelaxed();
+    tree.bytes = written.loadRelaxed();
+    return tree;
+}
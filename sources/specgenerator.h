@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "specfile.h"
+
+#include <QByteArray>
+#include <QString>
+
+// synthetic spectral files for benchmarks and stress tests. spectra are smooth sums of a few peaks with noise and
+// are reproducible, file n of a seed always has the same content no matter how many files are generated
+class SpecGenerator {
+public:
+    enum Format { Ampas, Argyll };
+    struct Options {
+        int bands = 401;
+        int sets = 1;
+        double start = 380.0;  // nm
+        double step = 1.0;     // nm, may be fractional but not below 1, files are read back in whole nm
+        double noise = 0.01;   // standard deviation relative to the peak
+        int headerFields = 0;  // extra header entries
+        quint32 seed = 1;
+    };
+    struct Tree {
+        int files = 0;
+        int failed = 0;
+        qint64 bytes = 0;
+    };
+
+    SpecGenerator(const Options& options = Options());
+    const Options& options() const { return generatorOptions; }
+    static QString extension(Format format);
+
+    QVector<double> spectrum(int index, int set) const;
+    SpecFile::Dataset dataset(int index) const;  // wavelengths rounded to whole nm, the same as the readers
+    QByteArray file(Format format, int index) const;
+    bool write(Format format, int index, const QString& fileName) const;
+    Tree writeTree(Format format, const QString& root, qint64 bytes, int filesPerDirectory = 1000) const;
+
+private:
+    QString header(int index, int field) const;
+    Options generatorOptions;
+};
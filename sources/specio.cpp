@@ -3,6 +3,8 @@
 // https://github.com/mikaelsundell/specviz
 
 #include "specio.h"
+#include "instrumentation.h"
+#include "speccache.h"
 
 #include <QDebug>
 #include <QFile>
@@ -12,7 +14,22 @@
 
 SpecIO::SpecIO(const QString& fileName)
 {
+    static Instrumentation::Histogram* readTime = Instrumentation::instance()->histogram("specio.read");
+    static Instrumentation::Counter* files = Instrumentation::instance()->counter("specio.files");
+    static Instrumentation::Counter* failed = Instrumentation::instance()->counter("specio.failed");
+    static Instrumentation::Counter* cacheHits = Instrumentation::instance()->counter("specio.cache.hits");
+    Instrumentation::Timer timer(readTime);
+    files->add();
     QString ext = QFileInfo(fileName).suffix().toLower();
+    SpecCache* cache = SpecCache::instance();
+    bool cached = cache->isEnabled() && !BinaryFile().extensions().contains(ext);
+    if (cached) {
+        dataset = cache->read(fileName);
+        if (dataset.loaded) {
+            cacheHits->add();
+            return;
+        }
+    }
     for (auto& factory : availableFiletypes()) {
         std::unique_ptr<SpecFile> candidate(factory());
         if (candidate) {
@@ -23,6 +40,12 @@ SpecIO::SpecIO(const QString& fileName)
             }
         }
     }
+    if (cached && dataset.loaded) {
+        cache->write(fileName, dataset);
+    }
+    if (!dataset.loaded) {
+        failed->add();
+    }
 }
 
 QStringList
@@ -52,5 +75,6 @@ SpecIO::write(const SpecFile::Dataset& dataset, const QString& fileName)
 QList<SpecIO::FileFactory>
 SpecIO::availableFiletypes()
 {
-    return { []() { return new AmpasFile(); }, []() { return new ArgyllFile(); } };
+    return { []() { return new AmpasFile(); }, []() { return new ArgyllFile(); },
+             []() { return new BinaryFile(BinaryFile::Packed); } };
 }
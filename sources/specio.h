@@ -6,6 +6,7 @@
 
 #include "ampasfile.h"
 #include "argyllfile.h"
+#include "binaryfile.h"
 
 #include <QFileInfo>
 #include <memory>
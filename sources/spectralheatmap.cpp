@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "spectralheatmap.h"
+#include "qcustomplot/qcustomplot.h"
+
+#include <limits>
+
+SpectralHeatmap::SpectralHeatmap(QCPColorMap* map)
+    : map(map)
+    , count(0)
+    , capacity(0)
+    , lower(std::numeric_limits<double>::max())
+    , upper(std::numeric_limits<double>::lowest())
+{
+    QCPColorGradient gradient(QCPColorGradient::gpSpectrum);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    map->setGradient(gradient);
+    map->setInterpolate(false);
+    map->setTightBoundary(false);
+}
+
+void
+SpectralHeatmap::setGrid(const QVector<double>& values)
+{
+    grid = values;
+    clear();
+}
+
+void
+SpectralHeatmap::clear()
+{
+    count = 0;
+    capacity = 0;
+    lower = std::numeric_limits<double>::max();
+    upper = std::numeric_limits<double>::lowest();
+    if (map) {
+        map->data()->clear();
+    }
+}
+
+void
+SpectralHeatmap::append(const double* values, int rows)
+{
+    if (!map || grid.size() < 2 || rows <= 0) {
+        return;
+    }
+    reserve(count + rows);
+    for (int r = 0; r < rows; ++r) {
+        setRow(count + r, values + qsizetype(r) * grid.size());
+    }
+    count += rows;
+    map->setDataRange(QCPRange(lower, upper));
+    map->valueAxis()->setRange(-0.5, count - 0.5);
+}
+
+void
+SpectralHeatmap::replace(int row, const double* values)
+{
+    if (!map || row < 0 || row >= count) {
+        return;
+    }
+    setRow(row, values);
+    map->setDataRange(QCPRange(lower, upper));
+}
+
+void
+SpectralHeatmap::reserve(int rows)
+{
+    if (rows <= capacity) {
+        return;
+    }
+    // capacity doubles, rows beyond the count are transparent and outside the value range
+    const int keys = grid.size();
+    const int size = qMax(16, qMax(rows, capacity * 2));
+    QCPColorMapData* data = new QCPColorMapData(keys, size, QCPRange(grid.first(), grid.last()),
+                                                QCPRange(0, size - 1));
+    data->fill(std::numeric_limits<double>::quiet_NaN());
+    QCPColorMapData* previous = map->data();
+    QVector<double> values(keys);
+    for (int r = 0; r < count; ++r) {
+        for (int k = 0; k < keys; ++k) {
+            values[k] = previous->cell(k, r);
+        }
+        data->setValueRow(r, values.constData());
+    }
+    map->setData(data);
+    capacity = size;
+}
+
+void
+SpectralHeatmap::setRow(int row, const double* values)
+{
+    // one row per call, only rows set since the last replot are colorized again
+    map->data()->setValueRow(row, values);
+    for (int k = 0; k < grid.size(); ++k) {
+        lower = qMin(lower, values[k]);
+        upper = qMax(upper, values[k]);
+    }
+}
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QPointer>
+#include <QVector>
+
+class QCPColorMap;
+
+// measurements as rows of a color map, wavelength on the key axis and measurement index on the value axis. rows
+// are copied from contiguous storage with one spectrum per row into spare capacity of the map, appending does not
+// rebuild the map and the color range grows with the values seen
+class SpectralHeatmap {
+public:
+    SpectralHeatmap(QCPColorMap* map);
+    void setGrid(const QVector<double>& grid);  // uniform, clears the map
+    void clear();
+    int rows() const { return count; }
+
+    void append(const double* values, int rows);  // rows spectra of grid size, one after the other
+    void replace(int row, const double* values);
+
+private:
+    void reserve(int rows);
+    void setRow(int row, const double* values);
+    QPointer<QCPColorMap> map;
+    QVector<double> grid;
+    int count;
+    int capacity;
+    double lower;
+    double upper;
+};
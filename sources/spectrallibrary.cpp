@@ -0,0 +1,504 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "spectrallibrary.h"
+#include "colorimetry.h"
+#include "parallel.h"
+#include "specio.h"
+#include "statistics.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+using SearchHeap = std::priority_queue<std::pair<double, int>>;  // largest distance on top
+
+namespace {
+inline double
+squaredDistance(const double* a, const double* b, int n)
+{
+    // independent accumulators break the dependency chain, the loop vectorizes without fast-math
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const double d0 = a[i] - b[i];
+        const double d1 = a[i + 1] - b[i + 1];
+        const double d2 = a[i + 2] - b[i + 2];
+        const double d3 = a[i + 3] - b[i + 3];
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+        s2 += d2 * d2;
+        s3 += d3 * d3;
+    }
+    for (; i < n; ++i) {
+        const double d = a[i] - b[i];
+        s0 += d * d;
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+inline double
+dotProduct(const double* a, const double* b, int n)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i) {
+        s0 += a[i] * b[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+double
+euclidean(const double* a, const double* b, int n)
+{
+    return std::sqrt(squaredDistance(a, b, n));
+}
+
+double
+angle(const double* a, const double* b, int n)
+{
+    return std::acos(qBound(-1.0, dotProduct(a, b, n), 1.0));
+}
+
+void
+push(SearchHeap& heap, int k, double distance, int entry)
+{
+    if (int(heap.size()) < k) {
+        heap.emplace(distance, entry);
+    }
+    else if (distance < heap.top().first) {
+        heap.pop();
+        heap.emplace(distance, entry);
+    }
+}
+}  // namespace
+
+// vantage point tree, each node splits the remaining points at the median distance to its vantage point so that
+// queries skip subtrees the triangle inequality rules out
+class SpectralLibraryIndex {
+public:
+    using Distance = double (*)(const double*, const double*, int);
+    SpectralLibraryIndex(const double* points, int count, int dimensions, Distance distance)
+        : points(points)
+        , dimensions(dimensions)
+        , distance(distance)
+    {
+        QVector<std::pair<double, int>> items(count);
+        for (int i = 0; i < count; ++i) {
+            items[i] = { 0.0, i };
+        }
+        nodes.reserve(count);
+        build(items, 0, count);
+    }
+    void search(const double* query, int k, SearchHeap& heap) const
+    {
+        search(nodes.isEmpty() ? -1 : 0, query, k, heap);
+    }
+
+private:
+    struct Node {
+        int point;
+        double radius;
+        int inside;
+        int outside;
+    };
+    const double* point(int index) const { return points + qsizetype(index) * dimensions; }
+
+    int build(QVector<std::pair<double, int>>& items, int begin, int end)
+    {
+        if (begin >= end) {
+            return -1;
+        }
+        std::swap(items[begin], items[begin + (end - begin) / 2]);
+        const int vantage = items[begin].second;
+        const int node = nodes.size();
+        nodes.append({ vantage, 0.0, -1, -1 });
+        if (end - begin == 1) {
+            return node;
+        }
+        for (int i = begin + 1; i < end; ++i) {
+            items[i].first = distance(point(vantage), point(items[i].second), dimensions);
+        }
+        const int median = (begin + 1 + end) / 2;
+        std::nth_element(items.begin() + begin + 1, items.begin() + median, items.begin() + end);
+        nodes[node].radius = items[median].first;
+        const int inside = build(items, begin + 1, median);
+        const int outside = build(items, median, end);
+        nodes[node].inside = inside;
+        nodes[node].outside = outside;
+        return node;
+    }
+
+    void search(int index, const double* query, int k, SearchHeap& heap) const
+    {
+        if (index < 0) {
+            return;
+        }
+        const Node& node = nodes[index];
+        const double d = distance(query, point(node.point), dimensions);
+        push(heap, k, d, node.point);
+        auto tau = [&]() {
+            return int(heap.size()) < k ? std::numeric_limits<double>::infinity() : heap.top().first;
+        };
+        // the nearer side first, it tightens tau before the other side is considered
+        if (d < node.radius) {
+            search(node.inside, query, k, heap);
+            if (d + tau() >= node.radius) {
+                search(node.outside, query, k, heap);
+            }
+        }
+        else {
+            search(node.outside, query, k, heap);
+            if (d - tau() <= node.radius) {
+                search(node.inside, query, k, heap);
+            }
+        }
+    }
+
+    const double* points;
+    int dimensions;
+    Distance distance;
+    QVector<Node> nodes;
+};
+
+struct SpectralLibrary::Query {
+    QVector<double> values;
+    QVector<double> unit;
+    double lab[3];
+};
+
+SpectralLibrary::SpectralLibrary(const QVector<double>& grid, Normalization normalization)
+    : wavelengths(grid)
+    , normalization(normalization)
+    , reducedDimensions(0)
+    , reductionDirty(false)
+{
+    setIlluminant(Colorimetry::illuminant("D65", grid));
+}
+
+SpectralLibrary::Metric
+SpectralLibrary::metric(const QString& name, bool* ok)
+{
+    QString lower = name.toLower();
+    if (ok) {
+        *ok = lower == "rms" || lower == "angle" || lower == "de2000";
+    }
+    if (lower == "angle") {
+        return Angle;
+    }
+    if (lower == "de2000") {
+        return DeltaE2000;
+    }
+    return Rms;
+}
+
+void
+SpectralLibrary::setIlluminant(const QVector<double>& illuminant)
+{
+    const int size = wavelengths.size();
+    weights = Colorimetry::weights(illuminant, wavelengths);
+    for (int c = 0; c < 3; ++c) {
+        white[c] = 0.0;
+        for (int i = 0; i < size; ++i) {
+            white[c] += weights[c * size + i];
+        }
+    }
+    QVector<double> unit(size);
+    for (int e = 0; e < count(); ++e) {
+        prepare(spectrum(e), unit.data(), labs.data() + qsizetype(e) * 3);
+    }
+}
+
+void
+SpectralLibrary::setDimensions(int dimensions)
+{
+    reducedDimensions = qMax(0, dimensions);
+    reductionDirty = true;
+    indexes[Rms].reset();
+}
+
+bool
+SpectralLibrary::addFile(const QString& fileName)
+{
+    SpecIO spec(fileName);
+    if (!spec.isLoaded()) {
+        qWarning() << "SpectralLibrary: could not load dataset from:" << fileName;
+        return false;
+    }
+    add(spec.data(), fileName);
+    return true;
+}
+
+int
+SpectralLibrary::addFiles(const QStringList& fileNames)
+{
+    // parsing dominates for large libraries, files are read in parallel and appended in order
+    QVector<SpecFile::Dataset> datasets(fileNames.size());
+    SpecFile::Dataset* loaded = datasets.data();
+    parallel::forEachBlock(fileNames.size(), parallel::grainSize(fileNames.size(), 4), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            SpecIO spec(fileNames[i]);
+            if (spec.isLoaded()) {
+                loaded[i] = spec.data();
+            }
+        }
+    });
+    int added = 0;
+    for (int i = 0; i < datasets.size(); ++i) {
+        if (!datasets[i].loaded) {
+            qWarning() << "SpectralLibrary: could not load dataset from:" << fileNames[i];
+            continue;
+        }
+        add(datasets[i], fileNames[i]);
+        ++added;
+    }
+    return added;
+}
+
+void
+SpectralLibrary::add(const SpecFile::Dataset& dataset, const QString& fileName)
+{
+    const int size = wavelengths.size();
+    const int channels = dataset.indices.size();
+    const QVector<double> source = Resampler::grid(dataset);
+    if (!channels || source.isEmpty()) {
+        return;
+    }
+    QVector<double> columns(qsizetype(channels) * source.size());
+    int r = 0;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it, ++r) {
+        for (int c = 0; c < channels; ++c) {
+            columns[qsizetype(c) * source.size() + r] = it.value().value(c, 0.0);
+        }
+    }
+    const qsizetype offset = values.size();
+    values.resize(offset + qsizetype(channels) * size);
+    units.resize(values.size());
+    labs.resize(labs.size() + channels * 3);
+    Resampler resampler(source, wavelengths, Resampler::Sprague);
+    resampler.apply(columns.constData(), values.data() + offset, channels);
+    for (int c = 0; c < channels; ++c) {
+        double* row = values.data() + offset + qsizetype(c) * size;
+        normalize(row);
+        prepare(row, units.data() + offset + qsizetype(c) * size, labs.data() + (qsizetype(entries.size()) * 3));
+        entries.append({ fileName, dataset.name, dataset.indices[c] });
+    }
+    reductionDirty = true;
+    indexes[Rms].reset();
+    indexes[Angle].reset();
+}
+
+void
+SpectralLibrary::clear()
+{
+    entries.clear();
+    values.clear();
+    units.clear();
+    labs.clear();
+    mean.clear();
+    basis.clear();
+    reduced.clear();
+    reductionDirty = true;
+    indexes[Rms].reset();
+    indexes[Angle].reset();
+}
+
+QVector<double>
+SpectralLibrary::spectrum(const SpecFile::Dataset& dataset, int channel) const
+{
+    QVector<double> source = Resampler::grid(dataset);
+    QVector<double> column(source.size());
+    int r = 0;
+    for (auto it = dataset.data.constBegin(); it != dataset.data.constEnd(); ++it, ++r) {
+        column[r] = it.value().value(channel, 0.0);
+    }
+    Resampler resampler(source, wavelengths, Resampler::Sprague);
+    return resampler.apply(column, 1);
+}
+
+QList<SpectralLibrary::Match>
+SpectralLibrary::find(const QVector<double>& spectrum, int k, Metric metric, bool indexed)
+{
+    const int size = wavelengths.size();
+    k = qMin(k, count());
+    if (k <= 0 || spectrum.size() != size) {
+        return QList<Match>();
+    }
+    Query query;
+    query.values = spectrum;
+    query.unit.resize(size);
+    normalize(query.values.data());
+    prepare(query.values.constData(), query.unit.data(), query.lab);
+    if (metric == DeltaE2000 || !indexed) {
+        return scan(query, k, metric);
+    }
+
+    if (metric == Rms && reductionDirty) {
+        reduce();
+    }
+    const bool projected = metric == Rms && !reduced.isEmpty();
+    const int dimensions = projected ? basis.size() / size : size;
+    QSharedPointer<SpectralLibraryIndex>& index = indexes[metric];
+    if (!index) {
+        const double* points = metric == Angle ? units.constData()
+                               : projected     ? reduced.constData()
+                                               : values.constData();
+        index.reset(new SpectralLibraryIndex(points, count(), dimensions, metric == Angle ? angle : euclidean));
+    }
+    SearchHeap candidates;
+    if (projected) {
+        // projected distances never exceed the full ones, a wider candidate set is re-ranked on full spectra
+        QVector<double> scores = project(query.values);
+        index->search(scores.constData(), qMin(count(), k * 4), candidates);
+    }
+    else {
+        index->search(metric == Angle ? query.unit.constData() : query.values.constData(), k, candidates);
+    }
+    SearchHeap heap;
+    while (!candidates.empty()) {
+        const int entry = candidates.top().second;
+        candidates.pop();
+        push(heap, k, distance(query, entry, metric), entry);
+    }
+    QList<Match> matches(heap.size());
+    for (int i = matches.size() - 1; i >= 0; --i, heap.pop()) {
+        matches[i] = { heap.top().second, heap.top().first };
+    }
+    return matches;
+}
+
+void
+SpectralLibrary::normalize(double* spectrum) const
+{
+    if (normalization == Peak) {
+        const double peak = *std::max_element(spectrum, spectrum + wavelengths.size());
+        if (peak > 0.0) {
+            for (int i = 0; i < wavelengths.size(); ++i) {
+                spectrum[i] /= peak;
+            }
+        }
+    }
+}
+
+void
+SpectralLibrary::prepare(const double* spectrum, double* unit, double* lab) const
+{
+    const int size = wavelengths.size();
+    const double norm = std::sqrt(dotProduct(spectrum, spectrum, size));
+    for (int i = 0; i < size; ++i) {
+        unit[i] = norm > 0.0 ? spectrum[i] / norm : 0.0;
+    }
+    // reflectance in percent is common, values above 2 are taken as percent
+    const double scale = size && *std::max_element(spectrum, spectrum + size) > 2.0 ? 0.01 : 1.0;
+    double xyz[3];
+    for (int c = 0; c < 3; ++c) {
+        xyz[c] = scale * dotProduct(weights.constData() + qsizetype(c) * size, spectrum, size);
+    }
+    Colorimetry::lab(xyz, white, lab);
+}
+
+void
+SpectralLibrary::reduce()
+{
+    const int size = wavelengths.size();
+    QVector<const double*> curves;
+    curves.reserve(count());
+    for (int e = 0; e < count(); ++e) {
+        curves.append(spectrum(e));
+    }
+    basis.clear();
+    reduced.clear();
+    reductionDirty = false;
+    if (reducedDimensions <= 0) {
+        return;
+    }
+    Statistics::Components components = Statistics::components(curves, size, reducedDimensions);
+    mean = components.mean;
+    for (const QVector<double>& vector : components.vectors) {
+        basis += vector;
+    }
+    const int dimensions = components.vectors.size();
+    if (!dimensions) {
+        return;
+    }
+    reduced.resize(qsizetype(count()) * dimensions);
+    double* scores = reduced.data();
+    parallel::forEachBlock(count(), parallel::grainSize(count(), 64), [&](int begin, int end) {
+        QVector<double> centered(size);
+        for (int e = begin; e < end; ++e) {
+            const double* row = spectrum(e);
+            for (int i = 0; i < size; ++i) {
+                centered[i] = row[i] - mean[i];
+            }
+            for (int d = 0; d < dimensions; ++d) {
+                scores[qsizetype(e) * dimensions + d]
+                    = dotProduct(basis.constData() + qsizetype(d) * size, centered.constData(), size);
+            }
+        }
+    });
+}
+
+QVector<double>
+SpectralLibrary::project(const QVector<double>& spectrum) const
+{
+    const int size = wavelengths.size();
+    const int dimensions = basis.size() / size;
+    QVector<double> centered(size);
+    for (int i = 0; i < size; ++i) {
+        centered[i] = spectrum[i] - mean[i];
+    }
+    QVector<double> scores(dimensions);
+    for (int d = 0; d < dimensions; ++d) {
+        scores[d] = dotProduct(basis.constData() + qsizetype(d) * size, centered.constData(), size);
+    }
+    return scores;
+}
+
+QList<SpectralLibrary::Match>
+SpectralLibrary::scan(const Query& query, int k, Metric metric) const
+{
+    // each block keeps its own k nearest, the blocks are merged at the end
+    QMutex mutex;
+    SearchHeap heap;
+    parallel::forEachBlock(count(), parallel::grainSize(count(), 256), [&](int begin, int end) {
+        SearchHeap local;
+        for (int e = begin; e < end; ++e) {
+            push(local, k, distance(query, e, metric), e);
+        }
+        QMutexLocker locker(&mutex);
+        while (!local.empty()) {
+            push(heap, k, local.top().first, local.top().second);
+            local.pop();
+        }
+    });
+    QList<Match> matches(heap.size());
+    for (int i = matches.size() - 1; i >= 0; --i, heap.pop()) {
+        matches[i] = { heap.top().second, heap.top().first };
+    }
+    return matches;
+}
+
+double
+SpectralLibrary::distance(const Query& query, int entry, Metric metric) const
+{
+    const int size = wavelengths.size();
+    switch (metric) {
+    case Rms: return std::sqrt(squaredDistance(query.values.constData(), spectrum(entry), size) / size);
+    case Angle:
+        return qRadiansToDegrees(angle(query.unit.constData(), units.constData() + qsizetype(entry) * size, size));
+    case DeltaE2000: return Colorimetry::deltaE2000(query.lab, labs.constData() + qsizetype(entry) * 3);
+    }
+    return 0.0;
+}
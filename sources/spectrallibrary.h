@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "resampler.h"
+#include "specfile.h"
+
+#include <QSharedPointer>
+#include <QVector>
+
+// library of spectra resampled onto one grid and stored as a contiguous matrix, one row per dataset channel, for
+// nearest neighbour queries by rms difference, spectral angle or delta e 2000 under an illuminant. rms and angle
+// queries use a vantage point tree, optionally over principal component scores, and fall back to a brute force
+// scan that is also used for delta e
+class SpectralLibraryIndex;
+class SpectralLibrary {
+public:
+    enum Metric { Rms, Angle, DeltaE2000 };
+    enum Normalization { None, Peak };
+    struct Entry {
+        QString fileName;
+        QString name;
+        QString channel;
+    };
+    struct Match {
+        int entry;
+        double distance;
+    };
+
+    SpectralLibrary(const QVector<double>& grid = Resampler::uniformGrid(380, 780, 5),
+                    Normalization normalization = None);
+    static Metric metric(const QString& name, bool* ok = nullptr);
+    const QVector<double>& grid() const { return wavelengths; }
+
+    // illuminant sampled on grid(), spectra are taken as reflectance for delta e
+    void setIlluminant(const QVector<double>& illuminant);
+    // number of principal components the rms tree is built over, zero for full spectra. queries on reduced spectra
+    // are approximate, candidates are re-ranked on the full spectra
+    void setDimensions(int dimensions);
+    int dimensions() const { return reducedDimensions; }
+
+    bool addFile(const QString& fileName);
+    int addFiles(const QStringList& fileNames);
+    void add(const SpecFile::Dataset& dataset, const QString& fileName);
+    void clear();
+
+    int count() const { return entries.size(); }
+    const Entry& entry(int index) const { return entries[index]; }
+    const double* spectrum(int index) const { return values.constData() + qsizetype(index) * wavelengths.size(); }
+    QVector<double> spectrum(const SpecFile::Dataset& dataset, int channel) const;
+
+    QList<Match> find(const QVector<double>& spectrum, int k, Metric metric = Rms, bool indexed = true);
+
+private:
+    struct Query;
+    void normalize(double* spectrum) const;
+    void prepare(const double* spectrum, double* unit, double* lab) const;
+    void reduce();
+    QVector<double> project(const QVector<double>& spectrum) const;
+    QList<Match> scan(const Query& query, int k, Metric metric) const;
+    double distance(const Query& query, int entry, Metric metric) const;
+    QVector<double> wavelengths;
+    Normalization normalization;
+    QList<Entry> entries;
+    QVector<double> values;  // entries x grid, normalized
+    QVector<double> units;   // entries x grid, unit length for the spectral angle
+    QVector<double> labs;    // entries x 3
+    QVector<double> weights;
+    double white[3];
+    int reducedDimensions;
+    bool reductionDirty;
+    QVector<double> mean;
+    QVector<double> basis;    // dimensions x grid
+    QVector<double> reduced;  // entries x dimensions
+    QSharedPointer<SpectralLibraryIndex> indexes[2];  // rms, angle
+};
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "spectrumring.h"
+
+#include <algorithm>
+
+SpectrumRing::SpectrumRing()
+    : slots(0)
+    , length(0)
+    , size(0)
+    , head(0)
+    , pushed(0)
+{}
+
+void
+SpectrumRing::reset(int capacity, int samples)
+{
+    slots = qMax(0, capacity);
+    length = qMax(0, samples);
+    values.resize(qsizetype(slots) * length);
+    clear();
+}
+
+void
+SpectrumRing::clear()
+{
+    size = 0;
+    head = 0;
+    pushed = 0;
+}
+
+void
+SpectrumRing::push(const double* spectrum)
+{
+    if (slots == 0) {
+        return;
+    }
+    std::copy(spectrum, spectrum + length, values.data() + qsizetype(head) * length);
+    head = (head + 1) % slots;
+    size = qMin(size + 1, slots);
+    ++pushed;
+}
+
+const double*
+SpectrumRing::spectrum(int index) const
+{
+    Q_ASSERT(index >= 0 && index < size);
+    const int slot = (head - size + index + slots) % slots;
+    return values.constData() + qsizetype(slot) * length;
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QVector>
+
+// the most recent spectra of a stream in one contiguous block, sampled on the same grid. pushing copies into the
+// next slot and never allocates, the block is only reallocated when the shape changes
+class SpectrumRing {
+public:
+    SpectrumRing();
+    void reset(int capacity, int samples);
+    void clear();
+    void push(const double* values);
+
+    int capacity() const { return slots; }
+    int samples() const { return length; }
+    int count() const { return size; }
+    qint64 total() const { return pushed; }  // spectra pushed since the last reset
+
+    const double* spectrum(int index) const;  // 0 is the oldest spectrum kept
+    const double* latest() const { return spectrum(size - 1); }
+
+private:
+    QVector<double> values;
+    int slots;
+    int length;
+    int size;
+    int head;  // slot of the next push
+    qint64 pushed;
+};
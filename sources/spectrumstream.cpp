@@ -0,0 +1,437 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "spectrumstream.h"
+
+#include <QByteArrayView>
+#include <QDebug>
+#include <QFile>
+#include <QLocalSocket>
+#include <QMutex>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QTcpSocket>
+#include <QThread>
+
+namespace {
+// shared between the stream and a reader thread, which may outlive the stream while blocked on a silent pipe
+struct StreamBuffer {
+    QMutex mutex;
+    SpectrumRing ring;
+    QVector<double> grid;
+    int history = 256;
+    QAtomicInteger<qint64> total = 0;
+    QAtomicInt stop = 0;
+};
+
+bool
+separator(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r' || c == '\n';
+}
+
+QByteArrayView
+unquoted(QByteArrayView value)
+{
+    value = value.trimmed();
+    if (value.startsWith('"')) {
+        value = value.sliced(1);
+    }
+    if (value.endsWith('"')) {
+        value.chop(1);
+    }
+    return value;
+}
+
+class StreamParser {
+public:
+    StreamParser(const QSharedPointer<StreamBuffer>& buffer)
+        : buffer(buffer)
+    {
+        values.reserve(1024);
+    }
+
+    void feed(QByteArrayView line)
+    {
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            return;
+        }
+        if (line == QByteArrayView("SPECT") || line.startsWith("CGATS")) {
+            record = true;
+            format = data = false;
+            return;
+        }
+        if (record) {
+            cgats(line);
+        }
+        else if (line.startsWith("grid")) {
+            if (numbers(line.sliced(4)) && values.size() == 3 && values[2] > 0.0 && values[1] >= values[0]) {
+                lineGrid = uniform(values[0], values[1], qRound((values[1] - values[0]) / values[2]) + 1);
+                explicitGrid = true;
+            }
+            else {
+                qWarning() << "SpectrumStream: expected grid <start> <end> <step>, got:" << line;
+            }
+        }
+        else if (numbers(line)) {
+            if (!explicitGrid && lineGrid.size() != values.size()) {
+                lineGrid = uniform(380.0, 780.0, values.size());
+            }
+            publish(lineGrid);
+        }
+    }
+
+private:
+    void cgats(QByteArrayView line)
+    {
+        if (format) {
+            format = !line.startsWith("END_DATA_FORMAT");
+        }
+        else if (data) {
+            if (line.startsWith("END_DATA")) {
+                data = record = false;
+            }
+            else if (numbers(line)) {
+                publish(cgatsGrid);
+            }
+        }
+        else if (line.startsWith("BEGIN_DATA_FORMAT")) {
+            format = true;
+        }
+        else if (line.startsWith("BEGIN_DATA")) {
+            data = true;
+            if (cgatsGrid.size() != bands || (bands > 0 && (cgatsGrid.first() != start || cgatsGrid.last() != end))) {
+                cgatsGrid = uniform(start, end, bands);
+            }
+        }
+        else if (line.startsWith("SPECTRAL_BANDS")) {
+            bands = unquoted(line.sliced(14)).toInt();
+        }
+        else if (line.startsWith("SPECTRAL_START_NM")) {
+            start = unquoted(line.sliced(17)).toDouble();
+        }
+        else if (line.startsWith("SPECTRAL_END_NM")) {
+            end = unquoted(line.sliced(15)).toDouble();
+        }
+    }
+
+    bool numbers(QByteArrayView line)
+    {
+        // values keeps its capacity between lines, parsing does not allocate once it fits the longest line
+        qsizetype count = 0;
+        qsizetype i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && separator(line[i])) {
+                ++i;
+            }
+            const qsizetype begin = i;
+            while (i < line.size() && !separator(line[i])) {
+                ++i;
+            }
+            if (i == begin) {
+                break;
+            }
+            bool ok = false;
+            const double value = line.sliced(begin, i - begin).toDouble(&ok);
+            if (!ok) {
+                return false;  // text, such as the summary printed by spotread
+            }
+            if (count == values.size()) {
+                values.resize(count + 1);
+            }
+            values[count++] = value;
+        }
+        values.resize(count);
+        return count > 0;
+    }
+
+    void publish(const QVector<double>& grid)
+    {
+        if (grid.size() != values.size() || grid.size() < 2) {
+            if (!mismatch) {
+                qWarning() << "SpectrumStream: expected" << grid.size() << "values per spectrum, got" << values.size();
+                mismatch = true;
+            }
+            return;
+        }
+        QMutexLocker locker(&buffer->mutex);
+        if (buffer->grid != grid) {
+            buffer->grid = grid;
+            buffer->ring.reset(buffer->history, grid.size());
+        }
+        buffer->ring.push(values.constData());
+        buffer->total.fetchAndAddRelaxed(1);
+    }
+
+    static QVector<double> uniform(double first, double last, qsizetype count)
+    {
+        QVector<double> grid(qMax<qsizetype>(0, count));
+        for (qsizetype i = 0; i < grid.size(); ++i) {
+            grid[i] = count > 1 ? first + (last - first) * i / (count - 1) : first;
+        }
+        return grid;
+    }
+
+    QSharedPointer<StreamBuffer> buffer;
+    QVector<double> values;
+    QVector<double> lineGrid;
+    QVector<double> cgatsGrid;
+    bool explicitGrid = false;
+    bool record = false;
+    bool format = false;
+    bool data = false;
+    bool mismatch = false;
+    int bands = 0;
+    double start = 0.0;
+    double end = 0.0;
+};
+
+// complete lines are fed to the parser, partial lines are kept until the rest arrives
+class LineBuffer {
+public:
+    LineBuffer()
+        : line(4096, '\0')
+        , used(0)
+    {}
+
+    qint64 read(QIODevice* device, StreamParser& parser)
+    {
+        if (used == line.size() - 1) {
+            line.resize(line.size() * 2);  // longer than any line so far
+        }
+        const qint64 n = device->readLine(line.data() + used, line.size() - used);
+        if (n > 0) {
+            used += n;
+            if (line[used - 1] == '\n') {
+                flush(parser);
+            }
+        }
+        return n;
+    }
+
+    void flush(StreamParser& parser)
+    {
+        if (used > 0) {
+            parser.feed(QByteArrayView(line.constData(), used));
+            used = 0;
+        }
+    }
+
+private:
+    QByteArray line;
+    qsizetype used;
+};
+
+// stdin, files and named pipes are read with blocking reads on their own thread
+class StreamReader : public QThread {
+public:
+    StreamReader(const QString& fileName, const QSharedPointer<StreamBuffer>& buffer)
+        : fileName(fileName)
+        , buffer(buffer)
+    {}
+    QString message;
+
+protected:
+    void run() override
+    {
+        QFile file;
+        bool opened = false;
+        if (fileName == "-") {
+            opened = file.open(stdin, QIODevice::ReadOnly);
+        }
+        else {
+            file.setFileName(fileName);
+            opened = file.open(QIODevice::ReadOnly);  // blocks until a writer opens a named pipe
+        }
+        if (!opened) {
+            message = QString("could not open stream: %1").arg(fileName);
+            return;
+        }
+        StreamParser parser(buffer);
+        LineBuffer lines;
+        while (!buffer->stop.loadRelaxed() && lines.read(&file, parser) > 0) {}
+        lines.flush(parser);
+        message = QString("end of stream: %1").arg(fileName);
+    }
+
+private:
+    QString fileName;
+    QSharedPointer<StreamBuffer> buffer;
+};
+}  // namespace
+
+class SpectrumStreamPrivate : public QObject {
+    Q_OBJECT
+public:
+    SpectrumStreamPrivate();
+    ~SpectrumStreamPrivate();
+    void release();
+    void finish(const QString& message);
+
+public Q_SLOTS:
+    void readSocket();
+
+public:
+    QString source;
+    int history;
+    QSharedPointer<StreamBuffer> buffer;
+    QPointer<StreamReader> reader;
+    QPointer<QIODevice> socket;
+    QScopedPointer<StreamParser> parser;
+    LineBuffer lines;
+    QPointer<SpectrumStream> object;
+};
+
+SpectrumStreamPrivate::SpectrumStreamPrivate()
+    : history(256)
+    , buffer(new StreamBuffer())
+{}
+
+SpectrumStreamPrivate::~SpectrumStreamPrivate() { release(); }
+
+void
+SpectrumStreamPrivate::release()
+{
+    buffer->stop.storeRelaxed(1);
+    if (reader) {
+        reader->disconnect(this);
+        reader->wait(100);  // a reader blocked on a silent pipe ends with the writer and deletes itself
+        reader.clear();
+    }
+    if (socket) {
+        socket->disconnect(this);
+        socket->close();
+        socket->deleteLater();
+        socket.clear();
+    }
+    parser.reset();
+    lines = LineBuffer();
+    source.clear();
+}
+
+void
+SpectrumStreamPrivate::finish(const QString& message)
+{
+    if (source.isEmpty()) {
+        return;
+    }
+    release();
+    Q_EMIT object->finished(message);
+}
+
+void
+SpectrumStreamPrivate::readSocket()
+{
+    while (socket && parser && socket->bytesAvailable() > 0) {
+        if (lines.read(socket, *parser) <= 0) {
+            break;
+        }
+    }
+}
+
+#include "spectrumstream.moc"
+
+SpectrumStream::SpectrumStream(QObject* parent)
+    : QObject(parent)
+    , p(new SpectrumStreamPrivate())
+{
+    p->object = this;
+}
+
+SpectrumStream::~SpectrumStream() {}
+
+bool
+SpectrumStream::open(const QString& source)
+{
+    close();
+    p->buffer.reset(new StreamBuffer());
+    p->buffer->history = p->history;
+    if (source.startsWith("tcp://")) {
+        const QString address = source.mid(6);
+        bool ok = false;
+        const quint16 port = address.section(':', -1).toUShort(&ok);
+        if (!ok || !address.contains(':')) {
+            qWarning() << "SpectrumStream: expected tcp://host:port, got:" << source;
+            return false;
+        }
+        QTcpSocket* tcp = new QTcpSocket(p.data());
+        connect(tcp, &QTcpSocket::disconnected, p.data(), [this]() { p->finish("disconnected"); });
+        connect(tcp, &QTcpSocket::errorOccurred, p.data(), [this, tcp]() { p->finish(tcp->errorString()); });
+        p->socket = tcp;
+        tcp->connectToHost(address.section(':', 0, -2), port);
+    }
+    else if (source.startsWith("local:")) {
+        QLocalSocket* local = new QLocalSocket(p.data());
+        connect(local, &QLocalSocket::disconnected, p.data(), [this]() { p->finish("disconnected"); });
+        connect(local, &QLocalSocket::errorOccurred, p.data(), [this, local]() { p->finish(local->errorString()); });
+        p->socket = local;
+        local->connectToServer(source.mid(6));
+    }
+    else {
+        StreamReader* reader = new StreamReader(source, p->buffer);
+        connect(reader, &QThread::finished, reader, &QObject::deleteLater);
+        connect(reader, &QThread::finished, p.data(), [this, reader]() { p->finish(reader->message); });
+        p->reader = reader;
+    }
+    p->source = source;
+    if (p->socket) {
+        p->parser.reset(new StreamParser(p->buffer));
+        connect(p->socket, &QIODevice::readyRead, p.data(), &SpectrumStreamPrivate::readSocket);
+    }
+    else {
+        p->reader->start();
+    }
+    return true;
+}
+
+void
+SpectrumStream::close()
+{
+    if (isOpen()) {
+        p->release();
+    }
+}
+
+bool
+SpectrumStream::isOpen() const
+{
+    return !p->source.isEmpty();
+}
+
+QString
+SpectrumStream::source() const
+{
+    return p->source;
+}
+
+void
+SpectrumStream::setHistory(int count)
+{
+    p->history = qMax(1, count);
+    QMutexLocker locker(&p->buffer->mutex);
+    if (p->buffer->history != p->history) {
+        p->buffer->history = p->history;
+        p->buffer->ring.reset(p->history, p->buffer->grid.size());
+    }
+}
+
+int
+SpectrumStream::history() const
+{
+    return p->history;
+}
+
+qint64
+SpectrumStream::total() const
+{
+    return p->buffer->total.loadRelaxed();
+}
+
+void
+SpectrumStream::read(const std::function<void(const QVector<double>& grid, const SpectrumRing& ring)>& fn) const
+{
+    QMutexLocker locker(&p->buffer->mutex);
+    fn(p->buffer->grid, p->buffer->ring);
+}
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "spectrumring.h"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <functional>
+
+// reads spectra continuously from stdin ("-"), a file or named pipe, a tcp socket ("tcp://host:port") or a local
+// socket ("local:name"). sources write argyll .sp records, or one spectrum per line as numbers separated by spaces,
+// commas or semicolons, optionally preceded by a "grid <start> <end> <step>" line. lines sampled between 380 and
+// 780 nm are assumed otherwise. spectra are kept in a ring buffer that is read with read() at the caller's pace
+class SpectrumStreamPrivate;
+class SpectrumStream : public QObject {
+    Q_OBJECT
+public:
+    SpectrumStream(QObject* parent = nullptr);
+    virtual ~SpectrumStream();
+    bool open(const QString& source);
+    void close();
+    bool isOpen() const;
+    QString source() const;
+
+    void setHistory(int count);
+    int history() const;
+    qint64 total() const;  // spectra received since open
+
+    // calls fn with the grid and the history while the stream is locked, fn should copy what it needs and return
+    void read(const std::function<void(const QVector<double>& grid, const SpectrumRing& ring)>& fn) const;
+
+Q_SIGNALS:
+    void finished(const QString& message);
+
+private:
+    QScopedPointer<SpectrumStreamPrivate> p;
+};
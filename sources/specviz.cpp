@@ -3,23 +3,55 @@
 // https://github.com/mikaelsundell/specviz
 
 #include "specviz.h"
+#include "colorimetry.h"
+#include "curvepipeline.h"
+#include "datasetstore.h"
+#include "dockwidget.h"
+#include "folderwatcher.h"
 #include "icctransform.h"
+#include "instrumentation.h"
+#include "libraryindex.h"
 #include "platform.h"
+#include "plotrenderer.h"
 #include "qcustomplot/qcustomplot.h"
 #include "question.h"
+#include "resampler.h"
+#include "sessionfile.h"
+#include "sessionmatrix.h"
+#include "speccache.h"
+#include "spectralheatmap.h"
+#include "spectrallibrary.h"
+#include "spectrumstream.h"
 #include "specio.h"
+#include "startuptrace.h"
+#include "statistics.h"
 #include "stylesheet.h"
+#include "undocommands.h"
+#include "vectorexport.h"
 #include <QActionGroup>
 #include <QClipboard>
 #include <QColorDialog>
 #include <QDesktopServices>
+#include <QDialogButtonBox>
+#include <QDirIterator>
 #include <QDragEnterEvent>
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
 #include <QMimeData>
 #include <QObject>
 #include <QPointer>
+#include <QPushButton>
 #include <QSettings>
+#include <QSpinBox>
+#include <QStatusBar>
+#include <QTimer>
 #include <QToolButton>
+#include <QUndoStack>
 
 // generated files
 #include "ui_about.h"
@@ -32,6 +64,30 @@ public:
     void init();
     void initPlot();
     bool loadDataset(const QString& filename);
+    void addDataset(const SpecFile::Dataset& ds, const QString& filename, bool resident = true);
+    QTreeWidgetItem* addDerived(const QString& name, const CurvePipeline::Source& input,
+                                const QList<CurvePipeline::Step>& steps);
+    QTreeWidgetItem* datasetItem(int datasetIndex);
+    void addTracer(QCPGraph* graph);
+    void ensureSession();
+    void setGraphData(int datasetIndex);
+    void updateDerived();
+    void updateHeatmap();
+    void updateMemory();
+    void trimDatasets();
+    void showDataset(int datasetIndex, bool visible);
+    void unreadable(int datasetIndex);
+    void recordIndex(QComboBox* combo, int index);
+    void reset();
+    bool restoreSession(const QString& fileName);
+    void restoreNext();
+    void restoreFinished();
+    QCPGraph* addStatisticsGraph(const QString& name, const QPen& pen, QCPAxis* valueAxis, bool tracer);
+    void updateStatistics();
+    bool startStream(const QString& source);
+    void drawStream();
+    void setStreamData(QCPGraph* graph, const QVector<double>& grid, const double* values);
+    static Qt::PenStyle penStyle(int index);
     QCustomPlot* plot();
     QTreeWidget* header();
     QTreeWidget* tree();
@@ -40,13 +96,30 @@ public:
     bool eventFilter(QObject* object, QEvent* event);
     void enable(bool enable);
     void profile();
+    void openArguments();
     void stylesheet();
 
 public Q_SLOTS:
     void open();
+    void browseLibrary();
+    void watchFolder(bool enabled);
+    void datasetChanged(const QString& filename, const SpecFile::Dataset& dataset);
+    void openSession();
+    void saveSession();
+    void openStream(bool enabled);
+    void streamFinished(const QString& message);
+    void updateStream();
     void exportSelected();
+    void exportImage();
     void copyImage();
     void clear();
+    void align(bool enabled);
+    void heatmap(bool enabled);
+    void performance(bool enabled);
+    void updatePerformance();
+    void derive();
+    void findSimilar();
+    void statistics();
     void openAbout();
     void openGithubReadme();
     void openGithubIssues();
@@ -80,12 +153,55 @@ public:
             about->licenses->setText(text);
         }
     };
+    struct BandGraphs {
+        QPointer<QCPGraph> center;
+        QPointer<QCPGraph> lower;
+        QPointer<QCPGraph> upper;
+    };
     struct Data {
         QStringList arguments;
+        QString displayProfile;  // overrides the platform display profile
+        bool argumentsPending = false;
         QStringList extensions;
         QVector<QPointer<QCPItemTracer>> tracers;
-        QList<SpecFile::Dataset> datasets;
+        DatasetStore datasets;  // file names are absolute
+        SessionMatrix session;
+        CurvePipeline pipeline;
+        QVector<int> graphOffsets;  // first graph of each dataset
+        QVector<int> graphCurves;   // session curve of each graph, -1 for derived
+        QVector<QPointer<QCPGraph>> derivedGraphs;
+        QUndoStack undo;
+        bool recording = true;  // user changes are pushed to the undo stack
+        QHash<QTreeWidgetItem*, Qt::CheckState> checkStates;
+        QHash<QComboBox*, int> comboIndices;
+        SessionFile restoring;
+        QVector<int> restoreQueue;  // visible datasets of a restored session not yet read
+        QTimer restoreTimer;
+        QMap<QString, BandGraphs> bandGraphs;  // per channel name
+        QVector<QPointer<QCPGraph>> componentGraphs;
+        QPointer<QCPAxisRect> heatmapRect;
+        QPointer<QCPColorMap> heatmapMap;
+        QScopedPointer<SpectralHeatmap> heatmap;
+        QScopedPointer<SpectralLibrary> library;
+        LibraryIndex libraryIndex;
+        QString libraryDir;
+        FolderWatcher watcher;
+        SpectrumStream stream;
+        QTimer streamTimer;  // caps the frame rate, spectra may arrive much faster than they can be drawn
+        qint64 streamFrame = -1;
+        QPointer<QCPGraph> streamGraph;
+        QVector<QPointer<QCPGraph>> historyGraphs;
+        QTreeWidgetItem* streamItem = nullptr;
         QPointer<QCPItemRect> gradientRect;
+        QElapsedTimer replotTimer;
+        Instrumentation::Histogram* loadTime = nullptr;
+        Instrumentation::Histogram* replotTime = nullptr;
+        Instrumentation::Counter* graphsDrawn = nullptr;
+        Instrumentation::Counter* pointsDrawn = nullptr;
+        Instrumentation::Counter* datasetBytes = nullptr;
+        QPointer<DockWidget> performanceDock;
+        QPointer<QTreeWidget> performanceTree;
+        QTimer performanceTimer;
         QScopedPointer<About> about;
         QScopedPointer<Ui_Specviz> ui;
         QPointer<Specviz> window;
@@ -99,18 +215,36 @@ void
 SpecvizPrivate::init()
 {
     platform::setDarkTheme();
+    // instrumentation
+    Instrumentation* instrumentation = Instrumentation::instance();
+    d.loadTime = instrumentation->histogram("dataset.load");
+    d.replotTime = instrumentation->histogram("plot.replot");
+    d.graphsDrawn = instrumentation->counter("plot.graphs");
+    d.pointsDrawn = instrumentation->counter("plot.points");
+    d.datasetBytes = instrumentation->counter("dataset.bytes");
+    // datasets, samples of hidden datasets are evicted beyond the budget
+    d.datasets.setBudget(settingsValue("memoryBudget", 2048).toLongLong() * 1024 * 1024);
+    // parsed file cache on disk, shared with the command line tools
+    SpecCache::instance()->setBudget(settingsValue("cacheBudget", 1024).toLongLong() * 1024 * 1024);
+    if (!settingsValue("cacheEnabled", true).toBool()) {
+        SpecCache::instance()->setEnabled(false);
+    }
     // icc profile
-    ICCTransform* transform = ICCTransform::instance();
-    QDir resources(platform::getApplicationPath() + "/Resources");
-    QString inputProfile = resources.filePath("sRGB2014.icc");  // built-in Qt input profile
-    transform->setInputProfile(inputProfile);
-    profile();
-    // about
-    d.about.reset(new About(d.window.data()));
-    // ui
-    d.ui.reset(new Ui_Specviz());
-    d.ui->setupUi(d.window.data());
-    initPlot();
+    {
+        StartupTrace::Span span("icc profile");
+        ICCTransform* transform = ICCTransform::instance();
+        QDir resources(platform::getApplicationPath() + "/Resources");
+        QString inputProfile = resources.filePath("sRGB2014.icc");  // built-in Qt input profile
+        transform->setInputProfile(inputProfile);
+        profile();
+    }
+    // ui, the about dialog is created when first opened
+    {
+        StartupTrace::Span span("ui");
+        d.ui.reset(new Ui_Specviz());
+        d.ui->setupUi(d.window.data());
+        initPlot();
+    }
     // tree
     tree()->setHeaderLabels(QStringList() << "Dataset"
                                           << "Display"
@@ -118,6 +252,8 @@ SpecvizPrivate::init()
     tree()->setColumnWidth(0, 160);
     tree()->setColumnWidth(1, 100);
     tree()->header()->setSectionResizeMode(2, QHeaderView::Stretch);
+    tree()->setContextMenuPolicy(Qt::ActionsContextMenu);
+    tree()->addAction(d.ui->editFindSimilar);
     // header
     header()->setHeaderLabels(QStringList() << "Name"
                                             << "Value");
@@ -125,18 +261,73 @@ SpecvizPrivate::init()
     header()->header()->setSectionResizeMode(1, QHeaderView::Stretch);
     // connect
     connect(d.ui->fileOpen, &QAction::triggered, this, &SpecvizPrivate::open);
+    connect(d.ui->fileLibrary, &QAction::triggered, this, &SpecvizPrivate::browseLibrary);
+    connect(d.ui->fileWatch, &QAction::triggered, this, &SpecvizPrivate::watchFolder);
+    connect(&d.watcher, &FolderWatcher::datasetChanged, this, &SpecvizPrivate::datasetChanged);
+    connect(d.ui->fileStream, &QAction::triggered, this, &SpecvizPrivate::openStream);
+    connect(&d.stream, &SpectrumStream::finished, this, &SpecvizPrivate::streamFinished);
+    connect(&d.streamTimer, &QTimer::timeout, this, &SpecvizPrivate::updateStream);
+    connect(d.ui->fileOpenSession, &QAction::triggered, this, &SpecvizPrivate::openSession);
+    connect(d.ui->fileSaveSession, &QAction::triggered, this, &SpecvizPrivate::saveSession);
+    connect(&d.restoreTimer, &QTimer::timeout, this, &SpecvizPrivate::restoreNext);
     connect(d.ui->fileExportSelected, &QAction::triggered, this, &SpecvizPrivate::exportSelected);
+    connect(d.ui->fileExportImage, &QAction::triggered, this, &SpecvizPrivate::exportImage);
+    connect(d.ui->editUndo, &QAction::triggered, &d.undo, &QUndoStack::undo);
+    connect(d.ui->editRedo, &QAction::triggered, &d.undo, &QUndoStack::redo);
+    connect(&d.undo, &QUndoStack::canUndoChanged, d.ui->editUndo, &QAction::setEnabled);
+    connect(&d.undo, &QUndoStack::canRedoChanged, d.ui->editRedo, &QAction::setEnabled);
+    connect(&d.undo, &QUndoStack::undoTextChanged, this,
+            [this](const QString& text) { d.ui->editUndo->setText(text.isEmpty() ? "Undo" : "Undo " + text); });
+    connect(&d.undo, &QUndoStack::redoTextChanged, this,
+            [this](const QString& text) { d.ui->editRedo->setText(text.isEmpty() ? "Redo" : "Redo " + text); });
     connect(d.ui->editCopyImage, &QAction::triggered, this, &SpecvizPrivate::copyImage);
     connect(d.ui->editClear, &QAction::triggered, this, &SpecvizPrivate::clear);
+    connect(d.ui->editClearCache, &QAction::triggered, SpecCache::instance(), &SpecCache::clear);
+    connect(d.ui->editDerive, &QAction::triggered, this, &SpecvizPrivate::derive);
+    connect(d.ui->editFindSimilar, &QAction::triggered, this, &SpecvizPrivate::findSimilar);
+    connect(d.ui->displayAlign, &QAction::toggled, this, &SpecvizPrivate::align);
+    connect(d.ui->displayHeatmap, &QAction::toggled, this, &SpecvizPrivate::heatmap);
+    connect(d.ui->displayPerformance, &QAction::toggled, this, &SpecvizPrivate::performance);
+    connect(&d.performanceTimer, &QTimer::timeout, this, &SpecvizPrivate::updatePerformance);
+    QActionGroup* bands = new QActionGroup(this);
+    for (QAction* action : { d.ui->displayCurves, d.ui->displayDeviation, d.ui->displayPercentiles }) {
+        bands->addAction(action);
+        connect(action, &QAction::triggered, this, &SpecvizPrivate::statistics);
+    }
+    connect(d.ui->displayComponents, &QAction::triggered, this, &SpecvizPrivate::statistics);
+    connect(d.ui->displayHistory, &QAction::triggered, this, [this]() {
+        if (d.streamGraph) {
+            drawStream();
+            updatePlot();
+        }
+    });
     connect(d.ui->helpAbout, &QAction::triggered, this, &SpecvizPrivate::openAbout);
     connect(d.ui->helpGithubReadme, &QAction::triggered, this, &SpecvizPrivate::openGithubReadme);
     connect(d.ui->helpGithubIssues, &QAction::triggered, this, &SpecvizPrivate::openGithubIssues);
+    connect(d.ui->plotWidget, &QCustomPlot::beforeReplot, this, [this]() { d.replotTimer.start(); });
+    connect(d.ui->plotWidget, &QCustomPlot::afterReplot, this, [this]() {
+        d.replotTime->record(d.replotTimer.nsecsElapsed());
+        qint64 graphs = 0;
+        qint64 points = 0;
+        for (int i = 0; i < d.ui->plotWidget->graphCount(); ++i) {
+            QCPGraph* graph = d.ui->plotWidget->graph(i);
+            if (graph->visible()) {
+                ++graphs;
+                points += graph->dataCount();
+            }
+        }
+        d.graphsDrawn->set(graphs);
+        d.pointsDrawn->set(points);
+    });
     connect(d.ui->plotWidget, &QCustomPlot::afterReplot, this, &SpecvizPrivate::updatePlot);
     connect(d.ui->plotWidget, &QCustomPlot::mouseMove, this, &SpecvizPrivate::plotmouseMoveEvent);
     connect(d.ui->treeWidget, &QTreeWidget::itemChanged, this, &SpecvizPrivate::itemChanged);
     connect(d.ui->treeWidget, &QTreeWidget::itemSelectionChanged, this, &SpecvizPrivate::itemSelectionChanged);
     // stylesheet
-    stylesheet();
+    {
+        StartupTrace::Span span("stylesheet");
+        stylesheet();
+    }
 // debug
 #ifdef QT_DEBUG
     QMenu* menu = d.ui->menubar->addMenu("Debug");
@@ -161,6 +352,7 @@ SpecvizPrivate::initPlot()
     d.ui->plotWidget->xAxis->setRange(0.0, 1.0);
     d.ui->plotWidget->yAxis->setRange(0.0, 1.0);
     d.ui->plotWidget->setMouseTracking(true);
+    d.ui->plotWidget->setPlottingHint(QCP::phRasterPolylines, true);
     d.ui->plotWidget->installEventFilter(this);
     d.ui->dataWidget->setVisible(false);
 
@@ -170,16 +362,7 @@ SpecvizPrivate::initPlot()
     d.gradientRect->topLeft->setCoords(380, 0);
     d.gradientRect->bottomRight->setCoords(780, 0);
 
-    QLinearGradient grad(0, 0, 1, 0);
-    grad.setCoordinateMode(QGradient::ObjectBoundingMode);
-    grad.setColorAt(0.0, QColor::fromHslF(0.72, 1.0, 0.5));
-    grad.setColorAt(0.15, QColor::fromHslF(0.66, 1.0, 0.5));
-    grad.setColorAt(0.3, QColor::fromHslF(0.5, 1.0, 0.5));
-    grad.setColorAt(0.55, QColor::fromHslF(0.17, 1.0, 0.5));
-    grad.setColorAt(0.75, QColor::fromHslF(0.0, 1.0, 0.5));
-    grad.setColorAt(1.0, QColor::fromHslF(0.0, 1.0, 0.2));
-
-    d.gradientRect->setBrush(QBrush(grad));
+    d.gradientRect->setBrush(QBrush(PlotRenderer::spectrumGradient()));
     d.gradientRect->setPen(Qt::NoPen);
 
     updatePlot();
@@ -188,23 +371,42 @@ SpecvizPrivate::initPlot()
 bool
 SpecvizPrivate::loadDataset(const QString& filename)
 {
+    Instrumentation::Timer timer(d.loadTime);
     SpecIO spec(filename);
     if (!spec.isLoaded()) {
         return false;
     }
+    addDataset(spec.data(), filename);
+    return true;
+}
 
-    auto ds = spec.data();
-    d.datasets.append(ds);
+void
+SpecvizPrivate::addDataset(const SpecFile::Dataset& ds, const QString& filename, bool resident)
+{
+    // datasets that are not resident only have metadata, their samples are read when first shown
+    if (resident) {
+        d.datasets.append(ds, QFileInfo(filename).absoluteFilePath());
+    }
+    else {
+        d.datasets.appendMetadata(ds, QFileInfo(filename).absoluteFilePath());
+    }
     QTreeWidgetItem* treeItem = new QTreeWidgetItem(tree());
     treeItem->setText(0, ds.name);
 
     QComboBox* combo = new QComboBox(tree());
     combo->addItems({ "Solid", "Dash", "Dot", "Dash dot", "Dash dot dot" });
     tree()->setItemWidget(treeItem, 1, combo);
+    d.comboIndices.insert(combo, combo->currentIndex());
 
     treeItem->setText(2, QFileInfo(filename).fileName());
     treeItem->setCheckState(0, Qt::Checked);
-    treeItem->setData(0, Qt::UserRole, QVariant::fromValue(d.datasets.size() - 1));
+    treeItem->setData(0, Qt::UserRole, QVariant::fromValue(d.datasets.count() - 1));
+
+    int curveOffset = 0;
+    for (int i = 0; i < d.datasets.count() - 1; ++i) {
+        curveOffset += d.datasets.metadata(i).indices.size();
+    }
+    d.graphOffsets.append(d.ui->plotWidget->graphCount());
 
     QVector<int> graphIndices;
     for (int i = 0; i < ds.indices.size(); ++i) {
@@ -213,28 +415,9 @@ SpecvizPrivate::loadDataset(const QString& filename)
         QCPGraph* graph = d.ui->plotWidget->graph(graphIndex);
         graph->setName(ds.indices[i]);
 
-        QColor color;
-        QString idx = ds.indices[i].toUpper();
-        if (idx == "R")
-            color = Qt::red;
-        else if (idx == "G")
-            color = Qt::green;
-        else if (idx == "B")
-            color = Qt::blue;
-        else
-            color = QColor::fromHslF((i * 0.15), 0.7, 0.5);
-
+        QColor color = PlotRenderer::indexColor(ds.indices[i], i);
         graph->setPen(QPen(color, 2));
 
-        QVector<double> x, y;
-        x.reserve(ds.data.size());
-        y.reserve(ds.data.size());
-        for (auto it = ds.data.begin(); it != ds.data.end(); ++it) {
-            x << it.key();
-            y << (i < it.value().size() ? it.value().at(i) : 0.0);
-        }
-        graph->setData(x, y);
-
         QTreeWidgetItem* child = new QTreeWidgetItem(treeItem);
         child->setText(0, ds.indices[i]);
         child->setCheckState(0, Qt::Checked);
@@ -262,57 +445,355 @@ SpecvizPrivate::loadDataset(const QString& filename)
         if (idxColor >= 0) {
             colorCombo->setCurrentIndex(idxColor);
         }
+        d.comboIndices.insert(colorCombo, colorCombo->currentIndex());
 
         connect(colorCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=](int index) {
             QColor c = colorCombo->itemData(index).value<QColor>();
             QPen pen = d.ui->plotWidget->graph(graphIndex)->pen();
             pen.setColor(c);
             d.ui->plotWidget->graph(graphIndex)->setPen(pen);
+            recordIndex(colorCombo, index);
             updatePlot();
         });
 
         tree()->setItemWidget(child, 1, colorCombo);
 
         graphIndices << graphIndex;
+        d.graphCurves.append(curveOffset + i);
+        addTracer(graph);
+    }
 
-        QCPItemTracer* tracer = new QCPItemTracer(d.ui->plotWidget);
-        tracer->setGraph(graph);
-        tracer->setInterpolating(true);
-        tracer->setStyle(QCPItemTracer::tsCircle);
-        tracer->setPen(QPen(Qt::black));
-        tracer->setBrush(Qt::yellow);
-        tracer->setSize(10);
-        tracer->setVisible(false);
-        tracer->setLayer("overlay");
-
-        d.tracers.append(tracer);
+    if (resident) {
+        if (d.ui->displayAlign->isChecked() || d.heatmap || !d.session.grid().isEmpty()) {
+            ensureSession();
+        }
+        setGraphData(d.datasets.count() - 1);
+        updateHeatmap();
+        if (!d.ui->displayCurves->isChecked() || d.ui->displayComponents->isChecked()) {
+            updateStatistics();
+        }
     }
 
     tree()->expandItem(treeItem);
-    tree()->setCurrentItem(treeItem);
+    if (resident) {
+        tree()->setCurrentItem(treeItem);
+    }
 
     connect(combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=](int index) {
-        Qt::PenStyle style = Qt::SolidLine;
-        switch (index) {
-        case 1: style = Qt::DashLine; break;
-        case 2: style = Qt::DotLine; break;
-        case 3: style = Qt::DashDotLine; break;
-        case 4: style = Qt::DashDotDotLine; break;
-        default: style = Qt::SolidLine; break;
-        }
+        Qt::PenStyle style = penStyle(index);
         for (int gi : graphIndices) {
             QPen pen = d.ui->plotWidget->graph(gi)->pen();
             pen.setStyle(style);
             d.ui->plotWidget->graph(gi)->setPen(pen);
         }
+        recordIndex(combo, index);
         updatePlot();
     });
 
+    trimDatasets();
     enable(true);
+}
+
+void
+SpecvizPrivate::addTracer(QCPGraph* graph)
+{
+    // one tracer per graph, tracers and graphs share indices
+    QCPItemTracer* tracer = new QCPItemTracer(d.ui->plotWidget);
+    tracer->setGraph(graph);
+    tracer->setInterpolating(true);
+    tracer->setStyle(QCPItemTracer::tsCircle);
+    tracer->setPen(QPen(Qt::black));
+    tracer->setBrush(Qt::yellow);
+    tracer->setSize(10);
+    tracer->setVisible(false);
+    tracer->setLayer("overlay");
+    d.tracers.append(tracer);
+}
+
+QTreeWidgetItem*
+SpecvizPrivate::datasetItem(int datasetIndex)
+{
+    for (int i = 0; i < tree()->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* item = tree()->topLevelItem(i);
+        if (item->data(0, Qt::UserRole).toInt() == datasetIndex) {
+            return item;
+        }
+    }
+    return nullptr;
+}
+
+void
+SpecvizPrivate::ensureSession()
+{
+    if (d.session.grid().isEmpty()) {
+        d.session.setGrid(Resampler::uniformGrid(360, 830, 1), Resampler::Sprague);
+        d.pipeline.setSession(&d.session);
+    }
+    const int count = d.session.datasetCount();
+    for (int i = count; i < d.datasets.count(); ++i) {
+        bool ok = false;
+        d.session.append(d.datasets.dataset(i, &ok));  // appended regardless, session curves follow dataset indices
+        if (!ok) {
+            unreadable(i);
+        }
+    }
+    if (d.datasets.count() > count) {
+        trimDatasets();  // evicted datasets were read again to be resampled
+    }
+}
+
+void
+SpecvizPrivate::setGraphData(int datasetIndex)
+{
+    bool aligned = d.ui->displayAlign->isChecked() && datasetIndex < d.session.datasetCount();
+    bool ok = true;
+    const SpecFile::Dataset& ds = aligned ? d.datasets.metadata(datasetIndex) : d.datasets.dataset(datasetIndex, &ok);
+    if (!ok) {
+        unreadable(datasetIndex);  // graphs stay empty and are read again when shown
+        return;
+    }
+    QVector<double> x = aligned ? d.session.grid() : Resampler::grid(ds);
+    int first = d.graphOffsets[datasetIndex];
+    for (int i = 0; i < ds.indices.size(); ++i) {
+        QVector<double> y(x.size());
+        if (aligned) {
+            d.session.copyCurves(d.session.curveIndex(datasetIndex, i), 1, y.data());
+        }
+        else {
+            int row = 0;
+            for (auto it = ds.data.constBegin(); it != ds.data.constEnd(); ++it, ++row) {
+                y[row] = it.value().value(i, 0.0);
+            }
+        }
+        d.ui->plotWidget->graph(first + i)->setData(x, y, true);
+    }
+}
+
+void
+SpecvizPrivate::updateDerived()
+{
+    // only curves with changed inputs are evaluated again
+    for (int i = 0; i < d.pipeline.count(); ++i) {
+        if (d.pipeline.isDirty(i) && d.derivedGraphs[i]) {
+            d.derivedGraphs[i]->setData(d.session.grid(), d.pipeline.result(i), true);
+        }
+    }
+}
 
+void
+SpecvizPrivate::updateHeatmap()
+{
+    // session curves are stored one after the other, rows are only appended for curves added since the last update
+    if (!d.heatmap) {
+        return;
+    }
+    ensureSession();
+    const int rows = d.heatmap->rows();
+    const int added = d.session.curveCount() - rows;
+    if (added > 0) {
+        QVector<double> values(qsizetype(added) * d.session.grid().size());
+        d.session.copyCurves(rows, added, values.data());
+        d.heatmap->append(values.constData(), added);
+    }
+}
+
+QCPGraph*
+SpecvizPrivate::addStatisticsGraph(const QString& name, const QPen& pen, QCPAxis* valueAxis, bool tracer)
+{
+    QCPGraph* graph = d.ui->plotWidget->addGraph(d.ui->plotWidget->xAxis, valueAxis);
+    graph->setName(name);
+    graph->setPen(pen);
+    d.graphCurves.append(-1);
+    if (tracer) {
+        addTracer(graph);
+    }
+    else {
+        d.tracers.append(nullptr);
+        graph->removeFromLegend();
+    }
+    return graph;
+}
+
+void
+SpecvizPrivate::updateStatistics()
+{
+    bool bands = !d.ui->displayCurves->isChecked();
+    bool components = d.ui->displayComponents->isChecked();
+    if (bands || components) {
+        ensureSession();
+    }
+    // checked curves grouped by channel name, repeated measurements of a target share channel names
+    QMap<QString, QVector<int>> groups;
+    for (int i = 0; i < tree()->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* item = tree()->topLevelItem(i);
+        if (item->data(0, Qt::UserRole).toInt() < 0) {
+            continue;
+        }
+        for (int c = 0; c < item->childCount(); ++c) {
+            QTreeWidgetItem* child = item->child(c);
+            int graphIndex = child->data(0, Qt::UserRole).toInt();
+            bool checked = child->checkState(0) == Qt::Checked;
+            d.ui->plotWidget->graph(graphIndex)->setVisible(checked && !bands);
+            if (checked && (bands || components)) {
+                groups[child->text(0)].append(d.graphCurves[graphIndex]);
+            }
+        }
+    }
+
+    // bands replace the individual curves, one filled envelope and a center line per channel
+    bool deviation = d.ui->displayDeviation->isChecked();
+    for (auto it = d.bandGraphs.begin(); it != d.bandGraphs.end(); ++it) {
+        for (QCPGraph* graph : { it->center.data(), it->lower.data(), it->upper.data() }) {
+            if (graph) {
+                graph->setVisible(bands && groups.contains(it.key()));
+            }
+        }
+    }
+    for (auto it = groups.constBegin(); bands && it != groups.constEnd(); ++it) {
+        BandGraphs& graphs = d.bandGraphs[it.key()];
+        if (!graphs.center) {
+            QColor color = PlotRenderer::indexColor(it.key(), d.bandGraphs.size() - 1);
+            QColor fill = color;
+            fill.setAlpha(60);
+            graphs.lower = addStatisticsGraph(QString(), QPen(fill, 1), d.ui->plotWidget->yAxis, false);
+            graphs.upper = addStatisticsGraph(QString(), QPen(fill, 1), d.ui->plotWidget->yAxis, false);
+            graphs.upper->setBrush(fill);
+            graphs.upper->setChannelFillGraph(graphs.lower);
+            graphs.center = addStatisticsGraph(it.key(), QPen(color, 2), d.ui->plotWidget->yAxis, true);
+        }
+        Statistics::Bands stats = Statistics::bands(d.session, it.value());
+        QVector<double> lower = stats.lower;
+        QVector<double> upper = stats.upper;
+        if (deviation) {
+            for (int i = 0; i < stats.mean.size(); ++i) {
+                lower[i] = stats.mean[i] - stats.stddev[i];
+                upper[i] = stats.mean[i] + stats.stddev[i];
+            }
+        }
+        graphs.lower->setData(d.session.grid(), lower, true);
+        graphs.upper->setData(d.session.grid(), upper, true);
+        graphs.center->setData(d.session.grid(), deviation ? stats.mean : stats.median, true);
+        graphs.center->setName(QString("%1 %2 (%3 curves)")
+                                   .arg(it.key(), deviation ? "mean" : "median")
+                                   .arg(stats.count));
+    }
+
+    // principal components of all checked curves, unit vectors on the secondary axis
+    QVector<int> curves;
+    for (const QVector<int>& group : groups) {
+        curves += group;
+    }
+    Statistics::Components pca;
+    if (components) {
+        pca = Statistics::components(d.session, curves, 3);
+    }
+    for (int n = 0; n < pca.vectors.size(); ++n) {
+        if (n >= d.componentGraphs.size()) {
+            QColor color = PlotRenderer::indexColor(QString(), n);
+            d.componentGraphs.append(
+                addStatisticsGraph(QString(), QPen(color, 2, Qt::DotLine), d.ui->plotWidget->yAxis2, true));
+        }
+        QCPGraph* graph = d.componentGraphs[n];
+        graph->setName(
+            QString("PC%1 (%2%)").arg(n + 1).arg(100.0 * pca.variances[n] / pca.totalVariance, 0, 'f', 1));
+        graph->setData(d.session.grid(), pca.vectors[n], true);
+    }
+    for (int n = 0; n < d.componentGraphs.size(); ++n) {
+        if (d.componentGraphs[n]) {
+            d.componentGraphs[n]->setVisible(n < pca.vectors.size());
+        }
+    }
+    d.ui->plotWidget->yAxis2->setVisible(!pca.vectors.isEmpty());
+    if (!pca.vectors.isEmpty()) {
+        d.ui->plotWidget->yAxis2->setLabel("principal component");
+        d.ui->plotWidget->yAxis2->rescale(true);
+    }
+}
+
+bool
+SpecvizPrivate::startStream(const QString& source)
+{
+    d.stream.setHistory(settingsValue("streamHistory", 256).toInt());
+    if (!d.stream.open(source)) {
+        return false;
+    }
+    if (!d.streamGraph) {
+        // graphs are kept when the stream closes, later streams draw into the same graphs
+        int graphIndex = d.ui->plotWidget->graphCount();
+        QColor color = PlotRenderer::indexColor(QString(), graphIndex);
+        d.streamGraph = addStatisticsGraph("stream", QPen(color, 2), d.ui->plotWidget->yAxis, true);
+        const int curves = 8;
+        for (int i = 0; i < curves; ++i) {
+            QColor faded = color;
+            faded.setAlphaF(0.6 * (curves - i) / (curves + 1));
+            d.historyGraphs.append(addStatisticsGraph(QString("stream history %1").arg(i + 1), QPen(faded, 1),
+                                                      d.ui->plotWidget->yAxis, false));
+        }
+        d.streamItem = new QTreeWidgetItem(tree());
+        d.streamItem->setText(0, "Stream");
+        d.streamItem->setCheckState(0, Qt::Checked);
+        d.streamItem->setData(0, Qt::UserRole, -1);
+        d.streamItem->setData(0, Qt::UserRole + 1, graphIndex);
+    }
+    d.streamItem->setText(2, source);
+    d.streamFrame = -1;
+    d.streamTimer.start(1000 / qBound(1, settingsValue("streamRate", 30).toInt(), 120));
+    d.ui->fileStream->setChecked(true);
+    d.ui->statusbar->showMessage(QString("Streaming from %1").arg(source));
     return true;
 }
 
+void
+SpecvizPrivate::drawStream()
+{
+    const bool history = d.ui->displayHistory->isChecked() && d.streamGraph->visible();
+    d.stream.read([&](const QVector<double>& grid, const SpectrumRing& ring) {
+        if (ring.count() == 0) {
+            return;
+        }
+        setStreamData(d.streamGraph, grid, ring.latest());
+        // history curves are spread over the whole ring, newest first
+        const int curves = d.historyGraphs.size();
+        const int step = qMax(1, (ring.count() - 1) / qMax(1, curves));
+        for (int i = 0; i < curves; ++i) {
+            const int index = ring.count() - 1 - (i + 1) * step;
+            d.historyGraphs[i]->setVisible(history && index >= 0);
+            if (history && index >= 0) {
+                setStreamData(d.historyGraphs[i], grid, ring.spectrum(index));
+            }
+        }
+    });
+}
+
+void
+SpecvizPrivate::setStreamData(QCPGraph* graph, const QVector<double>& grid, const double* values)
+{
+    // values are written into the existing data points, the container is only rebuilt when the grid changes
+    QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    if (data->size() == grid.size()) {
+        int i = 0;
+        for (auto it = data->begin(); it != data->end(); ++it, ++i) {
+            it->key = grid[i];
+            it->value = values[i];
+        }
+    }
+    else {
+        graph->setData(grid, QVector<double>(values, values + grid.size()), true);
+    }
+}
+
+Qt::PenStyle
+SpecvizPrivate::penStyle(int index)
+{
+    // in the order of the line style combo box
+    switch (index) {
+    case 1: return Qt::DashLine;
+    case 2: return Qt::DotLine;
+    case 3: return Qt::DashDotLine;
+    case 4: return Qt::DashDotDotLine;
+    default: return Qt::SolidLine;
+    }
+}
 
 QTreeWidget*
 SpecvizPrivate::header()
@@ -347,7 +828,11 @@ SpecvizPrivate::eventFilter(QObject* object, QEvent* event)
         for (auto& tracer : d.tracers)
             if (tracer)
                 tracer->setVisible(false);
-        d.ui->plotWidget->replot(QCustomPlot::rpQueuedReplot);
+        d.ui->plotWidget->layer("overlay")->replot();
+    }
+    if (object == d.ui->plotWidget && event->type() == QEvent::Paint && d.argumentsPending) {
+        d.argumentsPending = false;
+        QTimer::singleShot(0, this, &SpecvizPrivate::openArguments);  // files and streams load after the first frame
     }
     if (event->type() == QEvent::ScreenChangeInternal) {
         profile();
@@ -366,17 +851,52 @@ SpecvizPrivate::enable(bool enable)
 void
 SpecvizPrivate::profile()
 {
-    QString outputProfile = platform::getIccProfileUrl(d.window->winId());
+    QString outputProfile = d.displayProfile;
+    if (outputProfile.isEmpty()) {
+        outputProfile = platform::getIccProfileUrl(d.window->winId());
+    }
     // icc profile
     ICCTransform* transform = ICCTransform::instance();
     transform->setOutputProfile(outputProfile);
 }
 
+void
+SpecvizPrivate::openArguments()
+{
+    const QStringList& arguments = d.arguments;
+    for (int i = 0; i < arguments.size(); ++i) {
+        if (arguments[i] == "--stream" && i + 1 < arguments.size()) {
+            startStream(arguments[i + 1]);
+        }
+        if (arguments[i] == "--session" && i + 1 < arguments.size()) {
+            if (restoreSession(arguments[i + 1])) {
+                setSettingsValue("sessionDir", QFileInfo(arguments[i + 1]).absolutePath());
+            }
+        }
+        if (arguments[i] == "--open" && i + 1 < arguments.size()) {
+            QString filename = arguments[i + 1];
+            if (!filename.isEmpty()) {
+                QFileInfo fileInfo(filename);
+                if (d.extensions.contains(fileInfo.suffix().toLower())) {
+                    if (loadDataset(filename)) {
+                        setSettingsValue("openDir", QFileInfo(filename).absolutePath());
+                    }
+                    else {
+                        qWarning() << "Could not load dataset from filename: " << filename;
+                    }
+                    return;
+                }
+            }
+        }
+    }
+}
+
 void
 SpecvizPrivate::stylesheet()
 {
     QString path = platform::getApplicationPath() + "/Resources/App.qss";
     auto ss = Stylesheet::instance();
+    ss->mapPalette();
     if (ss->loadQss(path)) {
         ss->applyQss(ss->compiled());
     }
@@ -387,21 +907,21 @@ SpecvizPrivate::stylesheet()
 
     QColor text = ss->color(Stylesheet::Text);
     QPen axisPen(text);
-    d.ui->plotWidget->xAxis->setBasePen(axisPen);
-    d.ui->plotWidget->yAxis->setBasePen(axisPen);
-    d.ui->plotWidget->xAxis->setTickPen(axisPen);
-    d.ui->plotWidget->yAxis->setTickPen(axisPen);
-    d.ui->plotWidget->xAxis->setSubTickPen(axisPen);
-    d.ui->plotWidget->yAxis->setSubTickPen(axisPen);
-    d.ui->plotWidget->xAxis->setTickLabelColor(text);
-    d.ui->plotWidget->yAxis->setTickLabelColor(text);
-
     QFont labelFont = d.ui->plotWidget->xAxis->labelFont();
     labelFont.setPointSize(11);
-    d.ui->plotWidget->xAxis->setLabelFont(labelFont);
-    d.ui->plotWidget->yAxis->setLabelFont(labelFont);
-    d.ui->plotWidget->xAxis->setLabelColor(text);
-    d.ui->plotWidget->yAxis->setLabelColor(text);
+    QList<QCPAxis*> axes = { d.ui->plotWidget->xAxis, d.ui->plotWidget->yAxis, d.ui->plotWidget->yAxis2 };
+    if (d.heatmapRect) {
+        d.heatmapRect->setBackground(QBrush(base));
+        axes += d.heatmapRect->axes();
+    }
+    for (QCPAxis* axis : axes) {
+        axis->setBasePen(axisPen);
+        axis->setTickPen(axisPen);
+        axis->setSubTickPen(axisPen);
+        axis->setTickLabelColor(text);
+        axis->setLabelFont(labelFont);
+        axis->setLabelColor(text);
+    }
 
     QColor grid = ss->color(Stylesheet::Border);
     QPen gridPen(grid);
@@ -434,6 +954,335 @@ SpecvizPrivate::open()
     }
 }
 
+void
+SpecvizPrivate::browseLibrary()
+{
+    QDialog dialog(d.window.data());
+    dialog.setWindowTitle("Library");
+    dialog.resize(800, 520);
+    QFormLayout* layout = new QFormLayout(&dialog);
+    QLineEdit* directory = new QLineEdit(settingsValue("libraryDir", QDir::homePath()).toString(), &dialog);
+    QToolButton* browse = new QToolButton(&dialog);
+    browse->setText("...");
+    QPushButton* rescan = new QPushButton("Rescan", &dialog);
+    QHBoxLayout* directoryLayout = new QHBoxLayout();
+    directoryLayout->addWidget(directory);
+    directoryLayout->addWidget(browse);
+    directoryLayout->addWidget(rescan);
+    QComboBox* type = new QComboBox(&dialog);
+    QComboBox* originator = new QComboBox(&dialog);
+    QLineEdit* model = new QLineEdit(&dialog);
+    model->setPlaceholderText("Any");
+    QLineEdit* text = new QLineEdit(&dialog);
+    text->setPlaceholderText("Name or file");
+    QSpinBox* start = new QSpinBox(&dialog);
+    QSpinBox* end = new QSpinBox(&dialog);
+    for (QSpinBox* spin : { start, end }) {
+        spin->setRange(0, 2000);
+        spin->setSingleStep(10);
+        spin->setSuffix(" nm");
+        spin->setSpecialValueText("Any");
+    }
+    QHBoxLayout* rangeLayout = new QHBoxLayout();
+    rangeLayout->addWidget(start);
+    rangeLayout->addWidget(end);
+    QLabel* status = new QLabel(&dialog);
+    QTreeWidget* results = new QTreeWidget(&dialog);
+    results->setHeaderLabels({ "Dataset", "Type", "Range", "Indices", "Source" });
+    results->setRootIsDecorated(false);
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    layout->addRow("Library", directoryLayout);
+    layout->addRow("Type", type);
+    layout->addRow("Originator", originator);
+    layout->addRow("Model", model);
+    layout->addRow("Search", text);
+    layout->addRow("Covers", rangeLayout);
+    layout->addRow(results);
+    layout->addRow(status);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    LibraryIndex& index = d.libraryIndex;
+    auto populate = [&]() {
+        for (auto entry : { qMakePair(type, QString("MEAS_TYPE")), qMakePair(originator, QString("ORIGINATOR")) }) {
+            QSignalBlocker blocker(entry.first);
+            QString current = entry.first->currentText();
+            entry.first->clear();
+            entry.first->addItem("Any");
+            entry.first->addItems(index.values(entry.second));
+            entry.first->setCurrentIndex(qMax(0, entry.first->findText(current)));
+        }
+    };
+    auto update = [&]() {
+        // filtering runs over the in memory index, the list is capped to keep large libraries responsive
+        LibraryIndex::Filter filter;
+        filter.header.insert("MEAS_TYPE", type->currentIndex() > 0 ? type->currentText() : QString());
+        filter.header.insert("ORIGINATOR", originator->currentIndex() > 0 ? originator->currentText() : QString());
+        filter.header.insert("model", model->text());
+        filter.text = text->text();
+        filter.start = start->value();
+        filter.end = end->value();
+        QVector<int> matches = index.filter(filter);
+        results->clear();
+        QList<QTreeWidgetItem*> items;
+        for (int i = 0; i < qMin(int(matches.size()), 1000); ++i) {
+            const LibraryIndex::Record& record = index.record(matches[i]);
+            QTreeWidgetItem* item = new QTreeWidgetItem();
+            item->setText(0, record.valid ? record.name : "(unreadable)");
+            item->setText(1, record.header.value("MEAS_TYPE").toString());
+            item->setText(2, record.valid ? QString("%1-%2 nm").arg(record.start).arg(record.end) : QString());
+            item->setText(3, record.indices.join(", "));
+            item->setText(4, record.fileName);
+            item->setData(0, Qt::UserRole, index.filePath(matches[i]));
+            items.append(item);
+        }
+        results->addTopLevelItems(items);
+        status->setText(QString("%1 of %2 files").arg(matches.size()).arg(index.count()));
+    };
+    auto rescanLibrary = [&]() {
+        QString dir = QDir::cleanPath(directory->text());
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        LibraryIndex::Scan scan = index.rescan(dir);
+        index.save(LibraryIndex::defaultFileName(dir));
+        QApplication::restoreOverrideCursor();
+        setSettingsValue("libraryDir", dir);
+        populate();
+        update();
+        status->setText(status->text()
+                        + QString(", %1 added, %2 updated, %3 moved, %4 removed, %5 unreadable")
+                              .arg(scan.added)
+                              .arg(scan.updated)
+                              .arg(scan.moved)
+                              .arg(scan.removed)
+                              .arg(scan.failed));
+    };
+    auto openLibrary = [&]() {
+        QString dir = QDir::cleanPath(QDir(directory->text()).absolutePath());
+        if (index.root() != dir && !index.load(LibraryIndex::defaultFileName(dir))) {
+            index = LibraryIndex();
+        }
+        populate();
+        update();
+    };
+    connect(browse, &QToolButton::clicked, &dialog, [&]() {
+        QString dir = QFileDialog::getExistingDirectory(&dialog, "Select spectral library", directory->text());
+        if (!dir.isEmpty()) {
+            directory->setText(dir);
+            openLibrary();
+        }
+    });
+    connect(rescan, &QPushButton::clicked, &dialog, rescanLibrary);
+    connect(type, QOverload<int>::of(&QComboBox::currentIndexChanged), &dialog, update);
+    connect(originator, QOverload<int>::of(&QComboBox::currentIndexChanged), &dialog, update);
+    connect(model, &QLineEdit::textChanged, &dialog, update);
+    connect(text, &QLineEdit::textChanged, &dialog, update);
+    connect(start, QOverload<int>::of(&QSpinBox::valueChanged), &dialog, update);
+    connect(end, QOverload<int>::of(&QSpinBox::valueChanged), &dialog, update);
+    connect(results, &QTreeWidget::itemDoubleClicked, &dialog, [&](QTreeWidgetItem* item) {
+        loadDataset(item->data(0, Qt::UserRole).toString());
+    });
+    openLibrary();
+    dialog.exec();
+}
+
+void
+SpecvizPrivate::watchFolder(bool enabled)
+{
+    if (!enabled) {
+        d.watcher.setPath(QString());
+        return;
+    }
+    QString dir = QFileDialog::getExistingDirectory(d.window.data(), "Watch folder",
+                                                    settingsValue("watchDir", QDir::homePath()).toString());
+    if (dir.isEmpty()) {
+        d.ui->fileWatch->setChecked(false);
+        return;
+    }
+    setSettingsValue("watchDir", dir);
+    d.watcher.setPath(dir);
+}
+
+void
+SpecvizPrivate::datasetChanged(const QString& filename, const SpecFile::Dataset& dataset)
+{
+    int index = d.datasets.indexOf(filename);
+    if (index < 0 || d.datasets.metadata(index).indices.size() != dataset.indices.size()) {
+        addDataset(dataset, filename);
+        return;
+    }
+    // same channels, graphs and tree items are kept and only their data is replaced
+    d.datasets.replace(index, dataset);
+    QSignalBlocker blockTree(d.ui->treeWidget);
+    for (int i = 0; i < tree()->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* item = tree()->topLevelItem(i);
+        if (item->data(0, Qt::UserRole).toInt() == index) {
+            item->setText(0, dataset.name);
+            break;
+        }
+    }
+    if (index < d.session.datasetCount() && d.session.replace(index, dataset)) {
+        for (int i = 0; i < dataset.indices.size(); ++i) {
+            const int curve = d.session.curveIndex(index, i);
+            d.pipeline.invalidate({ false, curve });
+            if (d.heatmap) {
+                QVector<double> values(d.session.grid().size());
+                d.session.copyCurves(curve, 1, values.data());
+                d.heatmap->replace(curve, values.constData());
+            }
+        }
+        updateDerived();
+    }
+    setGraphData(index);
+    if (!d.ui->displayCurves->isChecked() || d.ui->displayComponents->isChecked()) {
+        updateStatistics();
+    }
+    if (tree()->currentItem() && !tree()->currentItem()->parent()
+        && tree()->currentItem()->data(0, Qt::UserRole).toInt() == index) {
+        itemSelectionChanged();  // header of the reloaded dataset
+    }
+    trimDatasets();
+    updatePlot();
+}
+
+void
+SpecvizPrivate::openSession()
+{
+    QString sessionDir = settingsValue("sessionDir", QDir::homePath()).toString();
+    QString filter = QString("Specviz sessions (*.%1)").arg(SessionFile::extension());
+    QString filename = QFileDialog::getOpenFileName(d.window.data(), "Open session", sessionDir, filter);
+    if (filename.isEmpty()) {
+        return;
+    }
+    if (!d.datasets.isEmpty()
+        && !Question::askQuestion(d.window, "Are you sure you want to replace all datasets with the session?")) {
+        return;
+    }
+    if (restoreSession(filename)) {
+        setSettingsValue("sessionDir", QFileInfo(filename).absolutePath());
+    }
+}
+
+void
+SpecvizPrivate::saveSession()
+{
+    if (d.datasets.isEmpty()) {
+        return;
+    }
+    QString sessionDir = settingsValue("sessionDir", QDir::homePath()).toString();
+    QString filter = QString("Specviz sessions (*.%1)").arg(SessionFile::extension());
+    QString filename = QFileDialog::getSaveFileName(d.window.data(), "Save session", sessionDir, filter);
+    if (filename.isEmpty()) {
+        return;
+    }
+    if (QFileInfo(filename).suffix().isEmpty()) {
+        filename += "." + SessionFile::extension();
+    }
+    // references and display state only, samples stay in their files
+    SessionFile session;
+    for (int i = 0; i < d.datasets.count(); ++i) {
+        QTreeWidgetItem* item = datasetItem(i);
+        QComboBox* combo = item ? qobject_cast<QComboBox*>(tree()->itemWidget(item, 1)) : nullptr;
+        SessionFile::Dataset dataset;
+        dataset.fileName = d.datasets.fileName(i);
+        dataset.metadata = d.datasets.metadata(i);
+        dataset.metadata.data.clear();
+        dataset.style = combo ? combo->currentIndex() : 0;
+        for (int c = 0; c < dataset.metadata.indices.size(); ++c) {
+            SessionFile::Channel channel;
+            channel.color = d.ui->plotWidget->graph(d.graphOffsets[i] + c)->pen().color();
+            channel.visible = item && c < item->childCount() && item->child(c)->checkState(0) == Qt::Checked;
+            dataset.channels.append(channel);
+        }
+        session.datasets.append(dataset);
+    }
+    for (int i = 0; i < d.pipeline.count(); ++i) {
+        SessionFile::Derived derived;
+        derived.name = d.pipeline.name(i);
+        derived.input = d.pipeline.input(i);
+        derived.steps = d.pipeline.steps(i);
+        derived.visible = d.derivedGraphs.value(i) && d.derivedGraphs[i]->visible();
+        session.derived.append(derived);
+    }
+    session.align = d.ui->displayAlign->isChecked();
+    session.heatmap = d.ui->displayHeatmap->isChecked();
+    if (session.save(filename)) {
+        setSettingsValue("sessionDir", QFileInfo(filename).absolutePath());
+    }
+}
+
+void
+SpecvizPrivate::openStream(bool enabled)
+{
+    if (!enabled) {
+        d.stream.close();
+        d.streamTimer.stop();
+        d.ui->statusbar->showMessage("Stream closed", 5000);
+        return;
+    }
+    QDialog dialog(d.window.data());
+    dialog.setWindowTitle("Open stream");
+    QFormLayout* layout = new QFormLayout(&dialog);
+    QLineEdit* source = new QLineEdit(settingsValue("streamSource", "-").toString(), &dialog);
+    source->setToolTip("- for stdin, a file or named pipe, tcp://host:port or local:name");
+    source->setMinimumWidth(320);
+    QSpinBox* history = new QSpinBox(&dialog);
+    history->setRange(2, 100000);
+    history->setValue(settingsValue("streamHistory", 256).toInt());
+    history->setSuffix(" spectra");
+    QSpinBox* rate = new QSpinBox(&dialog);
+    rate->setRange(1, 120);
+    rate->setValue(settingsValue("streamRate", 30).toInt());
+    rate->setSuffix(" fps");
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Open | QDialogButtonBox::Cancel, &dialog);
+    layout->addRow("Source", source);
+    layout->addRow("History", history);
+    layout->addRow("Frame rate", rate);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted || source->text().trimmed().isEmpty()) {
+        d.ui->fileStream->setChecked(false);
+        return;
+    }
+    setSettingsValue("streamSource", source->text().trimmed());
+    setSettingsValue("streamHistory", history->value());
+    setSettingsValue("streamRate", rate->value());
+    if (!startStream(source->text().trimmed())) {
+        d.ui->fileStream->setChecked(false);
+    }
+}
+
+void
+SpecvizPrivate::streamFinished(const QString& message)
+{
+    updateStream();  // spectra received since the last frame
+    d.streamTimer.stop();
+    d.ui->fileStream->setChecked(false);
+    d.ui->statusbar->showMessage(QString("Stream closed, %1").arg(message), 5000);
+}
+
+void
+SpecvizPrivate::updateStream()
+{
+    const qint64 total = d.stream.total();
+    if (!d.streamGraph || total == d.streamFrame) {
+        return;
+    }
+    const bool first = d.streamFrame < 0;
+    d.streamFrame = total;
+    drawStream();
+    bool found = false;
+    QCPRange range = d.streamGraph->getValueRange(found);
+    if (first && d.datasets.isEmpty()) {
+        d.ui->plotWidget->xAxis->setLabel("wavelength (nm)");
+        d.ui->plotWidget->rescaleAxes();
+    }
+    else if (found && range.upper > d.ui->plotWidget->yAxis->range().upper) {
+        d.ui->plotWidget->yAxis->setRangeUpper(range.upper * 1.05);  // grow only, zooming is kept
+    }
+    updatePlot();
+}
+
 void
 SpecvizPrivate::exportSelected()
 {
@@ -446,10 +1295,15 @@ SpecvizPrivate::exportSelected()
     }
 
     int datasetIndex = rootItem->data(0, Qt::UserRole).toInt();
-    if (datasetIndex < 0 || datasetIndex >= d.datasets.size()) {
+    if (datasetIndex < 0 || datasetIndex >= d.datasets.count()) {
+        return;
+    }
+    bool ok = false;
+    const SpecFile::Dataset& ds = d.datasets.dataset(datasetIndex, &ok);
+    if (!ok) {
+        unreadable(datasetIndex);
         return;
     }
-    const SpecFile::Dataset& ds = d.datasets[datasetIndex];
 
     QStringList filters;
     for (const QString& ext : d.extensions) {
@@ -471,6 +1325,38 @@ SpecvizPrivate::exportSelected()
     }
 }
 
+void
+SpecvizPrivate::exportImage()
+{
+    QString saveDir = settingsValue("saveDir", QDir::homePath()).toString();
+    QString filter = "PDF documents (*.pdf);;SVG images (*.svg);;PNG images (*.png)";
+    QString filename = QFileDialog::getSaveFileName(d.window.data(), tr("Export image"), saveDir, filter);
+    if (filename.isEmpty()) {
+        return;
+    }
+    if (QFileInfo(filename).suffix().isEmpty()) {
+        filename += ".pdf";
+    }
+    setSettingsValue("saveDir", QFileInfo(filename).absolutePath());
+    // vector formats at the size of the plot, png at the resolution of the screen
+    QSize size = d.ui->plotWidget->size();
+    bool success = false;
+    if (QFileInfo(filename).suffix().toLower() == "png") {
+        success = d.ui->plotWidget->savePng(filename, size.width(), size.height(),
+                                            d.ui->plotWidget->devicePixelRatioF());
+    }
+    else {
+        VectorExport vectorExport;
+        vectorExport.setSize(size);
+        vectorExport.setTitle(QFileInfo(filename).completeBaseName());
+        vectorExport.setBackground(QBrush(Stylesheet::instance()->color(Stylesheet::Base)));
+        success = vectorExport.write(d.ui->plotWidget, filename);
+    }
+    if (!success) {
+        qWarning() << "failed to export image to:" << filename;
+    }
+}
+
 void
 SpecvizPrivate::copyImage()
 {
@@ -488,30 +1374,577 @@ SpecvizPrivate::copyImage()
 void
 SpecvizPrivate::clear()
 {
-    if (d.datasets.isEmpty()) {
+    if (d.datasets.isEmpty() && !d.streamGraph) {
         return;
     }
 
     if (Question::askQuestion(d.window, "Are you sure you want to remove all datasets and clear the plot?")) {
+        reset();
+    }
+}
+
+void
+SpecvizPrivate::reset()
+{
+    // loading and clearing are not undoable, the stack refers to the items that are removed here
+    QSignalBlocker blockTree(d.ui->treeWidget);
+    QSignalBlocker blockHeader(d.ui->headerWidget);
+
+    d.undo.clear();
+    d.checkStates.clear();
+    d.comboIndices.clear();
+    d.restoreTimer.stop();
+    d.restoreQueue.clear();
+    d.restoring = SessionFile();
+    d.datasets.clear();
+    d.session.setGrid(QVector<double>());
+    d.pipeline.clear();
+    updateMemory();
+    d.graphOffsets.clear();
+    d.graphCurves.clear();
+    d.derivedGraphs.clear();
+    d.bandGraphs.clear();
+    d.componentGraphs.clear();
+    if (d.heatmap) {
+        d.heatmap->clear();  // the session is rebuilt on the same grid
+    }
+    d.stream.close();
+    d.streamTimer.stop();
+    d.streamGraph.clear();
+    d.historyGraphs.clear();
+    d.streamItem = nullptr;
+    d.ui->fileStream->setChecked(false);
+    for (auto& tracer : d.tracers) {
+        if (tracer) {
+            d.ui->plotWidget->removeItem(tracer);
+        }
+    }
+    d.tracers.clear();
+    tree()->clear();
+    header()->clear();
+    d.ui->plotWidget->clearGraphs();
+    d.ui->plotWidget->legend->setVisible(false);
+    d.ui->plotWidget->xAxis->setLabel("");
+    d.ui->plotWidget->yAxis->setLabel("");
+    d.ui->plotWidget->yAxis2->setVisible(false);
+    initPlot();
+
+    enable(false);
+}
+
+void
+SpecvizPrivate::align(bool enabled)
+{
+    // datasets are resampled once, later loads append to the session instead of rebuilding it
+    if (enabled) {
+        ensureSession();
+    }
+    for (int i = 0; i < d.datasets.count(); ++i) {
+        if (d.datasets.isResident(i) || (enabled && i < d.session.datasetCount())) {
+            setGraphData(i);  // evicted datasets get their samples back when shown
+        }
+    }
+    updatePlot();
+}
+
+void
+SpecvizPrivate::updateMemory()
+{
+    // estimate of what the datasets hold, map nodes and the per wavelength vectors
+    qint64 bytes = d.datasets.residentBytes();
+    bytes += d.session.bytes();
+    d.datasetBytes->set(bytes);
+}
+
+void
+SpecvizPrivate::trimDatasets()
+{
+    // graphs of evicted datasets release their samples too, they are set again when the dataset is shown
+    for (int index : d.datasets.trim()) {
+        const int first = d.graphOffsets[index];
+        for (int i = 0; i < d.datasets.metadata(index).indices.size(); ++i) {
+            d.ui->plotWidget->graph(first + i)->data()->clear();
+        }
+    }
+    updateMemory();
+}
+
+void
+SpecvizPrivate::showDataset(int datasetIndex, bool visible)
+{
+    if (visible == d.datasets.isPinned(datasetIndex)) {
+        return;
+    }
+    d.datasets.setPinned(datasetIndex, visible);
+    if (visible) {
+        const int first = d.graphOffsets[datasetIndex];
+        const bool empty = d.ui->plotWidget->graph(first)->data()->isEmpty();
+        if (!d.datasets.metadata(datasetIndex).indices.isEmpty() && empty) {
+            setGraphData(datasetIndex);  // read again if it was evicted
+        }
+    }
+    trimDatasets();
+}
+
+void
+SpecvizPrivate::unreadable(int datasetIndex)
+{
+    d.ui->statusbar->showMessage(QString("Could not read %1").arg(d.datasets.fileName(datasetIndex)), 5000);
+}
+
+void
+SpecvizPrivate::recordIndex(QComboBox* combo, int index)
+{
+    const int previous = d.comboIndices.value(combo, index);
+    d.comboIndices.insert(combo, index);
+    if (d.recording && previous != index) {
+        d.undo.push(new ComboIndexCommand(combo, previous, index, d.recording));
+    }
+}
+
+bool
+SpecvizPrivate::restoreSession(const QString& fileName)
+{
+    SessionFile session;
+    if (!session.load(fileName)) {
+        return false;
+    }
+    reset();
+    // metadata first, the tree and the graphs are set up without reading any dataset file
+    {
         QSignalBlocker blockTree(d.ui->treeWidget);
-        QSignalBlocker blockHeader(d.ui->headerWidget);
-
-        d.datasets.clear();
-        tree()->clear();
-        header()->clear();
-        d.ui->plotWidget->clearGraphs();
-        d.ui->plotWidget->legend->setVisible(false);
-        d.ui->plotWidget->xAxis->setLabel("");
-        d.ui->plotWidget->yAxis->setLabel("");
-        initPlot();
+        for (const SessionFile::Dataset& dataset : session.datasets) {
+            addDataset(dataset.metadata, dataset.fileName, false);
+            const int index = d.datasets.count() - 1;
+            QTreeWidgetItem* item = datasetItem(index);
+            QComboBox* combo = qobject_cast<QComboBox*>(tree()->itemWidget(item, 1));
+            {
+                QSignalBlocker blockCombo(combo);
+                combo->setCurrentIndex(dataset.style);
+                d.comboIndices.insert(combo, combo->currentIndex());
+            }
+            bool shown = false;
+            for (int c = 0; c < item->childCount() && c < dataset.channels.size(); ++c) {
+                const SessionFile::Channel& channel = dataset.channels[c];
+                QCPGraph* graph = d.ui->plotWidget->graph(d.graphOffsets[index] + c);
+                QPen pen = graph->pen();
+                pen.setStyle(penStyle(combo->currentIndex()));
+                if (channel.color.isValid()) {
+                    pen.setColor(channel.color);
+                }
+                graph->setPen(pen);
+                graph->setVisible(channel.visible);
+                QTreeWidgetItem* child = item->child(c);
+                QComboBox* colorCombo = qobject_cast<QComboBox*>(tree()->itemWidget(child, 1));
+                const int colorIndex = colorCombo->findData(pen.color());
+                if (colorIndex >= 0) {
+                    QSignalBlocker blockColor(colorCombo);
+                    colorCombo->setCurrentIndex(colorIndex);
+                    d.comboIndices.insert(colorCombo, colorIndex);
+                }
+                child->setCheckState(0, channel.visible ? Qt::Checked : Qt::Unchecked);
+                d.checkStates.insert(child, child->checkState(0));
+                shown = shown || channel.visible;
+            }
+            item->setCheckState(0, shown ? Qt::Checked : Qt::Unchecked);
+            d.checkStates.insert(item, item->checkState(0));
+            d.datasets.setPinned(index, shown);
+            if (shown) {
+                d.restoreQueue.append(index);
+            }
+        }
+    }
+    d.restoring = session;
+    d.restoreTimer.start(0);
+    return true;
+}
 
-        enable(false);
+void
+SpecvizPrivate::restoreNext()
+{
+    // visible datasets are read a few at a time so that the window stays responsive while a large session loads
+    QElapsedTimer timer;
+    timer.start();
+    while (!d.restoreQueue.isEmpty() && timer.elapsed() < 16) {
+        const int index = d.restoreQueue.takeFirst();
+        const bool empty = d.datasets.metadata(index).indices.isEmpty()
+                           || d.ui->plotWidget->graph(d.graphOffsets[index])->data()->isEmpty();
+        if (d.datasets.isPinned(index) && empty) {
+            setGraphData(index);  // skipped if hidden or shown by the user in the meantime
+        }
     }
+    trimDatasets();
+    if (d.restoreQueue.isEmpty()) {
+        d.restoreTimer.stop();
+        restoreFinished();
+        return;
+    }
+    d.ui->plotWidget->rescaleAxes();
+    updatePlot();
+}
+
+void
+SpecvizPrivate::restoreFinished()
+{
+    // derived curves and the display options need the session matrix, it reads the remaining datasets
+    const SessionFile session = d.restoring;
+    d.restoring = SessionFile();
+    for (const SessionFile::Derived& derived : session.derived) {
+        QTreeWidgetItem* item = addDerived(derived.name, derived.input, derived.steps);
+        if (!derived.visible) {
+            QSignalBlocker blockTree(d.ui->treeWidget);
+            item->setCheckState(0, Qt::Unchecked);
+            d.checkStates.insert(item, Qt::Unchecked);
+            d.derivedGraphs.last()->setVisible(false);
+        }
+    }
+    if (!session.derived.isEmpty()) {
+        updateDerived();
+    }
+    if (d.ui->displayAlign->isChecked() != session.align) {
+        d.ui->displayAlign->setChecked(session.align);
+    }
+    else if (session.align) {
+        align(true);
+    }
+    if (d.ui->displayHeatmap->isChecked() != session.heatmap) {
+        d.ui->displayHeatmap->setChecked(session.heatmap);
+    }
+    else {
+        updateHeatmap();
+    }
+    if (!d.ui->displayCurves->isChecked() || d.ui->displayComponents->isChecked()) {
+        updateStatistics();
+    }
+    if (!tree()->currentItem() && tree()->topLevelItemCount()) {
+        tree()->setCurrentItem(tree()->topLevelItem(0));  // axis labels and header of the first dataset
+    }
+    d.ui->plotWidget->rescaleAxes();
+    updatePlot();
+}
+
+void
+SpecvizPrivate::performance(bool enabled)
+{
+    if (!enabled) {
+        d.performanceTimer.stop();
+        if (d.performanceDock) {
+            d.performanceDock->hide();
+        }
+        return;
+    }
+    if (!d.performanceDock) {
+        d.performanceDock = new DockWidget(d.window);
+        d.performanceDock->setObjectName("performanceDock");
+        d.performanceDock->setWindowTitle("Performance");
+        d.performanceTree = new QTreeWidget(d.performanceDock);
+        d.performanceTree->setRootIsDecorated(false);
+        d.performanceTree->setHeaderLabels(QStringList() << "Metric"
+                                                         << "Count"
+                                                         << "Mean ms"
+                                                         << "p95 ms"
+                                                         << "Max ms");
+        d.performanceTree->setColumnWidth(0, 160);
+        d.performanceDock->setWidget(d.performanceTree);
+        d.window->addDockWidget(Qt::RightDockWidgetArea, d.performanceDock);
+        connect(d.performanceDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+            if (!visible && d.performanceDock->isHidden()) {
+                d.ui->displayPerformance->setChecked(false);
+            }
+        });
+    }
+    d.performanceDock->show();
+    updatePerformance();
+    d.performanceTimer.start(500);
+}
+
+void
+SpecvizPrivate::updatePerformance()
+{
+    Instrumentation* instrumentation = Instrumentation::instance();
+    QTreeWidget* tree = d.performanceTree;
+    QHash<QString, QTreeWidgetItem*> items;
+    for (int i = 0; i < tree->topLevelItemCount(); ++i) {
+        items.insert(tree->topLevelItem(i)->text(0), tree->topLevelItem(i));
+    }
+    auto item = [&](const QString& name) {
+        QTreeWidgetItem* item = items.value(name);
+        if (!item) {
+            item = new QTreeWidgetItem(tree, QStringList() << name);
+            for (int column = 1; column < tree->columnCount(); ++column) {
+                item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+        }
+        return item;
+    };
+    for (const QString& name : instrumentation->counters()) {
+        const qint64 value = instrumentation->counter(name)->value();
+        item(name)->setText(1, name.endsWith(".bytes") ? QLocale().formattedDataSize(value) : QString::number(value));
+    }
+    for (const QString& name : instrumentation->histograms()) {
+        const Instrumentation::Histogram* histogram = instrumentation->histogram(name);
+        const qint64 count = histogram->count();
+        QTreeWidgetItem* row = item(name);
+        row->setText(1, QString::number(count));
+        row->setText(2, QString::number(count > 0 ? histogram->total() / 1e6 / count : 0.0, 'f', 2));
+        row->setText(3, QString::number(histogram->percentile(0.95) / 1e6, 'f', 2));
+        row->setText(4, QString::number(histogram->max() / 1e6, 'f', 2));
+    }
+}
+
+void
+SpecvizPrivate::heatmap(bool enabled)
+{
+    QCustomPlot* plot = d.ui->plotWidget;
+    if (!enabled) {
+        if (d.heatmapRect) {
+            d.heatmap.reset();
+            plot->removePlottable(d.heatmapMap);
+            delete d.heatmapRect->marginGroup(QCP::msLeft);
+            plot->plotLayout()->remove(d.heatmapRect);
+            plot->plotLayout()->simplify();
+        }
+        updatePlot();
+        return;
+    }
+    // measurements over wavelength below the curves, sharing the wavelength range of the plot
+    QCPAxisRect* rect = new QCPAxisRect(plot);
+    plot->plotLayout()->addElement(1, 0, rect);
+    plot->plotLayout()->setRowStretchFactors({ 2.0, 1.0 });
+    QCPMarginGroup* margins = new QCPMarginGroup(plot);
+    plot->axisRect()->setMarginGroup(QCP::msLeft | QCP::msRight, margins);
+    rect->setMarginGroup(QCP::msLeft | QCP::msRight, margins);
+    QCPAxis* wavelength = rect->axis(QCPAxis::atBottom);
+    QCPAxis* measurement = rect->axis(QCPAxis::atLeft);
+    wavelength->setLabel("wavelength (nm)");
+    wavelength->setRange(plot->xAxis->range());
+    measurement->setLabel("measurement");
+    connect(plot->xAxis, qOverload<const QCPRange&>(&QCPAxis::rangeChanged), wavelength,
+            qOverload<const QCPRange&>(&QCPAxis::setRange));
+    QCPColorMap* map = new QCPColorMap(wavelength, measurement);
+    map->setName("heatmap");
+    map->removeFromLegend();
+    d.heatmapRect = rect;
+    d.heatmapMap = map;
+    d.heatmap.reset(new SpectralHeatmap(map));
+    ensureSession();
+    d.heatmap->setGrid(d.session.grid());
+    updateHeatmap();
+    stylesheet();
+    updatePlot();
+}
+
+void
+SpecvizPrivate::derive()
+{
+    if (d.datasets.isEmpty()) {
+        return;
+    }
+    QDialog dialog(d.window.data());
+    dialog.setWindowTitle("Add derived curve");
+    QFormLayout* layout = new QFormLayout(&dialog);
+    QComboBox* input = new QComboBox(&dialog);
+    QComboBox* operation = new QComboBox(&dialog);
+    QComboBox* operand = new QComboBox(&dialog);
+    QComboBox* normalize = new QComboBox(&dialog);
+    for (QComboBox* combo : { input, operand }) {
+        int curve = 0;
+        for (int i = 0; i < d.datasets.count(); ++i) {
+            const SpecFile::Dataset& ds = d.datasets.metadata(i);
+            for (const QString& index : ds.indices) {
+                combo->addItem(QString("%1: %2").arg(ds.name, index));
+                combo->setItemData(combo->count() - 1, curve++, Qt::UserRole);
+                combo->setItemData(combo->count() - 1, false, Qt::UserRole + 1);
+            }
+        }
+        for (int i = 0; i < d.pipeline.count(); ++i) {
+            combo->addItem(d.pipeline.name(i));
+            combo->setItemData(combo->count() - 1, i, Qt::UserRole);
+            combo->setItemData(combo->count() - 1, true, Qt::UserRole + 1);
+        }
+    }
+    operation->addItems({ "None", "Ratio to", "Difference from", "Multiply by illuminant" });
+    normalize->addItems({ "None", "Peak", "560 nm" });
+    connect(operation, QOverload<int>::of(&QComboBox::currentIndexChanged), operand,
+            [=](int index) { operand->setEnabled(index > 0); });
+    operand->setEnabled(false);
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow("Input", input);
+    layout->addRow("Operation", operation);
+    layout->addRow("Operand", operand);
+    layout->addRow("Normalize", normalize);
+    layout->addRow(buttons);
+    if (dialog.exec() != QDialog::Accepted || (operation->currentIndex() == 0 && normalize->currentIndex() == 0)) {
+        return;
+    }
+
+    auto source = [](QComboBox* combo) {
+        CurvePipeline::Source source;
+        source.index = combo->currentData(Qt::UserRole).toInt();
+        source.derived = combo->currentData(Qt::UserRole + 1).toBool();
+        return source;
+    };
+    QList<CurvePipeline::Step> steps;
+    QString name = input->currentText();
+    if (operation->currentIndex() > 0) {
+        static const CurvePipeline::Operation operations[] = { CurvePipeline::Ratio, CurvePipeline::Difference,
+                                                               CurvePipeline::Multiply };
+        static const char* symbols[] = { "/", "-", "*" };
+        steps.append({ operations[operation->currentIndex() - 1], source(operand) });
+        name = QString("%1 %2 %3").arg(name, symbols[operation->currentIndex() - 1], operand->currentText());
+    }
+    if (normalize->currentIndex() > 0) {
+        CurvePipeline::Step step;
+        step.operation = normalize->currentIndex() == 1 ? CurvePipeline::NormalizePeak : CurvePipeline::NormalizeAt;
+        steps.append(step);
+        name = QString("(%1) normalized to %2").arg(name, normalize->currentText().toLower());
+    }
+
+    addDerived(name, source(input), steps);
+    updateDerived();
+    updatePlot();
+}
+
+QTreeWidgetItem*
+SpecvizPrivate::addDerived(const QString& name, const CurvePipeline::Source& input,
+                           const QList<CurvePipeline::Step>& steps)
+{
+    ensureSession();
+    d.pipeline.add(name, input, steps);
+    d.ui->plotWidget->addGraph();
+    int graphIndex = d.ui->plotWidget->graphCount() - 1;
+    QCPGraph* graph = d.ui->plotWidget->graph(graphIndex);
+    graph->setName(name);
+    graph->setPen(QPen(PlotRenderer::indexColor(QString(), graphIndex), 2, Qt::DashLine));
+    d.graphCurves.append(-1);
+    d.derivedGraphs.append(graph);
+    addTracer(graph);
+
+    QTreeWidgetItem* treeItem = new QTreeWidgetItem(tree());
+    treeItem->setText(0, name);
+    treeItem->setText(2, "derived");
+    treeItem->setCheckState(0, Qt::Checked);
+    treeItem->setData(0, Qt::UserRole, -1);
+    treeItem->setData(0, Qt::UserRole + 1, graphIndex);
+    return treeItem;
+}
+
+void
+SpecvizPrivate::findSimilar()
+{
+    // channel of the current item, the first channel when a dataset is selected
+    QTreeWidgetItem* item = tree()->currentItem();
+    QTreeWidgetItem* rootItem = item;
+    while (rootItem && rootItem->parent()) {
+        rootItem = rootItem->parent();
+    }
+    int datasetIndex = rootItem ? rootItem->data(0, Qt::UserRole).toInt() : -1;
+    if (datasetIndex < 0 || datasetIndex >= d.datasets.count()) {
+        return;
+    }
+    // copy, matches can be loaded while the dialog is open
+    bool ok = false;
+    const SpecFile::Dataset ds = d.datasets.dataset(datasetIndex, &ok);
+    if (!ok) {
+        unreadable(datasetIndex);
+        return;
+    }
+    int channel = item->parent() ? rootItem->indexOfChild(item) : 0;
+
+    QDialog dialog(d.window.data());
+    dialog.setWindowTitle(QString("Find similar to %1: %2").arg(ds.name, ds.indices.value(channel)));
+    dialog.resize(640, 400);
+    QFormLayout* layout = new QFormLayout(&dialog);
+    QLineEdit* directory = new QLineEdit(settingsValue("libraryDir", QDir::homePath()).toString(), &dialog);
+    QToolButton* browse = new QToolButton(&dialog);
+    browse->setText("...");
+    QHBoxLayout* directoryLayout = new QHBoxLayout();
+    directoryLayout->addWidget(directory);
+    directoryLayout->addWidget(browse);
+    QComboBox* metric = new QComboBox(&dialog);
+    metric->addItem("RMS difference", SpectralLibrary::Rms);
+    metric->addItem("Spectral angle", SpectralLibrary::Angle);
+    metric->addItem("Delta E 2000", SpectralLibrary::DeltaE2000);
+    QComboBox* illuminant = new QComboBox(&dialog);
+    illuminant->addItems({ "D65", "D50", "A", "E" });
+    QTreeWidget* results = new QTreeWidget(&dialog);
+    results->setHeaderLabels({ "Distance", "Dataset", "Channel", "Source" });
+    results->setRootIsDecorated(false);
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    QPushButton* search = buttons->addButton("Search", QDialogButtonBox::ActionRole);
+    search->setDefault(true);
+    layout->addRow("Library", directoryLayout);
+    layout->addRow("Distance", metric);
+    layout->addRow("Illuminant", illuminant);
+    layout->addRow(results);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(browse, &QToolButton::clicked, &dialog, [&]() {
+        QString dir = QFileDialog::getExistingDirectory(&dialog, "Select spectral library", directory->text());
+        if (!dir.isEmpty()) {
+            directory->setText(dir);
+        }
+    });
+    connect(search, &QPushButton::clicked, &dialog, [&]() {
+        QString dir = QDir::cleanPath(directory->text());
+        if (!d.library || d.libraryDir != dir) {
+            // the library is kept between searches, parsing a large directory dominates a search
+            QStringList filters;
+            for (const QString& ext : d.extensions) {
+                filters.append("*." + ext);
+            }
+            QStringList fileNames;
+            QDirIterator it(dir, filters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                fileNames.append(it.next());
+            }
+            fileNames.sort();
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            d.library.reset(new SpectralLibrary());
+            d.library->addFiles(fileNames);
+            QApplication::restoreOverrideCursor();
+            d.libraryDir = dir;
+            setSettingsValue("libraryDir", dir);
+        }
+        d.library->setIlluminant(Colorimetry::illuminant(illuminant->currentText(), d.library->grid()));
+        auto matches = d.library->find(d.library->spectrum(ds, channel), 20,
+                                       SpectralLibrary::Metric(metric->currentData().toInt()));
+        results->clear();
+        for (const SpectralLibrary::Match& match : matches) {
+            const SpectralLibrary::Entry& entry = d.library->entry(match.entry);
+            QTreeWidgetItem* result = new QTreeWidgetItem(results);
+            result->setText(0, QString::number(match.distance, 'f', 4));
+            result->setText(1, entry.name);
+            result->setText(2, entry.channel);
+            result->setText(3, QFileInfo(entry.fileName).fileName());
+            result->setToolTip(3, entry.fileName);
+            result->setData(0, Qt::UserRole, entry.fileName);
+        }
+    });
+    connect(results, &QTreeWidget::itemDoubleClicked, &dialog, [&](QTreeWidgetItem* result) {
+        loadDataset(result->data(0, Qt::UserRole).toString());
+    });
+    dialog.exec();
+}
+
+void
+SpecvizPrivate::statistics()
+{
+    if (d.datasets.isEmpty()) {
+        return;
+    }
+    updateStatistics();
+    updatePlot();
 }
 
 void
 SpecvizPrivate::openAbout()
 {
+    if (!d.about) {
+        d.about.reset(new About(d.window.data()));
+    }
     d.about->exec();
 }
 
@@ -552,8 +1985,8 @@ SpecvizPrivate::plotmouseMoveEvent(QMouseEvent* event)
     }
     if (rootItem) {
         int datasetIndex = rootItem->data(0, Qt::UserRole).toInt();
-        if (datasetIndex >= 0 && datasetIndex < d.datasets.size()) {
-            message = d.datasets[datasetIndex].name;
+        if (datasetIndex >= 0 && datasetIndex < d.datasets.count()) {
+            message = d.datasets.metadata(datasetIndex).name;
         }
     }
     if (d.ui->trace->isChecked()) {
@@ -570,34 +2003,81 @@ SpecvizPrivate::plotmouseMoveEvent(QMouseEvent* event)
             tracer->setGraph(graph);
             tracer->setGraphKey(x);
             tracer->setVisible(true);
+            tracer->updatePosition();
 
             double y = tracer->position->value();
+            int curve = i < d.graphCurves.size() ? d.graphCurves[i] : -1;
+            if (d.ui->displayAlign->isChecked() && curve >= 0 && curve < d.session.curveCount()) {
+                y = d.session.value(curve, d.session.gridIndex(x));
+            }
             traceMsg += QString("  %1: %2, %3").arg(graph->name()).arg(x, 0, 'f', 2).arg(y, 0, 'f', 3);
         }
         if (!traceMsg.isEmpty()) {
             message += " " + traceMsg;
         }
     }
-    d.ui->plotWidget->replot(QCustomPlot::rpQueuedReplot);
+    d.ui->plotWidget->layer("overlay")->replot();  // tracers only, graph and axis layers are kept
     d.ui->dataset->setText(message.trimmed());
 }
 
 void
 SpecvizPrivate::itemChanged(QTreeWidgetItem* item, int column)
 {
-    if (!item->parent()) {
-        Qt::CheckState rootState = item->checkState(0);
-        for (int i = 0; i < item->childCount(); ++i) {
-            QTreeWidgetItem* child = item->child(i);
-            child->setCheckState(0, rootState);
+    // check states of new items are checked, only changes made by the user are recorded
+    const Qt::CheckState state = item->checkState(0);
+    const Qt::CheckState previous = d.checkStates.value(item, Qt::Checked);
+    const bool record = d.recording && state != previous;
+    d.checkStates.insert(item, state);
+    if (!item->parent() && item->data(0, Qt::UserRole).toInt() < 0) {
+        if (record) {
+            d.undo.push(new CheckStateCommand(item, previous, state, d.recording));
+        }
+        int graphIndex = item->data(0, Qt::UserRole + 1).toInt();
+        if (graphIndex >= 0 && graphIndex < d.ui->plotWidget->graphCount()) {
+            d.ui->plotWidget->graph(graphIndex)->setVisible(item->checkState(0) == Qt::Checked);
+        }
+        if (item == d.streamItem) {
+            drawStream();  // history follows the stream
+        }
+    }
+    else if (!item->parent()) {
+        // channels follow the dataset, one undo step for the dataset and its channels when recorded. undo and redo
+        // restore every channel through its own command, following there would overwrite their previous states
+        if (record) {
+            d.undo.beginMacro(QString("%1 %2").arg(state == Qt::Checked ? "Show" : "Hide", item->text(0)));
+            d.undo.push(new CheckStateCommand(item, previous, state, d.recording));
+        }
+        if (d.recording) {
+            for (int i = 0; i < item->childCount(); ++i) {
+                QTreeWidgetItem* child = item->child(i);
+                child->setCheckState(0, state);
+            }
+        }
+        if (record) {
+            d.undo.endMacro();
         }
     }
     else {
+        if (record) {
+            d.undo.push(new CheckStateCommand(item, previous, state, d.recording));
+        }
         bool visible = (item->checkState(0) == Qt::Checked);
         int graphIndex = item->data(0, Qt::UserRole).toInt();
         if (graphIndex >= 0 && graphIndex < d.ui->plotWidget->graphCount()) {
             d.ui->plotWidget->graph(graphIndex)->setVisible(visible);
         }
+        QTreeWidgetItem* rootItem = item->parent();
+        int datasetIndex = rootItem->data(0, Qt::UserRole).toInt();
+        if (datasetIndex >= 0 && datasetIndex < d.datasets.count()) {
+            bool shown = false;
+            for (int i = 0; i < rootItem->childCount() && !shown; ++i) {
+                shown = rootItem->child(i)->checkState(0) == Qt::Checked;
+            }
+            showDataset(datasetIndex, shown);
+        }
+        if (!d.ui->displayCurves->isChecked() || d.ui->displayComponents->isChecked()) {
+            updateStatistics();  // bands and components follow the checked curves
+        }
     }
     updatePlot();
 }
@@ -611,7 +2091,10 @@ SpecvizPrivate::itemSelectionChanged()
     }
 
     int datasetIndex = rootItem->data(0, Qt::UserRole).toInt();
-    const auto& ds = d.datasets[datasetIndex];
+    if (datasetIndex < 0 || datasetIndex >= d.datasets.count()) {
+        return;  // derived curves have no header
+    }
+    const auto& ds = d.datasets.metadata(datasetIndex);
 
     header()->clear();
     QTreeWidgetItem* headerItem = new QTreeWidgetItem(header());
@@ -653,22 +2136,29 @@ Specviz::setArguments(const QStringList& arguments)
 {
     p->d.arguments = arguments;
     for (int i = 0; i < arguments.size(); ++i) {
-        if (arguments[i] == "--open" && i + 1 < arguments.size()) {
-            QString filename = arguments[i + 1];
-            if (!filename.isEmpty()) {
-                QFileInfo fileInfo(filename);
-                if (p->d.extensions.contains(fileInfo.suffix().toLower())) {
-                    if (p->loadDataset(filename)) {
-                        p->setSettingsValue("openDir", QFileInfo(filename).absolutePath());
-                    }
-                    else {
-                        qWarning() << "Could not load dataset from filename: " << filename;
-                    }
-                    return;
-                }
-            }
+        if (arguments[i] == "--icc-profile" && i + 1 < arguments.size()) {
+            p->d.displayProfile = QFileInfo(arguments[i + 1]).absoluteFilePath();
+            p->profile();
+        }
+        if (arguments[i] == "--memory-budget" && i + 1 < arguments.size()) {
+            p->d.datasets.setBudget(arguments[i + 1].toLongLong() * 1024 * 1024);  // in MB
+        }
+        if (arguments[i] == "--cache-budget" && i + 1 < arguments.size()) {
+            SpecCache::instance()->setBudget(arguments[i + 1].toLongLong() * 1024 * 1024);  // in MB
+        }
+        if (arguments[i] == "--clear-cache") {
+            SpecCache::instance()->clear();
+        }
+        if (arguments[i] == "--no-cache") {
+            SpecCache::instance()->setEnabled(false);
         }
     }
+    if (isVisible()) {
+        p->openArguments();
+    }
+    else {
+        p->d.argumentsPending = true;
+    }
 }
 
 void
@@ -679,7 +2169,7 @@ Specviz::dragEnterEvent(QDragEnterEvent* event)
         for (const QUrl& url : urls) {
             QString filename = url.toLocalFile();
             QString extension = QFileInfo(filename).suffix().toLower();
-            if (p->d.extensions.contains(extension)) {
+            if (p->d.extensions.contains(extension) || extension == SessionFile::extension()) {
                 event->acceptProposedAction();
                 return;
             }
@@ -695,6 +2185,12 @@ Specviz::dropEvent(QDropEvent* event)
     for (const QUrl& url : urls) {
         QString filename = url.toLocalFile();
         QString extension = QFileInfo(filename).suffix().toLower();
+        if (extension == SessionFile::extension()) {
+            if (p->restoreSession(filename)) {
+                p->setSettingsValue("sessionDir", QFileInfo(filename).absolutePath());
+            }
+            return;  // a session replaces everything else that was dropped
+        }
         if (p->d.extensions.contains(extension)) {
             if (p->loadDataset(filename)) {
                 p->setSettingsValue("openDir", QFileInfo(filename).absolutePath());
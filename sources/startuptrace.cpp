@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "startuptrace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QPointer>
+#include <QTextStream>
+#include <QTimer>
+#include <QWidget>
+
+namespace {
+struct Trace {
+    Trace() { process.start(); }
+    QElapsedTimer process;  // started during static initialization, before main
+    bool enabled = false;
+    int budget = 0;
+};
+Trace trace;
+
+void
+write(const char* name, qint64 nsecs)
+{
+    QTextStream(stderr) << QString("specviz: startup %1 %2 ms (at %3 ms)\n")
+                               .arg(QLatin1String(name), -16)
+                               .arg(nsecs / 1e6, 0, 'f', 2)
+                               .arg(trace.process.nsecsElapsed() / 1e6, 0, 'f', 2);
+}
+
+class FirstFrame : public QObject {
+public:
+    FirstFrame(QWidget* window)
+        : QObject(window)
+    {}
+
+    bool eventFilter(QObject* object, QEvent* event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            object->removeEventFilter(this);
+            // the frame reaches the screen once the backing store is flushed after the paint
+            QTimer::singleShot(0, this, [this]() {
+                const qint64 elapsed = trace.process.nsecsElapsed();
+                write("first frame", elapsed);
+                if (trace.budget > 0 && elapsed / 1000000 > trace.budget) {
+                    qWarning() << "StartupTrace: first frame after" << elapsed / 1000000 << "ms, budget is"
+                               << trace.budget << "ms";
+                }
+                deleteLater();
+            });
+        }
+        return false;
+    }
+};
+}  // namespace
+
+StartupTrace::Span::Span(const char* name)
+    : name(name)
+{
+    if (trace.enabled) {
+        timer.start();
+    }
+}
+
+StartupTrace::Span::~Span()
+{
+    if (trace.enabled) {
+        write(name, timer.nsecsElapsed());
+    }
+}
+
+void
+StartupTrace::setEnabled(bool enabled)
+{
+    trace.enabled = enabled;
+}
+
+bool
+StartupTrace::isEnabled()
+{
+    return trace.enabled;
+}
+
+void
+StartupTrace::setBudget(int msecs)
+{
+    trace.budget = msecs;
+}
+
+void
+StartupTrace::mark(const char* name)
+{
+    if (trace.enabled) {
+        write(name, trace.process.nsecsElapsed());
+    }
+}
+
+void
+StartupTrace::watchFirstFrame(QWidget* window)
+{
+    if (trace.enabled) {
+        window->installEventFilter(new FirstFrame(window));
+    }
+}
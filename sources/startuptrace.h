@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QElapsedTimer>
+
+class QWidget;
+
+// startup spans written to stderr with --trace-startup, times are relative to when the process was loaded. the
+// first painted frame of the watched window closes the trace and is compared to the budget if one is set
+class StartupTrace {
+public:
+    class Span {
+    public:
+        Span(const char* name);
+        ~Span();
+
+    private:
+        const char* name;
+        QElapsedTimer timer;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    static void setBudget(int msecs);
+    static void mark(const char* name);
+    static void watchFirstFrame(QWidget* window);
+};
@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "statistics.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+const int tileSize = 32;
+
+template<typename T>
+QVector<const T*>
+sessionCurves(const SessionMatrix& session, const QVector<int>& curves)
+{
+    QVector<const T*> pointers;
+    pointers.reserve(curves.size());
+    for (int curve : curves) {
+        if constexpr (std::is_same_v<T, float>) {
+            pointers.append(session.curveFloat(curve));
+        }
+        else {
+            pointers.append(session.curve(curve));
+        }
+    }
+    return pointers;
+}
+
+template<typename T>
+double
+percentile(T* values, int count, double p)
+{
+    // linear interpolation between closest ranks, values are partially reordered
+    const double h = (count - 1) * qBound(0.0, p, 100.0) / 100.0;
+    const int lo = int(std::floor(h));
+    std::nth_element(values, values + lo, values + count);
+    if (lo + 1 >= count) {
+        return values[lo];
+    }
+    const double next = *std::min_element(values + lo + 1, values + count);
+    return values[lo] + (h - lo) * (next - values[lo]);
+}
+
+double
+dot(const QVector<double>& a, const QVector<double>& b)
+{
+    double sum = 0.0;
+    for (int i = 0; i < a.size(); ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void
+orthogonalize(QVector<double>& v, const QVector<QVector<double>>& vectors)
+{
+    for (const QVector<double>& u : vectors) {
+        const double projection = dot(v, u);
+        for (int i = 0; i < v.size(); ++i) {
+            v[i] -= projection * u[i];
+        }
+    }
+}
+
+// float32 curves are read and selected as floats, moments are accumulated in double
+template<typename T>
+Statistics::Bands
+computeBands(const QVector<const T*>& curves, int size, double lower, double upper)
+{
+    Statistics::Bands bands;
+    const int count = curves.size();
+    if (!count || !size) {
+        return bands;
+    }
+    bands.count = count;
+    bands.mean.resize(size);
+    bands.stddev.resize(size);
+    bands.lower.resize(size);
+    bands.median.resize(size);
+    bands.upper.resize(size);
+    double* means = bands.mean.data();
+    double* stddevs = bands.stddev.data();
+    double* lowers = bands.lower.data();
+    double* medians = bands.median.data();
+    double* uppers = bands.upper.data();
+    parallel::forEachBlock(size, parallel::grainSize(size, 16), [&](int begin, int end) {
+        const int width = end - begin;
+        QVector<T> columns(qsizetype(width) * count);  // wavelength major for the selection
+        QVector<double> mean(width, 0.0);
+        QVector<double> m2(width, 0.0);
+        // one streaming pass over each curve segment, welford keeps the moments stable for large counts
+        for (int k = 0; k < count; ++k) {
+            const T* curve = curves[k] + begin;
+            for (int i = 0; i < width; ++i) {
+                const T x = curve[i];
+                const double delta = x - mean[i];
+                mean[i] += delta / (k + 1);
+                m2[i] += delta * (x - mean[i]);
+                columns[qsizetype(i) * count + k] = x;
+            }
+        }
+        for (int i = 0; i < width; ++i) {
+            T* column = columns.data() + qsizetype(i) * count;
+            means[begin + i] = mean[i];
+            stddevs[begin + i] = count > 1 ? std::sqrt(m2[i] / (count - 1)) : 0.0;
+            lowers[begin + i] = percentile(column, count, lower);
+            medians[begin + i] = percentile(column, count, 50.0);
+            uppers[begin + i] = percentile(column, count, upper);
+        }
+    });
+    return bands;
+}
+
+// centered curves keep the input precision, the products are accumulated in double
+template<typename T>
+QVector<double>
+computeCovariance(const QVector<const T*>& curves, int size, QVector<double>* mean)
+{
+    const int count = curves.size();
+    QVector<double> average(size, 0.0);
+    QVector<T> centered(qsizetype(count) * size);
+    double* averages = average.data();
+    T* values = centered.data();
+    parallel::forEachBlock(size, parallel::grainSize(size, 16), [&](int begin, int end) {
+        for (int k = 0; k < count; ++k) {
+            const T* curve = curves[k];
+            for (int i = begin; i < end; ++i) {
+                averages[i] += (curve[i] - averages[i]) / (k + 1);
+            }
+        }
+    });
+    parallel::forEachBlock(count, parallel::grainSize(count, 8), [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            const T* curve = curves[k];
+            T* z = values + qsizetype(k) * size;
+            for (int i = 0; i < size; ++i) {
+                z[i] = T(curve[i] - averages[i]);
+            }
+        }
+    });
+    if (mean) {
+        *mean = average;
+    }
+
+    QVector<double> matrix(qsizetype(size) * size, 0.0);
+    if (count < 2) {
+        return matrix;
+    }
+    // upper triangle in tiles that stay in cache while all curves stream past, one row of tiles per task
+    double* c = matrix.data();
+    const int tiles = (size + tileSize - 1) / tileSize;
+    parallel::forEachBlock(tiles, 1, [&](int begin, int end) {
+        double block[tileSize][tileSize];
+        for (int ti = begin; ti < end; ++ti) {
+            const int i0 = ti * tileSize;
+            const int i1 = qMin(size, i0 + tileSize);
+            for (int tj = ti; tj < tiles; ++tj) {
+                const int j0 = tj * tileSize;
+                const int j1 = qMin(size, j0 + tileSize);
+                std::fill(&block[0][0], &block[0][0] + tileSize * tileSize, 0.0);
+                for (int k = 0; k < count; ++k) {
+                    const T* z = values + qsizetype(k) * size;
+                    for (int i = i0; i < i1; ++i) {
+                        const double zi = z[i];
+                        double* row = block[i - i0];
+                        for (int j = j0; j < j1; ++j) {
+                            row[j - j0] += zi * z[j];
+                        }
+                    }
+                }
+                for (int i = i0; i < i1; ++i) {
+                    for (int j = qMax(i, j0); j < j1; ++j) {
+                        const double value = block[i - i0][j - j0] / (count - 1);
+                        c[qsizetype(i) * size + j] = value;
+                        c[qsizetype(j) * size + i] = value;
+                    }
+                }
+            }
+        }
+    });
+    return matrix;
+}
+
+template<typename T>
+Statistics::Components
+computeComponents(const QVector<const T*>& curves, int size, int count)
+{
+    Statistics::Components components;
+    if (curves.size() < 2 || !size) {
+        return components;
+    }
+    const QVector<double> matrix = computeCovariance(curves, size, &components.mean);
+    for (int i = 0; i < size; ++i) {
+        components.totalVariance += matrix[qsizetype(i) * size + i];
+    }
+    const double* c = matrix.constData();
+    const double epsilon = 1e-12 * qMax(1.0, components.totalVariance);
+    count = qMin(count, qMin(size, int(curves.size()) - 1));
+    QVector<double> v(size);
+    QVector<double> w(size);
+    for (int n = 0; n < count; ++n) {
+        // power iteration kept orthogonal to earlier components, which deflates them out of the spectrum
+        for (int i = 0; i < size; ++i) {
+            v[i] = 1.0 + 0.01 * ((i * 7919) % 101);
+        }
+        orthogonalize(v, components.vectors);
+        double norm = std::sqrt(dot(v, v));
+        if (norm <= 0.0) {
+            break;
+        }
+        for (double& value : v) {
+            value /= norm;
+        }
+        double variance = 0.0;
+        for (int iteration = 0; iteration < 1000; ++iteration) {
+            const double* x = v.constData();
+            double* y = w.data();
+            parallel::forEachBlock(size, parallel::grainSize(size, 64), [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    const double* row = c + qsizetype(i) * size;
+                    double sum = 0.0;
+                    for (int j = 0; j < size; ++j) {
+                        sum += row[j] * x[j];
+                    }
+                    y[i] = sum;
+                }
+            });
+            orthogonalize(w, components.vectors);
+            variance = std::sqrt(dot(w, w));
+            if (variance <= epsilon) {
+                break;
+            }
+            double change = 0.0;
+            for (int i = 0; i < size; ++i) {
+                w[i] /= variance;
+                change += (w[i] - v[i]) * (w[i] - v[i]);
+            }
+            std::swap(v, w);
+            if (change < 1e-20) {
+                break;
+            }
+        }
+        if (variance <= epsilon) {
+            break;  // remaining curves add no variance
+        }
+        // sign is arbitrary, keep components mostly positive so they read the same between runs
+        double sum = 0.0;
+        for (double value : v) {
+            sum += value;
+        }
+        if (sum < 0.0) {
+            for (double& value : v) {
+                value = -value;
+            }
+        }
+        components.vectors.append(v);
+        components.variances.append(variance);
+    }
+    return components;
+}
+}  // namespace
+
+Statistics::Bands
+Statistics::bands(const SessionMatrix& session, const QVector<int>& curves, double lower, double upper)
+{
+    if (session.precision() == SpecFile::Float32) {
+        return bands(sessionCurves<float>(session, curves), session.grid().size(), lower, upper);
+    }
+    return bands(sessionCurves<double>(session, curves), session.grid().size(), lower, upper);
+}
+
+Statistics::Bands
+Statistics::bands(const QVector<const double*>& curves, int size, double lower, double upper)
+{
+    return computeBands(curves, size, lower, upper);
+}
+
+Statistics::Bands
+Statistics::bands(const QVector<const float*>& curves, int size, double lower, double upper)
+{
+    return computeBands(curves, size, lower, upper);
+}
+
+QVector<double>
+Statistics::covariance(const SessionMatrix& session, const QVector<int>& curves, QVector<double>* mean)
+{
+    if (session.precision() == SpecFile::Float32) {
+        return covariance(sessionCurves<float>(session, curves), session.grid().size(), mean);
+    }
+    return covariance(sessionCurves<double>(session, curves), session.grid().size(), mean);
+}
+
+QVector<double>
+Statistics::covariance(const QVector<const double*>& curves, int size, QVector<double>* mean)
+{
+    return computeCovariance(curves, size, mean);
+}
+
+QVector<double>
+Statistics::covariance(const QVector<const float*>& curves, int size, QVector<double>* mean)
+{
+    return computeCovariance(curves, size, mean);
+}
+
+Statistics::Components
+Statistics::components(const SessionMatrix& session, const QVector<int>& curves, int count)
+{
+    if (session.precision() == SpecFile::Float32) {
+        return components(sessionCurves<float>(session, curves), session.grid().size(), count);
+    }
+    return components(sessionCurves<double>(session, curves), session.grid().size(), count);
+}
+
+Statistics::Components
+Statistics::components(const QVector<const double*>& curves, int size, int count)
+{
+    return computeComponents(curves, size, count);
+}
+
+Statistics::Components
+Statistics::components(const QVector<const float*>& curves, int size, int count)
+{
+    return computeComponents(curves, size, count);
+}
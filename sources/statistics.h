@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include "sessionmatrix.h"
+
+#include <QVector>
+
+// statistics across many curves sampled on the same grid, computed in parallel over blocks of wavelengths. curves
+// are given as session curve indices, typically the same channel of repeated measurements, or as size long arrays
+// of float64 or float32 values
+class Statistics {
+public:
+    struct Bands {
+        QVector<double> mean;
+        QVector<double> stddev;
+        QVector<double> lower;  // lower percentile
+        QVector<double> median;
+        QVector<double> upper;  // upper percentile
+        int count = 0;
+    };
+    struct Components {
+        QVector<double> mean;
+        QVector<QVector<double>> vectors;  // unit length, ordered by variance
+        QVector<double> variances;
+        double totalVariance = 0.0;
+    };
+
+    static Bands bands(const SessionMatrix& session, const QVector<int>& curves, double lower = 5.0,
+                       double upper = 95.0);
+    static Bands bands(const QVector<const double*>& curves, int size, double lower = 5.0, double upper = 95.0);
+    static Bands bands(const QVector<const float*>& curves, int size, double lower = 5.0, double upper = 95.0);
+    // size x size row major, the upper triangle is mirrored
+    static QVector<double> covariance(const SessionMatrix& session, const QVector<int>& curves,
+                                      QVector<double>* mean = nullptr);
+    static QVector<double> covariance(const QVector<const double*>& curves, int size,
+                                      QVector<double>* mean = nullptr);
+    static QVector<double> covariance(const QVector<const float*>& curves, int size, QVector<double>* mean = nullptr);
+    static Components components(const SessionMatrix& session, const QVector<int>& curves, int count = 3);
+    static Components components(const QVector<const double*>& curves, int size, int count = 3);
+    static Components components(const QVector<const float*>& curves, int size, int count = 3);
+};
@@ -1,7 +1,9 @@
 #include "stylesheet.h"
 #include "icctransform.h"
 #include <QApplication>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 #include <QMetaEnum>
 #include <QMutex>
 #include <QMutexLocker>
@@ -16,14 +18,33 @@ public:
     ~StylesheetPrivate();
     QString roleName(Stylesheet::ColorRole role) const;
     QString roleName(Stylesheet::FontRole role) const;
-
+    void parse(const QString& qss);
+    void compile();
+
+    struct Placeholder {
+        enum Modifier { None, Lightness, Saturation };
+        QString name;    // color or font role
+        QString source;  // placeholder as written, kept when the role is unknown
+        Modifier modifier = None;
+        int factor = 100;
+    };
     QString path;
+    qint64 modified;
+    QStringList literals;  // qss template, text between placeholders, one more than placeholders
+    QList<Placeholder> placeholders;
     QString compiled;
+    QString applied;
+    bool dirty;
+    QHash<QString, QColor> sources;  // palette before the display transform
     QHash<QString, QColor> palette;
     QHash<QString, int> fonts;
 };
 
-StylesheetPrivate::StylesheetPrivate() {}
+StylesheetPrivate::StylesheetPrivate()
+    : modified(0)
+    , dirty(true)
+{}
+
 StylesheetPrivate::~StylesheetPrivate() {}
 
 QString
@@ -40,30 +61,92 @@ StylesheetPrivate::roleName(Stylesheet::FontRole role) const
     return QString::fromLatin1(me.valueToKey(role)).toLower();
 }
 
+void
+StylesheetPrivate::parse(const QString& qss)
+{
+    static const QRegularExpression regex(R"(\$([a-z0-9]+)(?:\.(lightness|saturation)\((\d+)\))?)",
+                                          QRegularExpression::CaseInsensitiveOption);  // compiled once
+    literals.clear();
+    placeholders.clear();
+    qsizetype lastIndex = 0;
+    QRegularExpressionMatchIterator it = regex.globalMatch(qss);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        literals.append(qss.mid(lastIndex, match.capturedStart() - lastIndex));
+        Placeholder placeholder;
+        placeholder.name = match.captured(1).toLower();
+        placeholder.source = match.captured(0);
+        QString modifier = match.captured(2).toLower();
+        placeholder.modifier = modifier == "lightness"    ? Placeholder::Lightness
+                               : modifier == "saturation" ? Placeholder::Saturation
+                                                          : Placeholder::None;
+        placeholder.factor = match.captured(3).isEmpty() ? 100 : match.captured(3).toInt();
+        placeholders.append(placeholder);
+        lastIndex = match.capturedEnd();
+    }
+    literals.append(qss.mid(lastIndex));
+    dirty = true;
+}
+
+void
+StylesheetPrivate::compile()
+{
+    QString result;
+    result.reserve(compiled.size() + 64);  // previous result, the template rarely changes size
+    for (int i = 0; i < placeholders.size(); ++i) {
+        result.append(literals[i]);
+        const Placeholder& placeholder = placeholders[i];
+        QColor color = palette.value(placeholder.name, QColor());
+        if (color.isValid()) {
+            if (placeholder.modifier == Placeholder::Lightness) {
+                color = color.lighter(placeholder.factor);
+            }
+            else if (placeholder.modifier == Placeholder::Saturation) {
+                float h, s, l, a;
+                color.getHslF(&h, &s, &l, &a);
+                s = std::clamp(s * placeholder.factor / 100.0, 0.0, 1.0);
+                color.setHslF(h, s, l, a);
+            }
+            result.append(QString("hsl(%1, %2%, %3%)")
+                              .arg(color.hue() == -1 ? 0 : color.hue())
+                              .arg(int(color.hslSaturationF() * 100))
+                              .arg(int(color.lightnessF() * 100)));
+            continue;
+        }
+        auto font = fonts.constFind(placeholder.name);
+        if (font != fonts.constEnd()) {
+            result.append(QString::number(font.value()) + "px");
+            continue;
+        }
+        result.append(placeholder.source);
+    }
+    if (!literals.isEmpty()) {
+        result.append(literals.last());
+    }
+    compiled = result;
+    dirty = false;
+}
+
 #include "stylesheet.moc"
 
 Stylesheet::Stylesheet()
     : p(new StylesheetPrivate())
 {
-    ICCTransform* transform = ICCTransform::instance();
-    auto map = [&](ColorRole role, QColor c) {
-        QColor mapped = transform->map(c.rgb());
-        setColor(role, mapped);
-    };
-
-    map(Base, QColor::fromHsl(220, 76, 6));
-    map(BaseAlt, QColor::fromHsl(220, 30, 12));
-    map(Accent, QColor::fromHsl(220, 6, 20));
-    map(AccentAlt, QColor::fromHsl(220, 6, 24));
-    map(Text, QColor::fromHsl(0, 0, 180));
-    map(TextDisabled, QColor::fromHsl(0, 0, 40));
-    map(Highlight, QColor::fromHsl(216, 82, 40));
-    map(Border, QColor::fromHsl(220, 3, 32));
-    map(BorderAlt, QColor::fromHsl(220, 3, 64));
-    map(Scrollbar, QColor::fromHsl(0, 0, 70));
-    map(Progress, QColor::fromHsl(216, 82, 20));
-    map(Button, QColor::fromHsl(220, 6, 40));
-    map(ButtonAlt, QColor::fromHsl(220, 6, 54));
+    auto source = [&](ColorRole role, QColor c) { p->sources[p->roleName(role)] = c; };
+    source(Base, QColor::fromHsl(220, 76, 6));
+    source(BaseAlt, QColor::fromHsl(220, 30, 12));
+    source(Accent, QColor::fromHsl(220, 6, 20));
+    source(AccentAlt, QColor::fromHsl(220, 6, 24));
+    source(Text, QColor::fromHsl(0, 0, 180));
+    source(TextDisabled, QColor::fromHsl(0, 0, 40));
+    source(Highlight, QColor::fromHsl(216, 82, 40));
+    source(Border, QColor::fromHsl(220, 3, 32));
+    source(BorderAlt, QColor::fromHsl(220, 3, 64));
+    source(Scrollbar, QColor::fromHsl(0, 0, 70));
+    source(Progress, QColor::fromHsl(216, 82, 20));
+    source(Button, QColor::fromHsl(220, 6, 40));
+    source(ButtonAlt, QColor::fromHsl(220, 6, 54));
+    mapPalette();
 
     setFontSize(DefaultSize, 11);
     setFontSize(SmallSize, 9);
@@ -75,82 +158,66 @@ Stylesheet::~Stylesheet() {}
 void
 Stylesheet::applyQss(const QString& qss)
 {
+    // setting the application stylesheet restyles every widget, only done when the text changed
+    if (qss == p->applied && qss == qApp->styleSheet()) {
+        return;
+    }
+    p->applied = qss;
     qApp->setStyleSheet(qss);
 }
 
 bool
 Stylesheet::loadQss(const QString& path)
 {
+    QFileInfo info(path);
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if (path == p->path && modified == p->modified && !p->literals.isEmpty()) {
+        return true;  // template is parsed once, compiled() substitutes the current palette
+    }
     QFile file(path);
     if (!file.open(QFile::ReadOnly | QFile::Text)) {
         return false;
     }
     p->path = path;
-    QString output = QString::fromUtf8(file.readAll());
-
-    QRegularExpression regex(R"(\$([a-z0-9]+)(?:\.(lightness|saturation)\((\d+)\))?)",
-                             QRegularExpression::CaseInsensitiveOption);
-
-    QString result;
-    qsizetype lastIndex = 0;
-    QRegularExpressionMatchIterator it = regex.globalMatch(output);
-
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        result.append(output.mid(lastIndex, match.capturedStart() - lastIndex));
-
-        QString roleName = match.captured(1).toLower();
-        QString modifier = match.captured(2).toLower();
-        int factor = match.captured(3).isEmpty() ? 100 : match.captured(3).toInt();
-
-        QColor color = p->palette.value(roleName, QColor());
-        if (!color.isValid()) {
-            result.append(match.captured(0));
-        }
-        else {
-            QColor mapped = color;
-
-            if (modifier == "lightness") {
-                mapped = mapped.lighter(factor);
-            }
-            else if (modifier == "saturation") {
-                float h, s, l, a;
-                mapped.getHslF(&h, &s, &l, &a);
-                s = std::clamp(s * factor / 100.0, 0.0, 1.0);
-                mapped.setHslF(h, s, l, a);
-            }
-
-            QString hsl = QString("hsl(%1, %2%, %3%)")
-                              .arg(mapped.hue() == -1 ? 0 : mapped.hue())
-                              .arg(int(mapped.hslSaturationF() * 100))
-                              .arg(int(mapped.lightnessF() * 100));
-            result.append(hsl);
-        }
-
-        lastIndex = match.capturedEnd();
-    }
-    result.append(output.mid(lastIndex));
-
-    for (auto it = p->fonts.constBegin(); it != p->fonts.constEnd(); ++it) {
-        QString placeholder = "$" + it.key();
-        QString replacement = QString::number(it.value()) + "px";
-        result.replace(placeholder, replacement, Qt::CaseInsensitive);
-    }
-
-    p->compiled = result;
+    p->modified = modified;
+    p->parse(QString::fromUtf8(file.readAll()));
     return true;
 }
 
 QString
 Stylesheet::compiled() const
 {
+    if (p->dirty) {
+        p->compile();
+    }
     return p->compiled;
 }
 
+bool
+Stylesheet::mapPalette()
+{
+    ICCTransform* transform = ICCTransform::instance();
+    bool changed = false;
+    for (auto it = p->sources.constBegin(); it != p->sources.constEnd(); ++it) {
+        QColor mapped = QColor(transform->map(it.value().rgb()));
+        QColor& color = p->palette[it.key()];
+        if (color != mapped) {
+            color = mapped;
+            changed = true;
+        }
+    }
+    p->dirty = p->dirty || changed;
+    return changed;
+}
+
 void
 Stylesheet::setColor(ColorRole role, const QColor& color)
 {
-    p->palette[p->roleName(role)] = color;
+    QColor& current = p->palette[p->roleName(role)];
+    if (current != color) {
+        current = color;
+        p->dirty = true;
+    }
 }
 
 QColor
@@ -162,7 +229,11 @@ Stylesheet::color(ColorRole role) const
 void
 Stylesheet::setFontSize(FontRole role, int size)
 {
-    p->fonts[p->roleName(role)] = size;
+    int& current = p->fonts[p->roleName(role)];
+    if (current != size) {
+        current = size;
+        p->dirty = true;
+    }
 }
 
 int
@@ -42,6 +42,9 @@ public:
     bool loadQss(const QString& path);
     QString compiled() const;
 
+    // maps the palette through the current display profile, returns false if no color changed
+    bool mapPalette();
+
     void setColor(ColorRole role, const QColor& color);
     QColor color(ColorRole role) const;
 
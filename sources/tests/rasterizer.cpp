@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "../qcustomplot/qcustomplot.h"
+
+#include <QApplication>
+#include <QImage>
+#include <QPainter>
+#include <cmath>
+#include <cstdio>
+
+// visual comparison of the raster polyline path against qpainter for the pens graphs are drawn with, the same curve
+// is drawn both ways and the coverage difference has to stay below a threshold. exits non-zero on a mismatch
+namespace {
+struct Difference {
+    double mean = 0;      // alpha difference over covered pixels, 0 to 1
+    double outliers = 0;  // fraction of covered pixels off by more than a quarter
+};
+
+QVector<QPointF>
+curve()
+{
+    // slow and fast slopes, steep segments are walked along the other axis
+    QVector<QPointF> points;
+    for (int i = 0; i <= 400; i += 2) {
+        points.append(QPointF(20 + i, 150 + 100 * std::sin(i * 0.03) + 20 * std::sin(i * 0.4)));
+    }
+    return points;
+}
+
+QImage
+blank()
+{
+    QImage image(440, 300, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    return image;
+}
+
+Difference
+compare(const QImage& image, const QImage& reference)
+{
+    Difference difference;
+    qint64 covered = 0;
+    qint64 outliers = 0;
+    double sum = 0;
+    for (int y = 0; y < image.height(); ++y) {
+        const QRgb* a = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        const QRgb* b = reinterpret_cast<const QRgb*>(reference.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            if (!qAlpha(a[x]) && !qAlpha(b[x])) {
+                continue;
+            }
+            const int delta = qAbs(qAlpha(a[x]) - qAlpha(b[x]));
+            sum += delta / 255.0;
+            outliers += delta > 64 ? 1 : 0;
+            ++covered;
+        }
+    }
+    if (covered) {
+        difference.mean = sum / covered;
+        difference.outliers = double(outliers) / covered;
+    }
+    return difference;
+}
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    const QVector<QPointF> points = curve();
+    const QList<QPair<Qt::PenStyle, const char*>> styles = { { Qt::SolidLine, "solid" }, { Qt::DashLine, "dash" } };
+    int failures = 0;
+    for (const auto& style : styles) {
+        for (int width = 1; width <= 3; ++width) {
+            const QPen pen(QColor(20, 90, 200), width, style.first);
+            QImage image = blank();
+            QCPLineRasterizer rasterizer;
+            if (!rasterizer.begin(&image, pen)) {
+                std::printf("%s %d px: not supported by the rasterizer\n", style.second, width);
+                ++failures;
+                continue;
+            }
+            rasterizer.drawPolyline(points);
+
+            QImage reference = blank();
+            QPainter painter(&reference);
+            painter.setRenderHint(QPainter::Antialiasing);
+            painter.setPen(pen);
+            painter.drawPolyline(points.constData(), points.size());
+            painter.end();
+
+            const Difference difference = compare(image, reference);
+            const bool passed = difference.mean < 0.12 && difference.outliers < 0.05;
+            std::printf("%s %d px: mean %.3f, outliers %.3f %s\n", style.second, width, difference.mean,
+                        difference.outliers, passed ? "ok" : "failed");
+            failures += passed ? 0 : 1;
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "undocommands.h"
+
+#include <QComboBox>
+#include <QTreeWidgetItem>
+
+CheckStateCommand::CheckStateCommand(QTreeWidgetItem* item, Qt::CheckState from, Qt::CheckState to, bool& recording)
+    : item(item)
+    , from(from)
+    , to(to)
+    , recording(recording)
+    , done(true)
+{
+    setText(QString("%1 %2").arg(to == Qt::Checked ? "Show" : "Hide", item->text(0)));
+}
+
+void
+CheckStateCommand::undo()
+{
+    apply(from);
+}
+
+void
+CheckStateCommand::redo()
+{
+    if (done) {
+        done = false;
+        return;
+    }
+    apply(to);
+}
+
+void
+CheckStateCommand::apply(Qt::CheckState state)
+{
+    recording = false;
+    item->setCheckState(0, state);
+    recording = true;
+}
+
+ComboIndexCommand::ComboIndexCommand(QComboBox* combo, int from, int to, bool& recording)
+    : combo(combo)
+    , from(from)
+    , to(to)
+    , recording(recording)
+    , done(true)
+{
+    setText(QString("Change to %1").arg(combo->itemText(to).toLower()));
+}
+
+void
+ComboIndexCommand::undo()
+{
+    apply(from);
+}
+
+void
+ComboIndexCommand::redo()
+{
+    if (done) {
+        done = false;
+        return;
+    }
+    apply(to);
+}
+
+void
+ComboIndexCommand::apply(int index)
+{
+    if (!combo) {
+        return;
+    }
+    recording = false;
+    combo->setCurrentIndex(index);
+    recording = true;
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QPointer>
+#include <QUndoCommand>
+
+class QComboBox;
+class QTreeWidgetItem;
+
+// user changes as compact deltas of the widget they were made in, the previous and the new value. undo and redo
+// set the value on the widget again so they take the same path as the user, recording is turned off meanwhile.
+// the first redo is skipped, commands are pushed after the change was made
+class CheckStateCommand : public QUndoCommand {
+public:
+    CheckStateCommand(QTreeWidgetItem* item, Qt::CheckState from, Qt::CheckState to, bool& recording);
+    void undo() override;
+    void redo() override;
+
+private:
+    void apply(Qt::CheckState state);
+    QTreeWidgetItem* item;  // owned by the tree, the stack is cleared with it
+    Qt::CheckState from;
+    Qt::CheckState to;
+    bool& recording;
+    bool done;
+};
+
+class ComboIndexCommand : public QUndoCommand {
+public:
+    ComboIndexCommand(QComboBox* combo, int from, int to, bool& recording);
+    void undo() override;
+    void redo() override;
+
+private:
+    void apply(int index);
+    QPointer<QComboBox> combo;
+    int from;
+    int to;
+    bool& recording;
+    bool done;
+};
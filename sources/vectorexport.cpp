@@ -0,0 +1,435 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#include "vectorexport.h"
+#include "qcustomplot/qcustomplot.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QPageLayout>
+#include <QPainterPath>
+#include <QPdfWriter>
+#include <QSaveFile>
+#include <QSvgGenerator>
+#include <cmath>
+
+namespace {
+struct Group {
+    QPen pen;
+    QRect clip;
+    QList<QCPGraph*> graphs;
+};
+
+struct Sample {
+    double key;
+    double value;
+    int order;
+};
+
+QByteArray
+penKey(const QPen& pen, const QRect& clip)
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << pen << clip;
+    return key;
+}
+
+bool
+reducible(const QCPGraph* graph, const QCPLayer* main)
+{
+    // lines only, fills, scatters and selections are left to the plot
+    return graph->realVisibility() && graph->layer() == main && graph->lineStyle() == QCPGraph::lsLine
+           && graph->scatterStyle().isNone() && graph->brush().style() == Qt::NoBrush && !graph->channelFillGraph()
+           && !graph->selected() && graph->pen().style() != Qt::NoPen && graph->keyAxis() && graph->valueAxis();
+}
+
+// min and max of each key column of the given width in output units, a column that spans less than one column in
+// value is a single point. the path is anything with moveTo and lineTo, gaps in the data start a new subpath
+template<typename Path>
+void
+reduce(const QCPGraph* graph, double column, Path& path)
+{
+    const QCPAxis* keyAxis = graph->keyAxis();
+    const QCPAxis* valueAxis = graph->valueAxis();
+    const bool vertical = keyAxis->orientation() == Qt::Vertical;
+    const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    auto it = data->findBegin(keyAxis->range().lower);
+    const auto end = data->findEnd(keyAxis->range().upper);
+
+    bool open = false;
+    bool active = false;
+    qint64 bucket = 0;
+    int count = 0;
+    Sample first = {}, low = {}, high = {};
+    auto point = [&](const Sample& sample) {
+        const QPointF position = vertical ? QPointF(sample.value, sample.key) : QPointF(sample.key, sample.value);
+        if (open) {
+            path.lineTo(position);
+        }
+        else {
+            path.moveTo(position);
+            open = true;
+        }
+    };
+    auto flush = [&]() {
+        if (!active) {
+            return;
+        }
+        active = false;
+        if (count == 1 || high.value - low.value < column) {
+            point(first);
+            return;
+        }
+        const bool rising = low.order < high.order;
+        point(rising ? low : high);
+        point(rising ? high : low);
+    };
+    for (; it != end; ++it) {
+        if (std::isnan(it->value)) {
+            flush();
+            open = false;
+            continue;
+        }
+        const double key = keyAxis->coordToPixel(it->key);
+        const qint64 current = qint64(std::floor(key / column));
+        if (active && current != bucket) {
+            flush();
+        }
+        if (!active) {
+            active = true;
+            bucket = current;
+            count = 0;
+        }
+        const Sample sample = { key, valueAxis->coordToPixel(it->value), count };
+        if (count == 0) {
+            first = low = high = sample;
+        }
+        if (sample.value < low.value) {
+            low = sample;
+        }
+        if (sample.value > high.value) {
+            high = sample;
+        }
+        ++count;
+    }
+    flush();
+}
+
+// svg path data in hundredths of a unit, appended to a buffer that is written to the device as it grows. points
+// after the first of a subpath are implicit line segments
+class SvgPath {
+public:
+    SvgPath(QIODevice* device, QByteArray& buffer)
+        : device(device)
+        , buffer(buffer)
+    {}
+    void moveTo(const QPointF& position) { append('M', position); }
+    void lineTo(const QPointF& position) { append(' ', position); }
+
+private:
+    void append(char command, const QPointF& position)
+    {
+        const qint64 x = qRound64(position.x() * 100);
+        const qint64 y = qRound64(position.y() * 100);
+        if (command == ' ' && x == lastX && y == lastY) {
+            return;
+        }
+        lastX = x;
+        lastY = y;
+        buffer += command;
+        number(x);
+        buffer += ' ';
+        number(y);
+        if (buffer.size() > 1 << 16) {
+            device->write(buffer);
+            buffer.clear();
+        }
+    }
+    void number(qint64 hundredths)
+    {
+        if (hundredths < 0) {
+            buffer += '-';
+            hundredths = -hundredths;
+        }
+        buffer += QByteArray::number(hundredths / 100);
+        const int fraction = int(hundredths % 100);
+        if (fraction) {
+            buffer += '.';
+            buffer += char('0' + fraction / 10);
+            if (fraction % 10) {
+                buffer += char('0' + fraction % 10);
+            }
+        }
+    }
+    QIODevice* device;
+    QByteArray& buffer;
+    qint64 lastX = 0;
+    qint64 lastY = 0;
+};
+
+QByteArray
+svgStyle(const QPen& pen)
+{
+    static const QHash<int, QByteArray> caps = { { Qt::FlatCap, "butt" },
+                                                 { Qt::SquareCap, "square" },
+                                                 { Qt::RoundCap, "round" } };
+    static const QHash<int, QByteArray> joins = { { Qt::MiterJoin, "miter" },
+                                                  { Qt::SvgMiterJoin, "miter" },
+                                                  { Qt::BevelJoin, "bevel" },
+                                                  { Qt::RoundJoin, "round" } };
+    const QColor color = pen.color();
+    const double width = pen.widthF() > 0 ? pen.widthF() : 1.0;
+    QByteArray style = "fill:none;stroke:" + color.name().toLatin1();
+    if (color.alpha() < 255) {
+        style += ";stroke-opacity:" + QByteArray::number(color.alphaF(), 'g', 3);
+    }
+    style += ";stroke-width:" + QByteArray::number(width, 'g', 4);
+    style += ";stroke-linecap:" + caps.value(pen.capStyle(), "square");
+    style += ";stroke-linejoin:" + joins.value(pen.joinStyle(), "bevel");
+    if (pen.isCosmetic()) {
+        style += ";vector-effect:non-scaling-stroke";
+    }
+    if (pen.style() != Qt::SolidLine) {
+        QByteArrayList dashes;
+        for (double dash : pen.dashPattern()) {
+            dashes.append(QByteArray::number(dash * width, 'g', 4));
+        }
+        style += ";stroke-dasharray:" + dashes.join(',');
+        if (pen.dashOffset() != 0) {
+            style += ";stroke-dashoffset:" + QByteArray::number(pen.dashOffset() * width, 'g', 4);
+        }
+    }
+    return style;
+}
+
+QByteArray
+svgFragment(const QByteArray& document, const QByteArray& prefix)
+{
+    // contents of the generated root element, ids are prefixed since every pass numbers its own clips and gradients
+    const int root = document.indexOf("<svg");
+    const int begin = root < 0 ? -1 : document.indexOf('>', root);
+    const int end = document.lastIndexOf("</svg>");
+    if (begin < 0 || end < begin) {
+        return QByteArray();
+    }
+    QByteArray fragment = document.mid(begin + 1, end - begin - 1);
+    fragment.replace("id=\"", "id=\"" + prefix);
+    fragment.replace("url(#", "url(#" + prefix);
+    fragment.replace("href=\"#", "href=\"#" + prefix);
+    return fragment;
+}
+
+// draws the plot with only the layers in the range visible, layers keep their state otherwise
+void
+drawLayers(QCustomPlot* plot, QCPPainter* painter, const QSize& size, const QList<bool>& visible, int from, int to)
+{
+    for (int i = 0; i < plot->layerCount(); ++i) {
+        plot->layer(i)->setVisible(visible[i] && i >= from && i <= to);
+    }
+    plot->toPainter(painter, size.width(), size.height());
+}
+}  // namespace
+
+VectorExport::VectorExport()
+    : exportSize(800, 500)
+    , exportDpi(300)
+    , exportBackground(Qt::white)
+{}
+
+QStringList
+VectorExport::availableFormats()
+{
+    return { "pdf", "svg" };
+}
+
+void
+VectorExport::setSize(const QSize& size)
+{
+    exportSize = size;
+}
+
+void
+VectorExport::setDpi(int dpi)
+{
+    exportDpi = qMax(1, dpi);
+}
+
+void
+VectorExport::setTitle(const QString& title)
+{
+    exportTitle = title;
+}
+
+void
+VectorExport::setBackground(const QBrush& background)
+{
+    exportBackground = background;
+}
+
+bool
+VectorExport::write(QCustomPlot* plot, const QString& fileName)
+{
+    const QString format = QFileInfo(fileName).suffix().toLower();
+    if (!availableFormats().contains(format)) {
+        qWarning() << "VectorExport: unsupported format:" << format;
+        return false;
+    }
+    QCPLayer* main = plot->layer("main");
+    if (!main || exportSize.isEmpty()) {
+        qWarning() << "VectorExport: nothing to export to:" << fileName;
+        return false;
+    }
+
+    // laid out at the export size before the graphs are mapped, as toPainter does before drawing
+    const QRect viewport = plot->viewport();
+    const QRect target(QPoint(0, 0), exportSize);
+    plot->setViewport(target);
+    plot->plotLayout()->update(QCPLayoutElement::upPreparation);
+    plot->plotLayout()->update(QCPLayoutElement::upMargins);
+    plot->plotLayout()->update(QCPLayoutElement::upLayout);
+
+    QList<Group> groups;
+    QHash<QByteArray, int> styles;
+    QList<QCPGraph*> hidden;
+    for (int i = 0; i < plot->graphCount(); ++i) {
+        QCPGraph* graph = plot->graph(i);
+        if (!reducible(graph, main)) {
+            continue;
+        }
+        const QRect clip = graph->keyAxis()->axisRect()->rect();
+        const QByteArray key = penKey(graph->pen(), clip);
+        auto it = styles.constFind(key);
+        if (it == styles.constEnd()) {
+            it = styles.insert(key, groups.size());
+            groups.append({ graph->pen(), clip, {} });
+        }
+        groups[it.value()].graphs.append(graph);
+        hidden.append(graph);
+    }
+    QList<bool> layers;
+    QList<bool> visible;
+    for (int i = 0; i < plot->layerCount(); ++i) {
+        QCPLayer* layer = plot->layer(i);
+        layers.append(layer->visible());
+        visible.append(layer->visible() && layer->name() != "overlay");  // tracers follow the cursor
+    }
+    for (QCPGraph* graph : hidden) {
+        graph->setVisible(false);
+    }
+    const QBrush background = plot->backgroundBrush();
+    plot->setBackground(QBrush(Qt::NoBrush));
+
+    // pdf units are points and svg units are pixels, the column is one device pixel at the target resolution
+    const int mainIndex = main->index();
+    const int topIndex = plot->layerCount() - 1;
+    bool success = false;
+    if (format == "pdf") {
+        const double column = 72.0 / exportDpi;
+        QPdfWriter writer(fileName);
+        writer.setTitle(exportTitle);
+        writer.setCreator("specviz");
+        writer.setResolution(exportDpi);
+        writer.setPageLayout(QPageLayout(QPageSize(exportSize, QPageSize::Point, QString(), QPageSize::ExactMatch),
+                                         QPageLayout::Portrait, QMarginsF(0, 0, 0, 0), QPageLayout::Point));
+        QCPPainter painter;
+        if (painter.begin(&writer)) {
+            painter.setMode(QCPPainter::pmVectorized);
+            painter.setWindow(target);
+            painter.fillRect(target, exportBackground);
+            drawLayers(plot, &painter, exportSize, visible, 0, mainIndex);
+            for (const Group& group : groups) {
+                QPainterPath path;
+                for (QCPGraph* graph : group.graphs) {
+                    reduce(graph, column, path);
+                }
+                painter.save();
+                painter.setClipRect(group.clip);
+                painter.setPen(group.pen);
+                painter.setBrush(Qt::NoBrush);
+                painter.drawPath(path);
+                painter.restore();
+            }
+            drawLayers(plot, &painter, exportSize, visible, mainIndex + 1, topIndex);
+            success = painter.end();
+        }
+    }
+    else {
+        const double column = 96.0 / exportDpi;
+        auto pass = [&](int from, int to, bool background) {
+            QBuffer buffer;
+            QSvgGenerator generator;
+            generator.setOutputDevice(&buffer);
+            generator.setSize(exportSize);
+            generator.setViewBox(target);
+            QCPPainter painter;
+            if (!painter.begin(&generator)) {
+                return QByteArray();
+            }
+            painter.setMode(QCPPainter::pmVectorized);
+            if (background) {
+                painter.fillRect(target, exportBackground);
+            }
+            drawLayers(plot, &painter, exportSize, visible, from, to);
+            painter.end();
+            return buffer.data();
+        };
+        const QByteArray below = svgFragment(pass(0, mainIndex, true), "a");
+        const QByteArray above = svgFragment(pass(mainIndex + 1, topIndex, false), "b");
+
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            const QByteArray width = QByteArray::number(exportSize.width());
+            const QByteArray height = QByteArray::number(exportSize.height());
+            QByteArray buffer;
+            buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n";
+            buffer += "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+                      "version=\"1.1\" width=\""
+                      + width + "\" height=\"" + height + "\" viewBox=\"0 0 " + width + " " + height + "\">\n";
+            buffer += "<title>" + exportTitle.toHtmlEscaped().toUtf8() + "</title>\n<defs>\n<style>\n";
+            for (int g = 0; g < groups.size(); ++g) {
+                buffer += ".s" + QByteArray::number(g) + "{" + svgStyle(groups[g].pen) + "}\n";
+            }
+            buffer += "</style>\n";
+            for (int g = 0; g < groups.size(); ++g) {
+                const QRect& clip = groups[g].clip;
+                buffer += "<clipPath id=\"c" + QByteArray::number(g) + "\"><rect x=\"" + QByteArray::number(clip.x())
+                          + "\" y=\"" + QByteArray::number(clip.y()) + "\" width=\""
+                          + QByteArray::number(clip.width()) + "\" height=\"" + QByteArray::number(clip.height())
+                          + "\"/></clipPath>\n";
+            }
+            buffer += "</defs>\n<g>" + below + "</g>\n";
+            for (int g = 0; g < groups.size(); ++g) {
+                buffer += "<path class=\"s" + QByteArray::number(g) + "\" clip-path=\"url(#c" + QByteArray::number(g)
+                          + ")\" d=\"";
+                SvgPath path(&file, buffer);
+                for (QCPGraph* graph : groups[g].graphs) {
+                    reduce(graph, column, path);
+                }
+                buffer += "\"/>\n";
+            }
+            buffer += "<g>" + above + "</g>\n</svg>\n";
+            file.write(buffer);
+            success = !below.isEmpty() && !above.isEmpty() && file.commit();
+        }
+    }
+
+    // the plot is left as it was, its layout follows on the next replot
+    for (int i = 0; i < plot->layerCount(); ++i) {
+        plot->layer(i)->setVisible(layers[i]);
+    }
+    for (QCPGraph* graph : hidden) {
+        graph->setVisible(true);
+    }
+    plot->setBackground(background);
+    plot->setViewport(viewport);
+    plot->replot(QCustomPlot::rpQueuedReplot);
+    if (!success) {
+        qWarning() << "VectorExport: could not write:" << fileName;
+    }
+    return success;
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025 - present Mikael Sundell
+// https://github.com/mikaelsundell/specviz
+
+#pragma once
+
+#include <QBrush>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+// pdf and svg export of a plot. line graphs are not drawn by the plot, they are reduced to the min and max of each
+// device pixel column at the target resolution and graphs with the same pen share one path. svg path data is written
+// to the file as it is generated, axes, legends and other plottables are drawn by the plot around the paths
+class QCustomPlot;
+class VectorExport {
+public:
+    VectorExport();
+    static QStringList availableFormats();
+
+    QSize size() const { return exportSize; }
+    int dpi() const { return exportDpi; }
+    QString title() const { return exportTitle; }
+    QBrush background() const { return exportBackground; }
+
+    void setSize(const QSize& size);
+    void setDpi(int dpi);
+    void setTitle(const QString& title);
+    void setBackground(const QBrush& background);  // fills the exported page, the plot keeps its own
+
+    bool write(QCustomPlot* plot, const QString& fileName);
+
+private:
+    QSize exportSize;
+    int exportDpi;
+    QString exportTitle;
+    QBrush exportBackground;
+};